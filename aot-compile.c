@@ -0,0 +1,349 @@
+/*
+ * pchip-aot: static recompiler of CHIP-8 ROMs into C
+ *
+ * Traces the code reachable from PROGRAM_START_BYTES, splits it into basic
+ * blocks and writes a translation unit defining aot_rom (see aot.h) to be
+ * linked with main.c built with -DPCHIP_AOT and the core.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chip8.h"
+#include "disasm.h"
+
+#define ROM_BYTES_PER_LINE 12
+
+static uint8_t rom[MAX_ROM_SIZE_BYTES];
+static size_t rom_size;
+
+static bool is_code[MEMORY_SIZE_BYTES];
+static bool is_leader[MEMORY_SIZE_BYTES];
+
+/* Whole instruction within the ROM, nothing else is known statically */
+static bool in_rom(uint32_t addr)
+{
+    return addr >= PROGRAM_START_BYTES && addr + 1 < PROGRAM_START_BYTES + rom_size;
+}
+
+static uint16_t fetch(uint16_t addr)
+{
+    return (rom[addr - PROGRAM_START_BYTES] << 8) | rom[addr - PROGRAM_START_BYTES + 1];
+}
+
+static bool is_skip(enum disasm_class cls)
+{
+    return cls == DISASM_SE_BYTE || cls == DISASM_SNE_BYTE || cls == DISASM_SE_REG ||
+        cls == DISASM_SNE_REG || cls == DISASM_SKP || cls == DISASM_SKNP;
+}
+
+/* Instructions ending a basic block */
+static bool is_terminator(enum disasm_class cls)
+{
+    return is_skip(cls) || cls == DISASM_JP || cls == DISASM_CALL || cls == DISASM_RET ||
+        cls == DISASM_JP_V0 || cls == DISASM_LD_K || cls == DISASM_UNKNOWN;
+}
+
+/* Instructions left to the interpreter: I/O, display, sound and RAM writes,
+ * the latter so that the runtime notices self-modification */
+static bool is_delegated(enum disasm_class cls)
+{
+    return cls == DISASM_CLS || cls == DISASM_DRW || cls == DISASM_SKP || cls == DISASM_SKNP ||
+        cls == DISASM_LD_K || cls == DISASM_LD_ST || cls == DISASM_LD_F ||
+        cls == DISASM_LD_B || cls == DISASM_LD_MEM || cls == DISASM_UNKNOWN;
+}
+
+/* The hires entry jump and clear screen depend on the display, the
+ * interpreter takes care of both */
+static bool is_hires_special(uint16_t addr, uint16_t instruction)
+{
+    return (addr == PROGRAM_START_BYTES && instruction == HIRES_ENTRY_INSTRUCTION) ||
+        instruction == HIRES_CLS_INSTRUCTION;
+}
+
+static void trace(void)
+{
+    static uint16_t worklist[MEMORY_SIZE_BYTES * 2];
+    size_t pending = 0;
+
+    worklist[pending++] = PROGRAM_START_BYTES;
+    is_leader[PROGRAM_START_BYTES] = true;
+
+    while (pending) {
+        uint16_t addr = worklist[--pending];
+        if (!in_rom(addr) || is_code[addr])
+            continue;
+        is_code[addr] = true;
+
+        uint16_t instruction = fetch(addr);
+        uint16_t nnn = instruction & 0x0FFF;
+        enum disasm_class cls = disasm_class(instruction, CHIP8_MODE_CHIP8);
+
+        switch (cls) {
+        case DISASM_JP:
+            if (is_hires_special(addr, instruction))
+                nnn = HIRES_START_BYTES;
+            is_leader[nnn] = true;
+            worklist[pending++] = nnn;
+            break;
+        case DISASM_CALL:
+            is_leader[nnn] = true;
+            is_leader[(addr + 2) % MEMORY_SIZE_BYTES] = true;
+            worklist[pending++] = nnn;
+            worklist[pending++] = addr + 2;
+            break;
+        case DISASM_RET:
+        case DISASM_JP_V0:
+        case DISASM_UNKNOWN:
+            break;
+        default:
+            if (is_skip(cls)) {
+                is_leader[(addr + 2) % MEMORY_SIZE_BYTES] = true;
+                is_leader[(addr + 4) % MEMORY_SIZE_BYTES] = true;
+                worklist[pending++] = addr + 4;
+            } else if (cls == DISASM_LD_K) {
+                is_leader[(addr + 2) % MEMORY_SIZE_BYTES] = true;
+            }
+            worklist[pending++] = addr + 2;
+            break;
+        }
+    }
+}
+
+static void emit_cycle(FILE *out)
+{
+    fprintf(out, "    vm->cycles_left -= vm->usec_per_cpu_step;\n");
+}
+
+/* Translated instruction, true if it ends the block */
+static bool emit_instruction(FILE *out, uint16_t addr, bool is_last)
+{
+    uint16_t instruction = fetch(addr);
+    unsigned x = (0x0F00 & instruction) >> 8;
+    unsigned y = (0x00F0 & instruction) >> 4;
+    unsigned nnn = (0x0FFF & instruction);
+    unsigned kk = (0x00FF & instruction);
+    unsigned next = addr + 2;
+    enum disasm_class cls = disasm_class(instruction, CHIP8_MODE_CHIP8);
+
+    char text[DISASM_MAX_SIZE];
+    disasm_format(instruction, CHIP8_MODE_CHIP8, text, sizeof(text));
+    fprintf(out, "    /* 0x%.3X: %s */\n", addr, text);
+
+    /* A jump to itself halts the program, the interpreter skips the rest of
+     * the frame */
+    if (is_delegated(cls) || is_hires_special(addr, instruction) || (cls == DISASM_JP && nnn == addr)) {
+        fprintf(out, "    vm->PC = 0x%.3X;\n", addr);
+        if (is_last || is_terminator(cls)) {
+            fprintf(out, "    aot_step(vm, rt, 0x%.3X);\n    return;\n", next);
+            return true;
+        }
+        fprintf(out, "    if (!aot_step(vm, rt, 0x%.3X))\n        return;\n", next);
+        return false;
+    }
+
+    switch (cls) {
+    case DISASM_SYS:
+        break;
+    case DISASM_RET:
+        fprintf(out, "    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;\n");
+        fprintf(out, "    vm->PC = vm->stack[vm->SP];\n");
+        emit_cycle(out);
+        fprintf(out, "    return;\n");
+        return true;
+    case DISASM_JP:
+        fprintf(out, "    vm->PC = 0x%.3X;\n", nnn);
+        emit_cycle(out);
+        fprintf(out, "    return;\n");
+        return true;
+    case DISASM_CALL:
+        fprintf(out, "    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x%.3X;\n", next);
+        fprintf(out, "    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;\n");
+        fprintf(out, "    vm->PC = 0x%.3X;\n", nnn);
+        emit_cycle(out);
+        fprintf(out, "    return;\n");
+        return true;
+    case DISASM_JP_V0:
+        fprintf(out, "    vm->PC = vm->regs[0x0] + 0x%.3X;\n", nnn);
+        emit_cycle(out);
+        fprintf(out, "    return;\n");
+        return true;
+    case DISASM_SE_BYTE:
+    case DISASM_SNE_BYTE:
+    case DISASM_SE_REG:
+    case DISASM_SNE_REG:{
+        const char *op = (cls == DISASM_SE_BYTE || cls == DISASM_SE_REG) ? "==" : "!=";
+        if (cls == DISASM_SE_BYTE || cls == DISASM_SNE_BYTE)
+            fprintf(out, "    vm->PC = vm->regs[0x%X] %s 0x%.2X ? 0x%.3X : 0x%.3X;\n",
+                    x, op, kk, addr + 4, next);
+        else
+            fprintf(out, "    vm->PC = vm->regs[0x%X] %s vm->regs[0x%X] ? 0x%.3X : 0x%.3X;\n",
+                    x, op, y, addr + 4, next);
+        emit_cycle(out);
+        fprintf(out, "    return;\n");
+        return true;
+    }
+    case DISASM_LD_BYTE:
+        fprintf(out, "    vm->regs[0x%X] = 0x%.2X;\n", x, kk);
+        break;
+    case DISASM_ADD_BYTE:
+        fprintf(out, "    vm->regs[0x%X] += 0x%.2X;\n", x, kk);
+        break;
+    case DISASM_LD_REG:
+        fprintf(out, "    vm->regs[0x%X] = vm->regs[0x%X];\n", x, y);
+        break;
+    case DISASM_OR:
+        fprintf(out, "    vm->regs[0x%X] |= vm->regs[0x%X];\n", x, y);
+        break;
+    case DISASM_AND:
+        fprintf(out, "    vm->regs[0x%X] &= vm->regs[0x%X];\n", x, y);
+        break;
+    case DISASM_XOR:
+        fprintf(out, "    vm->regs[0x%X] ^= vm->regs[0x%X];\n", x, y);
+        break;
+    case DISASM_ADD_REG:
+        fprintf(out, "    {\n        uint16_t acc = vm->regs[0x%X] + vm->regs[0x%X];\n", x, y);
+        fprintf(out, "        vm->regs[0x%X] = acc & 0xff;\n", x);
+        fprintf(out, "        vm->regs[Vf] = (acc & 0xf00) >> 8;\n    }\n");
+        break;
+    case DISASM_SUB:
+        fprintf(out, "    vm->regs[Vf] = vm->regs[0x%X] >= vm->regs[0x%X];\n", x, y);
+        fprintf(out, "    vm->regs[0x%X] = vm->regs[0x%X] - vm->regs[0x%X];\n", x, x, y);
+        break;
+    case DISASM_SHR:
+        fprintf(out, "    vm->regs[Vf] = vm->regs[0x%X] & 0x1;\n", x);
+        fprintf(out, "    vm->regs[0x%X] >>= 1;\n", x);
+        break;
+    case DISASM_SUBN:
+        fprintf(out, "    vm->regs[Vf] = vm->regs[0x%X] >= vm->regs[0x%X];\n", y, x);
+        fprintf(out, "    vm->regs[0x%X] = vm->regs[0x%X] - vm->regs[0x%X];\n", x, y, x);
+        break;
+    case DISASM_SHL:
+        fprintf(out, "    vm->regs[Vf] = !!(vm->regs[0x%X] & 0x80);\n", x);
+        fprintf(out, "    vm->regs[0x%X] <<= 1;\n", x);
+        break;
+    case DISASM_LD_I:
+        fprintf(out, "    vm->I = 0x%.3X;\n", nnn);
+        break;
+    case DISASM_RND:
+        fprintf(out, "    vm->regs[0x%X] = chip8_random(vm) & 0x%.2X;\n", x, kk);
+        break;
+    case DISASM_LD_VX_DT:
+        fprintf(out, "    vm->regs[0x%X] = vm->DT;\n", x);
+        break;
+    case DISASM_LD_DT:
+        fprintf(out, "    vm->DT = vm->regs[0x%X];\n", x);
+        break;
+    case DISASM_ADD_I:
+        fprintf(out, "    vm->I += vm->regs[0x%X];\n", x);
+        break;
+    case DISASM_LD_REGS:
+        for (unsigned i = 0; i <= x; i++)
+            fprintf(out, "    vm->regs[0x%X] = vm->ram[(vm->I + %u) & vm->ram_mask];\n", i, i);
+        break;
+    default:
+        fprintf(stderr, "Untranslatable instruction 0x%.4X at 0x%.3X\n", instruction, addr);
+        exit(EXIT_FAILURE);
+    }
+
+    emit_cycle(out);
+    if (is_last) {
+        fprintf(out, "    vm->PC = 0x%.3X;\n    return;\n", next);
+        return true;
+    }
+    fprintf(out, "    if (vm->cycles_left <= 0) {\n");
+    fprintf(out, "        vm->PC = 0x%.3X;\n        return;\n    }\n", next);
+    return false;
+}
+
+/* Emit a block function, returns the first address after the block */
+static uint16_t emit_block(FILE *out, uint16_t start)
+{
+    fprintf(out, "static void block_%.3X(chip8 *vm, aot *rt)\n{\n    (void)rt;\n\n", start);
+
+    uint16_t addr = start;
+    for (;;) {
+        uint16_t next = addr + 2;
+        bool is_last = !in_rom(next) || !is_code[next] || is_leader[next];
+        bool is_end = emit_instruction(out, addr, is_last);
+        addr = next;
+        if (is_end)
+            break;
+        fprintf(out, "\n");
+    }
+
+    fprintf(out, "}\n\n");
+    return addr;
+}
+
+static void emit(FILE *out, const char *rom_path)
+{
+    fprintf(out, "/* Generated by pchip-aot from %s, do not edit */\n\n", rom_path);
+    fprintf(out, "#include <stdlib.h>\n\n#include \"aot.h\"\n\n");
+
+    fprintf(out, "static const uint8_t rom[] = {");
+    for (size_t i = 0; i < rom_size; i++)
+        fprintf(out, "%s0x%.2X,", i % ROM_BYTES_PER_LINE ? " " : "\n    ", rom[i]);
+    fprintf(out, "\n};\n\n");
+
+    static uint16_t ends[MEMORY_SIZE_BYTES];
+    size_t block_count = 0;
+    for (uint32_t addr = PROGRAM_START_BYTES; addr < MEMORY_SIZE_BYTES; addr++) {
+        if (!is_code[addr] || !is_leader[addr])
+            continue;
+        ends[addr] = emit_block(out, addr);
+        block_count++;
+    }
+
+    fprintf(out, "static const aot_block blocks[] = {\n");
+    for (uint32_t addr = PROGRAM_START_BYTES; addr < MEMORY_SIZE_BYTES; addr++)
+        if (is_code[addr] && is_leader[addr])
+            fprintf(out, "    {0x%.3X, 0x%.3X, block_%.3X},\n", addr, ends[addr], addr);
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "const aot_program aot_rom = {\n");
+    fprintf(out, "    .rom = rom,\n    .rom_size = sizeof(rom),\n");
+    fprintf(out, "    .blocks = blocks,\n    .block_count = %zu,\n};\n", block_count);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <path/to/rom> <out.c>\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    FILE *in = fopen(argv[1], "rb");
+    if (!in) {
+        perror("fopen");
+        exit(EXIT_FAILURE);
+    }
+    rom_size = fread(rom, 1, sizeof(rom), in);
+    if (ferror(in) || fgetc(in) != EOF) {
+        fprintf(stderr, "Failed to read or too big to load: %s\n", argv[1]);
+        exit(EXIT_FAILURE);
+    }
+    fclose(in);
+
+    trace();
+
+    FILE *out = fopen(argv[2], "w");
+    if (!out) {
+        perror("fopen");
+        exit(EXIT_FAILURE);
+    }
+    emit(out, argv[1]);
+    if (fclose(out) != 0) {
+        perror("fclose");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t code_bytes = 0;
+    for (uint32_t addr = 0; addr < MEMORY_SIZE_BYTES; addr++)
+        code_bytes += is_code[addr] * 2;
+    fprintf(stderr, "%s: %zu bytes of code traced out of %zu\n", argv[1], code_bytes, rom_size);
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aot.h"
+
+struct aot {
+    const aot_program *prog;
+    size_t valid_blocks;
+    /* enum chip8_status of the last interpreted instruction */
+    int status;
+    /* Block starting at an address, NULL if there is none or it was
+     * invalidated */
+    aot_block_fn entry[MEMORY_SIZE_BYTES];
+};
+
+int aot_new(const aot_program *prog, aot **rt)
+{
+    *rt = calloc(1, sizeof(**rt));
+    if (!*rt) {
+        fprintf(stderr, "Calloc failure\n");
+        return AOT_FAIL;
+    }
+
+    (*rt)->prog = prog;
+    for (size_t i = 0; i < prog->block_count; i++) {
+        const aot_block *block = &prog->blocks[i];
+        if (block->start >= MEMORY_SIZE_BYTES)
+            continue;
+        (*rt)->entry[block->start] = block->fn;
+        (*rt)->valid_blocks++;
+    }
+
+    return AOT_SUCCESS;
+}
+
+void aot_free(aot *rt)
+{
+    free(rt);
+}
+
+bool aot_matches(const aot_program *prog, const uint8_t *rom, size_t rom_size)
+{
+    return prog->rom_size == rom_size && memcmp(prog->rom, rom, rom_size) == 0;
+}
+
+size_t aot_valid_blocks(const aot *rt)
+{
+    return rt->valid_blocks;
+}
+
+/* Drop the blocks overlapping [addr, addr + bytes), true if there were any */
+static bool invalidate(aot *rt, uint32_t addr, uint32_t bytes)
+{
+    bool is_invalidated = false;
+
+    for (size_t i = 0; i < rt->prog->block_count; i++) {
+        const aot_block *block = &rt->prog->blocks[i];
+        if (block->start >= addr + bytes || addr >= block->end)
+            continue;
+        if (!rt->entry[block->start])
+            continue;
+        rt->entry[block->start] = NULL;
+        rt->valid_blocks--;
+        is_invalidated = true;
+    }
+
+    return is_invalidated;
+}
+
+/* Run a single instruction, false if it wrote over translated code */
+static bool interpret(chip8 *vm, aot *rt)
+{
+    uint16_t instruction = chip8_fetch(vm);
+    uint16_t x = (0x0F00 & instruction) >> 8;
+    uint16_t addr = vm->I;
+    uint16_t bytes = 0;
+
+    /* Writes in CHIP-8 mode, I isn't changed by either */
+    if ((instruction & 0xF0FF) == 0xF033)
+        bytes = 3;
+    else if ((instruction & 0xF0FF) == 0xF055)
+        bytes = x + 1;
+
+    rt->status = chip8_frame_step(vm);
+
+    return !bytes || !invalidate(rt, addr, bytes);
+}
+
+bool aot_step(chip8 *vm, aot *rt, uint16_t next)
+{
+    bool is_intact = interpret(vm, rt);
+    return is_intact && rt->status == CHIP8_SUCCESS && vm->PC == next && vm->cycles_left > 0;
+}
+
+int aot_run_frame(chip8 *vm, aot *rt)
+{
+    if (vm->mode != CHIP8_MODE_CHIP8 || vm->timing != CHIP8_TIMING_FIXED || vm->quirks ||
+        vm->is_checked || vm->prof)
+        return chip8_run_frame(vm);
+
+    rt->status = chip8_frame_begin(vm);
+    if (rt->status != CHIP8_SUCCESS)
+        return rt->status;
+
+    while (vm->cycles_left > 0 && rt->status == CHIP8_SUCCESS) {
+        aot_block_fn fn = vm->PC < MEMORY_SIZE_BYTES ? rt->entry[vm->PC] : NULL;
+        if (fn)
+            fn(vm, rt);
+        else
+            interpret(vm, rt);
+    }
+    chip8_frame_end(vm);
+
+    return rt->status;
+}
@@ -0,0 +1,72 @@
+#ifndef AOT_H
+#define AOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "chip8.h"
+
+/*
+ * Runtime of statically recompiled ROMs
+ *
+ * pchip-aot translates the code reachable from PROGRAM_START_BYTES into a C
+ * translation unit, one function per basic block. A translated block runs
+ * until its end or until the frame budget is gone, leaving the VM exactly as
+ * the interpreter would. Whatever wasn't translated - computed jump targets,
+ * code reached only through Bnnn, blocks overwritten by the program - is
+ * interpreted one instruction at a time.
+ *
+ * Only CHIP-8 mode with fixed timing, no quirks, no checks and no profiler
+ * is recompiled, other configurations run on the interpreter.
+ */
+
+enum aot_status {
+    AOT_SUCCESS,
+    AOT_FAIL,
+};
+
+typedef struct aot aot;
+
+typedef void (*aot_block_fn)(chip8 *vm, aot *rt);
+
+typedef struct aot_block {
+    uint16_t start;
+    uint16_t end;               /* First byte after the block */
+    aot_block_fn fn;
+} aot_block;
+
+/* What pchip-aot generates */
+typedef struct aot_program {
+    const uint8_t *rom;
+    size_t rom_size;
+    const aot_block *blocks;
+    size_t block_count;
+} aot_program;
+
+/* The program generated by pchip-aot in a recompiled build */
+extern const aot_program aot_rom;
+
+int aot_new(const aot_program *prog, aot **rt);
+
+void aot_free(aot *rt);
+
+/* Check that a loaded ROM is the one the program was translated from */
+bool aot_matches(const aot_program *prog, const uint8_t *rom, size_t rom_size);
+
+/* chip8_run_frame() running translated blocks where possible */
+int aot_run_frame(chip8 *vm, aot *rt);
+
+/* Blocks still valid, i.e. not overwritten by the program */
+size_t aot_valid_blocks(const aot *rt);
+
+/*
+ * Called by translated code
+ * */
+
+/* Interpret the instruction at vm->PC, false if the block has to be left:
+ * the budget is gone, the instruction didn't fall through to next or it
+ * overwrote translated code */
+bool aot_step(chip8 *vm, aot *rt, uint16_t next);
+
+#endif /* AOT_H */
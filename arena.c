@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/mman.h>
+
+#include "arena.h"
+
+#define HUGE_PAGE_BYTES (2u << 20)
+
+struct arena {
+    uint8_t *base;
+    size_t capacity;
+    size_t used;
+};
+
+int arena_new(size_t capacity, arena **ar)
+{
+    *ar = calloc(1, sizeof(**ar));
+    if (!*ar) {
+        fprintf(stderr, "Calloc failure\n");
+        return ARENA_FAIL;
+    }
+
+    /* Whole huge pages, MAP_HUGETLB wants them */
+    capacity = (capacity + HUGE_PAGE_BYTES - 1) & ~(size_t)(HUGE_PAGE_BYTES - 1);
+    if (!capacity)
+        capacity = HUGE_PAGE_BYTES;
+
+    /* Reserved up front, a shortage of huge pages fails here and not as a
+     * SIGBUS later */
+    void *base = mmap(NULL, capacity, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (base == MAP_FAILED) {
+        /* No reserved huge pages, transparent ones if allowed */
+        base = mmap(NULL, capacity, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (base == MAP_FAILED) {
+            perror("mmap");
+            free(*ar);
+            *ar = NULL;
+            return ARENA_FAIL;
+        }
+        madvise(base, capacity, MADV_HUGEPAGE);
+    }
+
+    (*ar)->base = base;
+    (*ar)->capacity = capacity;
+
+    return ARENA_SUCCESS;
+}
+
+void arena_free(arena *ar)
+{
+    if (!ar)
+        return;
+    munmap(ar->base, ar->capacity);
+    free(ar);
+}
+
+void *arena_alloc(arena *ar, size_t bytes)
+{
+    size_t start = (ar->used + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (start > ar->capacity || bytes > ar->capacity - start)
+        return NULL;
+
+    ar->used = start + bytes;
+    return ar->base + start;
+}
+
+size_t arena_used(const arena *ar)
+{
+    return ar->used;
+}
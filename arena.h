@@ -0,0 +1,33 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/*
+ * Bump allocator over a single mapping, for many small objects that live and
+ * die together. Huge pages are used when the system has them reserved,
+ * transparent huge pages are asked for otherwise. Memory starts zeroed and is
+ * only committed as it's touched.
+ */
+
+#define ARENA_ALIGN 64          /* Cache line */
+
+enum arena_status {
+    ARENA_SUCCESS,
+    ARENA_FAIL,
+};
+
+typedef struct arena arena;
+
+/* Room for at least capacity bytes of allocations */
+int arena_new(size_t capacity, arena **ar);
+
+void arena_free(arena *ar);
+
+/* ARENA_ALIGN aligned, NULL when the arena is full */
+void *arena_alloc(arena *ar, size_t bytes);
+
+/* Bytes allocated so far, alignment included */
+size_t arena_used(const arena *ar);
+
+#endif /* ARENA_H */
@@ -0,0 +1,339 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <math.h>
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdalign.h>
+
+#include "audio.h"
+
+static_assert((AUDIO_EDGE_RING_SIZE & (AUDIO_EDGE_RING_SIZE - 1)) == 0,
+              "Edge ring size is expected to be a power of 2");
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "PCM samples are written as is, little-endian hosts only");
+
+#define CACHE_LINE_BYTES 64
+#define CHUNK_SAMPLES 1024
+#define THREAD_SLEEP_NSEC (5 * 1000 * 1000) /* 5ms */
+#define SAMPLE_AMPLITUDE 8000
+#define PATTERN_BITS (AUDIO_PATTERN_BYTES * 8)
+
+typedef struct audio_edge {
+    uint64_t sample;
+    bool is_on;
+    uint8_t pitch;
+    uint8_t pattern[AUDIO_PATTERN_BYTES];
+} audio_edge;
+
+struct audio {
+    audio_sink *sink;
+    pthread_t thread;
+    atomic_bool is_running;
+
+    /* Producer (emulation) side */
+    alignas(CACHE_LINE_BYTES) atomic_size_t head;
+    atomic_uint_fast64_t clock;
+    atomic_uint_fast64_t dropped;
+
+    /* Consumer (audio thread) side */
+    alignas(CACHE_LINE_BYTES) atomic_size_t tail;
+    uint64_t rendered;
+    bool is_on;
+    bool is_sink_broken;
+    double phase;
+    double step;
+    uint8_t pattern[AUDIO_PATTERN_BYTES];
+
+    audio_edge ring[AUDIO_EDGE_RING_SIZE];
+};
+
+static uint64_t usec_to_samples(uint64_t usec)
+{
+    return usec * AUDIO_SAMPLE_RATE / 1000000;
+}
+
+void audio_push_edge(audio *au, uint64_t usec, bool is_on, uint8_t pitch, const uint8_t pattern[AUDIO_PATTERN_BYTES])
+{
+    size_t head = atomic_load_explicit(&au->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&au->tail, memory_order_acquire);
+    if (head - tail == AUDIO_EDGE_RING_SIZE) {
+        atomic_fetch_add_explicit(&au->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    audio_edge *edge = &au->ring[head & (AUDIO_EDGE_RING_SIZE - 1)];
+    edge->sample = usec_to_samples(usec);
+    edge->is_on = is_on;
+    edge->pitch = pitch;
+    memcpy(edge->pattern, pattern, AUDIO_PATTERN_BYTES);
+
+    atomic_store_explicit(&au->head, head + 1, memory_order_release);
+}
+
+void audio_set_clock(audio *au, uint64_t usec)
+{
+    atomic_store_explicit(&au->clock, usec_to_samples(usec), memory_order_release);
+}
+
+uint64_t audio_dropped_edges(audio *au)
+{
+    return atomic_load_explicit(&au->dropped, memory_order_relaxed);
+}
+
+static void apply_edge(audio *au, const audio_edge *edge)
+{
+    au->is_on = edge->is_on;
+    memcpy(au->pattern, edge->pattern, AUDIO_PATTERN_BYTES);
+
+    /* XO-CHIP pattern playback rate is 4000*2^((pitch-64)/48) bits per second */
+    double rate = 4000.0 * pow(2.0, (edge->pitch - 64) / 48.0);
+    au->step = rate / AUDIO_SAMPLE_RATE;
+    if (!au->is_on)
+        au->phase = 0;
+}
+
+static void render(audio *au, int16_t *samples, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (!au->is_on) {
+            samples[i] = 0;
+            continue;
+        }
+
+        unsigned bit = (unsigned)au->phase % PATTERN_BITS;
+        bool is_high = (au->pattern[bit / 8] >> (7 - bit % 8)) & 0x1;
+        samples[i] = is_high ? SAMPLE_AMPLITUDE : -SAMPLE_AMPLITUDE;
+
+        au->phase += au->step;
+        if (au->phase >= PATTERN_BITS)
+            au->phase -= PATTERN_BITS;
+    }
+}
+
+/* Synthesize samples up to the given sample clock, applying edges at their
+ * exact sample positions */
+static void synthesize_until(audio *au, uint64_t clock)
+{
+    int16_t samples[CHUNK_SAMPLES];
+
+    while (au->rendered < clock) {
+        uint64_t limit = clock;
+
+        size_t tail = atomic_load_explicit(&au->tail, memory_order_relaxed);
+        size_t head = atomic_load_explicit(&au->head, memory_order_acquire);
+        if (tail != head) {
+            const audio_edge *edge = &au->ring[tail & (AUDIO_EDGE_RING_SIZE - 1)];
+            if (edge->sample <= au->rendered) {
+                apply_edge(au, edge);
+                atomic_store_explicit(&au->tail, tail + 1, memory_order_release);
+                continue;
+            }
+            if (edge->sample < limit)
+                limit = edge->sample;
+        }
+
+        if (limit - au->rendered > CHUNK_SAMPLES)
+            limit = au->rendered + CHUNK_SAMPLES;
+
+        size_t count = limit - au->rendered;
+        render(au, samples, count);
+        if (!au->is_sink_broken && au->sink->write(au->sink, samples, count) != AUDIO_SUCCESS) {
+            fprintf(stderr, "audio sink failure, going silent\n");
+            au->is_sink_broken = true;
+        }
+        au->rendered = limit;
+    }
+}
+
+static void *audio_thread(void *arg)
+{
+    audio *au = arg;
+    const struct timespec pause = { .tv_sec = 0, .tv_nsec = THREAD_SLEEP_NSEC };
+
+    for (;;) {
+        bool is_running = atomic_load_explicit(&au->is_running, memory_order_acquire);
+        uint64_t clock = atomic_load_explicit(&au->clock, memory_order_acquire);
+
+        synthesize_until(au, clock);
+
+        if (!is_running)
+            break;
+        nanosleep(&pause, NULL);
+    }
+
+    return NULL;
+}
+
+int audio_new(audio_sink *sink, audio **au)
+{
+    *au = calloc(1, sizeof(**au));
+    if (!*au) {
+        fprintf(stderr, "Calloc failure\n");
+        return AUDIO_FAIL;
+    }
+
+    (*au)->sink = sink;
+    atomic_store(&(*au)->is_running, true);
+
+    int rc = pthread_create(&(*au)->thread, NULL, audio_thread, *au);
+    if (rc != 0) {
+        fprintf(stderr, "Failed to start audio thread (%s)\n", strerror(rc));
+        free(*au);
+        *au = NULL;
+        return AUDIO_FAIL;
+    }
+
+    return AUDIO_SUCCESS;
+}
+
+void audio_free(audio *au)
+{
+    if (!au)
+        return;
+
+    atomic_store_explicit(&au->is_running, false, memory_order_release);
+    pthread_join(au->thread, NULL);
+
+    au->sink->free(au->sink);
+    free(au);
+}
+
+/*
+ * WAV file sink
+ * */
+
+typedef struct wav_sink {
+    audio_sink base;
+    FILE *file;
+    uint32_t data_bytes;
+} wav_sink;
+
+static void wav_write_header(wav_sink *wav)
+{
+    struct __attribute__((packed)) {
+        char riff[4];
+        uint32_t riff_bytes;
+        char wave[4];
+        char fmt[4];
+        uint32_t fmt_bytes;
+        uint16_t format;
+        uint16_t channels;
+        uint32_t sample_rate;
+        uint32_t byte_rate;
+        uint16_t block_align;
+        uint16_t bits_per_sample;
+        char data[4];
+        uint32_t data_bytes;
+    } header = {
+        .riff = "RIFF",
+        .riff_bytes = 36 + wav->data_bytes,
+        .wave = "WAVE",
+        .fmt = "fmt ",
+        .fmt_bytes = 16,
+        .format = 1,            /* PCM */
+        .channels = 1,
+        .sample_rate = AUDIO_SAMPLE_RATE,
+        .byte_rate = AUDIO_SAMPLE_RATE * sizeof(int16_t),
+        .block_align = sizeof(int16_t),
+        .bits_per_sample = 16,
+        .data = "data",
+        .data_bytes = wav->data_bytes,
+    };
+
+    fseek(wav->file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, wav->file);
+}
+
+static int wav_write(audio_sink *sink, const int16_t *samples, size_t count)
+{
+    wav_sink *wav = (wav_sink *)sink;
+    if (fwrite(samples, sizeof(*samples), count, wav->file) != count)
+        return AUDIO_FAIL;
+    wav->data_bytes += count * sizeof(*samples);
+    return AUDIO_SUCCESS;
+}
+
+static void wav_free(audio_sink *sink)
+{
+    wav_sink *wav = (wav_sink *)sink;
+
+    /* Sizes are only known now */
+    wav_write_header(wav);
+    fclose(wav->file);
+    free(wav);
+}
+
+int audio_sink_wav_new(const char *path, audio_sink **sink)
+{
+    wav_sink *wav = calloc(1, sizeof(*wav));
+    if (!wav) {
+        fprintf(stderr, "Calloc failure\n");
+        return AUDIO_FAIL;
+    }
+
+    wav->file = fopen(path, "wb");
+    if (!wav->file) {
+        perror("fopen");
+        free(wav);
+        return AUDIO_FAIL;
+    }
+
+    wav->base = (audio_sink){ .write = wav_write, .free = wav_free };
+    wav_write_header(wav);
+
+    *sink = &wav->base;
+    return AUDIO_SUCCESS;
+}
+
+/*
+ * External player sink
+ * */
+
+typedef struct pipe_sink {
+    audio_sink base;
+    FILE *pipe;
+} pipe_sink;
+
+static int pipe_write(audio_sink *sink, const int16_t *samples, size_t count)
+{
+    pipe_sink *p = (pipe_sink *)sink;
+    if (fwrite(samples, sizeof(*samples), count, p->pipe) != count)
+        return AUDIO_FAIL;
+    fflush(p->pipe);
+    return AUDIO_SUCCESS;
+}
+
+static void pipe_free(audio_sink *sink)
+{
+    pipe_sink *p = (pipe_sink *)sink;
+    pclose(p->pipe);
+    free(p);
+}
+
+int audio_sink_pipe_new(const char *command, audio_sink **sink)
+{
+    pipe_sink *p = calloc(1, sizeof(*p));
+    if (!p) {
+        fprintf(stderr, "Calloc failure\n");
+        return AUDIO_FAIL;
+    }
+
+    /* A player going away should silence the audio, not kill the emulator */
+    signal(SIGPIPE, SIG_IGN);
+
+    p->pipe = popen(command, "w");
+    if (!p->pipe) {
+        perror("popen");
+        free(p);
+        return AUDIO_FAIL;
+    }
+
+    p->base = (audio_sink){ .write = pipe_write, .free = pipe_free };
+
+    *sink = &p->base;
+    return AUDIO_SUCCESS;
+}
@@ -0,0 +1,54 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define AUDIO_SAMPLE_RATE 44100 /* Hz, mono signed 16-bit PCM */
+#define AUDIO_EDGE_RING_SIZE 256 /* Tone edges in flight, power of 2 */
+
+/* XO-CHIP audio pattern buffer, 128 1-bit samples */
+#define AUDIO_PATTERN_BYTES 16
+/* XO-CHIP default pitch, 4000Hz playback rate */
+#define AUDIO_PITCH_DEFAULT 64
+
+enum audio_status {
+    AUDIO_SUCCESS,
+    AUDIO_FAIL,
+};
+
+/* Where synthesized PCM goes, only ever called from the audio thread */
+typedef struct audio_sink audio_sink;
+struct audio_sink {
+    int (*write)(audio_sink *sink, const int16_t *samples, size_t count);
+    void (*free)(audio_sink *sink);
+};
+
+/* Write a WAV file, handy for headless runs */
+int audio_sink_wav_new(const char *path, audio_sink **sink);
+
+/* Pipe raw PCM into a player command, e.g. "aplay -q -f S16_LE -r 44100 -c 1" */
+int audio_sink_pipe_new(const char *command, audio_sink **sink);
+
+typedef struct audio audio;
+
+/* Start the audio thread, the sink is owned by audio afterwards */
+int audio_new(audio_sink *sink, audio **au);
+
+/* Synthesize everything up to the last published time, stop the thread and
+ * free the sink */
+void audio_free(audio *au);
+
+/* Emulation side: push a tone on/off edge at usec of emulated time. Never
+ * blocks, an edge is dropped if the ring is full. */
+void audio_push_edge(audio *au, uint64_t usec, bool is_on, uint8_t pitch, const uint8_t pattern[AUDIO_PATTERN_BYTES]);
+
+/* Emulation side: publish emulated time, the audio thread synthesizes up to
+ * this point */
+void audio_set_clock(audio *au, uint64_t usec);
+
+/* Edges lost because of a full ring */
+uint64_t audio_dropped_edges(audio *au);
+
+#endif /* AUDIO_H */
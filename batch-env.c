@@ -0,0 +1,358 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "batch-env.h"
+
+/* Environments taken by a thread at a time, neighbours in the pool */
+#define BATCH_ENV_CHUNK 32
+
+#define MAX_BINARY_BYTES 4
+#define MAX_DIGITS_BYTES 9
+
+enum job {
+    JOB_STEP,
+    JOB_RESET,
+};
+
+struct batch_env {
+    batch_env_config config;
+    pchip_pool *pool;
+    size_t count;
+
+    /* Where episodes start */
+    uint8_t *initial;
+
+    /* Per environment: frames into the episode and reward term values as of
+     * the previous step, reward_count of them */
+    uint32_t *episode_frames;
+    uint64_t *reward_values;
+
+    /* The job in progress */
+    enum job job;
+    const uint16_t *keys;
+    uint8_t *frames;
+    float *rewards;
+    uint8_t *dones;
+    atomic_size_t next_chunk;
+    atomic_bool is_failed;
+
+    /* Workers wait for the next generation and report when done */
+    pthread_mutex_t lock;
+    pthread_cond_t job_ready;
+    pthread_cond_t job_done;
+    uint64_t generation;
+    uint32_t running;
+    bool is_stopping;
+    pthread_t *threads;
+    uint32_t thread_count;
+    bool is_sync_ready;
+};
+
+void batch_env_config_default(batch_env_config *config)
+{
+    *config = (batch_env_config){ .threads = 0, .is_halt_done = true };
+    pchip_config_default(&config->machine);
+}
+
+static bool is_term_valid(const batch_env_reward *term, enum chip8_mode mode)
+{
+    uint32_t ram_bytes = mode == CHIP8_MODE_XOCHIP ? XOCHIP_MEMORY_SIZE_BYTES : MEMORY_SIZE_BYTES;
+    uint8_t max_bytes = term->encoding == BATCH_ENV_DIGITS ? MAX_DIGITS_BYTES : MAX_BINARY_BYTES;
+
+    return (term->encoding == BATCH_ENV_BINARY || term->encoding == BATCH_ENV_DIGITS) &&
+        term->bytes >= 1 && term->bytes <= max_bytes &&
+        (uint32_t)term->address + term->bytes <= ram_bytes;
+}
+
+static uint64_t read_term(const chip8 *vm, const batch_env_reward *term)
+{
+    uint64_t value = 0;
+
+    for (uint8_t i = 0; i < term->bytes; i++) {
+        uint8_t byte = vm->ram[term->address + i];
+        value = term->encoding == BATCH_ENV_DIGITS ? value * 10 + byte : value << 8 | byte;
+    }
+
+    return value;
+}
+
+/* The change since the previous call, scaled */
+static float take_reward(batch_env *env, size_t i, const chip8 *vm)
+{
+    uint64_t *values = &env->reward_values[i * env->config.reward_count];
+    float reward = 0;
+
+    for (uint8_t t = 0; t < env->config.reward_count; t++) {
+        const batch_env_reward *term = &env->config.rewards[t];
+        uint64_t value = read_term(vm, term);
+        reward += term->scale * (float)((int64_t)value - (int64_t)values[t]);
+        values[t] = value;
+    }
+
+    return reward;
+}
+
+/* Back to the initial state, the RND stream goes on. Memory stays in the
+ * environment's own copy. */
+static bool restart(batch_env *env, size_t i)
+{
+    chip8 *vm = pchip_machine(pchip_pool_get(env->pool, i));
+    uint32_t rng_state = vm->rng_state;
+
+    if (chip8_load_state_private(vm, env->initial) != CHIP8_SUCCESS)
+        return false;
+    vm->rng_state = rng_state;
+
+    env->episode_frames[i] = 0;
+    take_reward(env, i, vm);
+
+    return true;
+}
+
+static bool step_one(batch_env *env, size_t i)
+{
+    pchip *inst = pchip_pool_get(env->pool, i);
+    bool is_ok = true;
+    bool is_done = true;
+
+    if (env->job == JOB_STEP) {
+        pchip_set_keys(inst, env->keys[i]);
+        int rc = pchip_run_frame(inst);
+        env->episode_frames[i]++;
+
+        float reward = take_reward(env, i, pchip_machine(inst));
+        if (env->rewards)
+            env->rewards[i] = reward;
+
+        is_ok = rc != CHIP8_FAIL;
+        is_done = rc == CHIP8_FAULT || rc == CHIP8_FAIL ||
+            (rc == CHIP8_HALT && env->config.is_halt_done) ||
+            (env->config.max_episode_frames && env->episode_frames[i] >= env->config.max_episode_frames);
+        if (env->dones)
+            env->dones[i] = is_done;
+    }
+
+    if (is_done && !restart(env, i))
+        is_ok = false;
+    if (env->frames)
+        stream_pack_frame(pchip_display(inst), env->frames + i * BATCH_ENV_FRAME_BYTES);
+
+    return is_ok;
+}
+
+static void run_chunks(batch_env *env)
+{
+    for (;;) {
+        size_t start = atomic_fetch_add(&env->next_chunk, BATCH_ENV_CHUNK);
+        if (start >= env->count)
+            return;
+
+        size_t end = start + BATCH_ENV_CHUNK < env->count ? start + BATCH_ENV_CHUNK : env->count;
+        for (size_t i = start; i < end; i++) {
+            if (!step_one(env, i))
+                atomic_store(&env->is_failed, true);
+        }
+    }
+}
+
+static void *worker(void *arg)
+{
+    batch_env *env = arg;
+    uint64_t seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&env->lock);
+        while (env->generation == seen && !env->is_stopping)
+            pthread_cond_wait(&env->job_ready, &env->lock);
+        seen = env->generation;
+        bool is_stopping = env->is_stopping;
+        pthread_mutex_unlock(&env->lock);
+        if (is_stopping)
+            return NULL;
+
+        run_chunks(env);
+
+        pthread_mutex_lock(&env->lock);
+        if (--env->running == 0)
+            pthread_cond_signal(&env->job_done);
+        pthread_mutex_unlock(&env->lock);
+    }
+}
+
+/* The caller takes chunks too */
+static int run_job(batch_env *env)
+{
+    atomic_store(&env->next_chunk, 0);
+    atomic_store(&env->is_failed, false);
+
+    pthread_mutex_lock(&env->lock);
+    env->running = env->thread_count;
+    env->generation++;
+    pthread_cond_broadcast(&env->job_ready);
+    pthread_mutex_unlock(&env->lock);
+
+    run_chunks(env);
+
+    pthread_mutex_lock(&env->lock);
+    while (env->running)
+        pthread_cond_wait(&env->job_done, &env->lock);
+    pthread_mutex_unlock(&env->lock);
+
+    return atomic_load(&env->is_failed) ? BATCH_ENV_FAIL : BATCH_ENV_SUCCESS;
+}
+
+int batch_env_new(const batch_env_config *config, const uint8_t *rom, size_t rom_size,
+                  size_t count, batch_env **env)
+{
+    if (!count || config->reward_count > BATCH_ENV_MAX_REWARD_TERMS)
+        return BATCH_ENV_FAIL;
+    for (uint8_t t = 0; t < config->reward_count; t++) {
+        if (!is_term_valid(&config->rewards[t], config->machine.settings.mode))
+            return BATCH_ENV_FAIL;
+    }
+
+    *env = calloc(1, sizeof(**env));
+    if (!*env) {
+        fprintf(stderr, "Calloc failure\n");
+        return BATCH_ENV_FAIL;
+    }
+
+    batch_env *e = *env;
+    e->config = *config;
+    e->count = count;
+
+    if (pchip_pool_new(&config->machine, rom, rom_size, count, &e->pool) != PCHIP_SUCCESS)
+        goto err;
+
+    const chip8 *first = pchip_machine(pchip_pool_get(e->pool, 0));
+    e->initial = malloc(chip8_state_size(first));
+    e->episode_frames = calloc(count, sizeof(*e->episode_frames));
+    e->reward_values = calloc(count * (config->reward_count ? config->reward_count : 1),
+                              sizeof(*e->reward_values));
+    if (!e->initial || !e->episode_frames || !e->reward_values) {
+        fprintf(stderr, "Malloc failure\n");
+        goto err;
+    }
+    chip8_save_state(first, e->initial);
+
+    /* Private copies up front, steps would make them on the first write
+     * otherwise */
+    for (size_t i = 0; i < count; i++) {
+        chip8 *vm = pchip_machine(pchip_pool_get(e->pool, i));
+        if (chip8_unshare_ram(vm) != CHIP8_SUCCESS)
+            goto err;
+        take_reward(e, i, vm);
+    }
+
+    if (pthread_mutex_init(&e->lock, NULL) != 0)
+        goto err;
+    if (pthread_cond_init(&e->job_ready, NULL) != 0) {
+        pthread_mutex_destroy(&e->lock);
+        goto err;
+    }
+    if (pthread_cond_init(&e->job_done, NULL) != 0) {
+        pthread_cond_destroy(&e->job_ready);
+        pthread_mutex_destroy(&e->lock);
+        goto err;
+    }
+    e->is_sync_ready = true;
+
+    /* No more threads than chunks, the caller being one of them */
+    long threads = config->threads ? (long)config->threads : sysconf(_SC_NPROCESSORS_ONLN);
+    size_t chunks = (count + BATCH_ENV_CHUNK - 1) / BATCH_ENV_CHUNK;
+    if (threads < 1)
+        threads = 1;
+    if ((size_t)threads > chunks)
+        threads = chunks;
+
+    e->threads = calloc(threads, sizeof(*e->threads));
+    if (!e->threads) {
+        fprintf(stderr, "Calloc failure\n");
+        goto err;
+    }
+    /* Fewer workers if the system says so, not a failure */
+    for (long i = 0; i < threads - 1; i++) {
+        if (pthread_create(&e->threads[i], NULL, worker, e) != 0)
+            break;
+        e->thread_count++;
+    }
+
+    return BATCH_ENV_SUCCESS;
+
+err:
+    batch_env_free(e);
+    *env = NULL;
+    return BATCH_ENV_FAIL;
+}
+
+void batch_env_free(batch_env *env)
+{
+    if (!env)
+        return;
+
+    if (env->is_sync_ready) {
+        pthread_mutex_lock(&env->lock);
+        env->is_stopping = true;
+        pthread_cond_broadcast(&env->job_ready);
+        pthread_mutex_unlock(&env->lock);
+        for (uint32_t i = 0; i < env->thread_count; i++)
+            pthread_join(env->threads[i], NULL);
+
+        pthread_cond_destroy(&env->job_done);
+        pthread_cond_destroy(&env->job_ready);
+        pthread_mutex_destroy(&env->lock);
+    }
+
+    free(env->threads);
+    free(env->reward_values);
+    free(env->episode_frames);
+    free(env->initial);
+    pchip_pool_free(env->pool);
+    free(env);
+}
+
+size_t batch_env_count(const batch_env *env)
+{
+    return env->count;
+}
+
+pchip *batch_env_get(batch_env *env, size_t i)
+{
+    return pchip_pool_get(env->pool, i);
+}
+
+int batch_env_set_initial(batch_env *env, size_t i)
+{
+    if (i >= env->count)
+        return BATCH_ENV_FAIL;
+
+    chip8_save_state(pchip_machine(pchip_pool_get(env->pool, i)), env->initial);
+    return BATCH_ENV_SUCCESS;
+}
+
+int batch_env_reset(batch_env *env, uint8_t *frames)
+{
+    env->job = JOB_RESET;
+    env->keys = NULL;
+    env->frames = frames;
+    env->rewards = NULL;
+    env->dones = NULL;
+
+    return run_job(env);
+}
+
+int batch_env_step(batch_env *env, const uint16_t *keys,
+                   uint8_t *frames, float *rewards, uint8_t *dones)
+{
+    env->job = JOB_STEP;
+    env->keys = keys;
+    env->frames = frames;
+    env->rewards = rewards;
+    env->dones = dones;
+
+    return run_job(env);
+}
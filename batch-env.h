@@ -0,0 +1,98 @@
+#ifndef BATCH_ENV_H
+#define BATCH_ENV_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "pchip.h"
+#include "stream.h"
+
+/*
+ * Batched environments for training agents: many instances of a ROM on a
+ * pchip_pool, stepped a frame at a time all together.
+ *
+ * A step takes a key bitmask per environment and gives back its frame, its
+ * reward and whether its episode is over, all written into arrays the caller
+ * owns. Environments are split between worker threads started up front.
+ * Every environment gets its private copy of memory up front too, a step
+ * doesn't allocate.
+ *
+ * Episodes that are over start again from the initial state right away: the
+ * frame written for them is the first one of the next episode, the reward is
+ * the last one of the previous episode. The initial state is the ROM just
+ * loaded, or any environment's state taken with batch_env_set_initial().
+ * Environments keep their own RND streams across episodes.
+ */
+
+/* Frames are in the frame stream layout, see stream.h */
+#define BATCH_ENV_FRAME_BYTES STREAM_FRAME_BYTES
+
+enum batch_env_status {
+    BATCH_ENV_SUCCESS,
+    BATCH_ENV_FAIL,
+};
+
+/* How a reward term value is stored in memory */
+enum batch_env_encoding {
+    /* Unsigned, big-endian, 1 to 4 bytes */
+    BATCH_ENV_BINARY,
+    /* Decimal digits a byte each, most significant first, as FX33 leaves
+     * them, up to 9 bytes */
+    BATCH_ENV_DIGITS,
+};
+
+/* A reward is the sum of every term's change since the previous step
+ * multiplied by its scale, e.g. a score at 0x3F0 and a lives counter */
+typedef struct batch_env_reward {
+    uint16_t address;
+    uint8_t bytes;
+    uint8_t encoding;           /* enum batch_env_encoding */
+    float scale;
+} batch_env_reward;
+
+#define BATCH_ENV_MAX_REWARD_TERMS 8
+
+typedef struct batch_env_config {
+    pchip_config machine;
+    /* Worker threads together with the caller, 0 for one per CPU */
+    uint32_t threads;
+    /* Episodes are cut at this many frames, 0 for never */
+    uint32_t max_episode_frames;
+    /* A program jumping to itself is over, faults always are */
+    bool is_halt_done;
+    batch_env_reward rewards[BATCH_ENV_MAX_REWARD_TERMS];
+    uint8_t reward_count;
+} batch_env_config;
+
+typedef struct batch_env batch_env;
+
+/* Default machine settings, a thread per CPU, no episode limit, halts end
+ * episodes, no reward terms */
+void batch_env_config_default(batch_env_config *config);
+
+/* BATCH_ENV_FAIL for a ROM that doesn't fit or reward terms out of memory */
+int batch_env_new(const batch_env_config *config, const uint8_t *rom, size_t rom_size,
+                  size_t count, batch_env **env);
+
+void batch_env_free(batch_env *env);
+
+size_t batch_env_count(const batch_env *env);
+
+/* Environment N for a closer look, not to be run outside of steps */
+pchip *batch_env_get(batch_env *env, size_t i);
+
+/* Environment N's current state is where episodes start from now on */
+int batch_env_set_initial(batch_env *env, size_t i);
+
+/* Start every episode over, frames as for batch_env_step() */
+int batch_env_reset(batch_env *env, uint8_t *frames);
+
+/* A frame of every environment with keys[N] held in environment N, bit K for
+ * CHIP-8 key K. Outputs are count entries each, frames BATCH_ENV_FRAME_BYTES
+ * per environment, any of them can be NULL. BATCH_ENV_FAIL on a host
+ * failure, the environment is reset and reported done. */
+int batch_env_step(batch_env *env, const uint16_t *keys,
+                   uint8_t *frames, float *rewards, uint8_t *dones);
+
+#endif /* BATCH_ENV_H */
@@ -0,0 +1,406 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "chip8.h"
+
+#define DEFAULT_FRAMES 3600     /* 1 minute of emulated time */
+#define EXEC_ITERATIONS 2000000
+#define SPRITE_ITERATIONS 1000000
+#define REDRAW_ITERATIONS 2000
+
+enum bench_format {
+    BENCH_FORMAT_CSV,
+    BENCH_FORMAT_JSON,
+};
+
+typedef struct bench_results {
+    FILE *out;
+    enum bench_format format;
+    size_t count;
+} bench_results;
+
+/* Renderer output goes here so that its size can be measured */
+static int render_fd = -1;
+
+static uint64_t now_nsec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void results_begin(bench_results *res)
+{
+    if (res->format == BENCH_FORMAT_JSON)
+        fprintf(res->out, "[\n");
+    else
+        fprintf(res->out, "group,name,value,unit\n");
+}
+
+static void results_add(bench_results *res, const char *group, const char *name, double value, const char *unit)
+{
+    if (res->format == BENCH_FORMAT_JSON) {
+        fprintf(res->out, "%s  {\"group\": \"%s\", \"name\": \"", res->count ? ",\n" : "", group);
+        for (const char *c = name; *c; c++) {
+            if (*c == '"' || *c == '\\')
+                fputc('\\', res->out);
+            fputc(*c, res->out);
+        }
+        fprintf(res->out, "\", \"value\": %.3f, \"unit\": \"%s\"}", value, unit);
+    } else {
+        /* ROM names have commas in them */
+        fprintf(res->out, "%s,\"", group);
+        for (const char *c = name; *c; c++) {
+            if (*c == '"')
+                fputc('"', res->out);
+            fputc(*c, res->out);
+        }
+        fprintf(res->out, "\",%.3f,%s\n", value, unit);
+    }
+    res->count++;
+}
+
+static void results_end(bench_results *res)
+{
+    if (res->format == BENCH_FORMAT_JSON)
+        fprintf(res->out, "\n]\n");
+    fflush(res->out);
+}
+
+static size_t render_bytes_take(void)
+{
+    fflush(stdout);
+    off_t bytes = lseek(render_fd, 0, SEEK_CUR);
+    if (ftruncate(render_fd, 0) != 0)
+        perror("ftruncate");
+    lseek(render_fd, 0, SEEK_SET);
+    return bytes > 0 ? (size_t)bytes : 0;
+}
+
+/*
+ * Per-opcode cost of chip8_exec()
+ * */
+
+typedef struct exec_case {
+    const char *name;
+    uint16_t instruction;
+} exec_case;
+
+static const exec_case exec_cases[] = {
+    { "SYS addr", 0x0123 },
+    { "CLS", 0x00e0 },
+    { "RET", 0x00ee },
+    { "JP addr", 0x1200 },
+    { "CALL addr", 0x2200 },
+    { "SE Vx, byte", 0x3112 },
+    { "SNE Vx, byte", 0x4112 },
+    { "SE Vx, Vy", 0x5120 },
+    { "LD Vx, byte", 0x6112 },
+    { "ADD Vx, byte", 0x7112 },
+    { "LD Vx, Vy", 0x8120 },
+    { "OR Vx, Vy", 0x8121 },
+    { "AND Vx, Vy", 0x8122 },
+    { "XOR Vx, Vy", 0x8123 },
+    { "ADD Vx, Vy", 0x8124 },
+    { "SUB Vx, Vy", 0x8125 },
+    { "SHR Vx", 0x8126 },
+    { "SUBN Vx, Vy", 0x8127 },
+    { "SHL Vx", 0x812e },
+    { "SNE Vx, Vy", 0x9120 },
+    { "LD I, addr", 0xa300 },
+    { "JP V0, addr", 0xb200 },
+    { "RND Vx, byte", 0xc1ff },
+    { "DRW Vx, Vy, 1", 0xd121 },
+    { "DRW Vx, Vy, 8", 0xd128 },
+    { "DRW Vx, Vy, 15", 0xd12f },
+    { "SKP Vx", 0xe19e },
+    { "SKNP Vx", 0xe1a1 },
+    { "LD Vx, DT", 0xf107 },
+    { "LD Vx, K", 0xf10a },
+    { "LD DT, Vx", 0xf115 },
+    { "LD ST, Vx", 0xf118 },
+    { "ADD I, Vx", 0xf11e },
+    { "LD F, Vx", 0xf129 },
+    { "LD B, Vx", 0xf133 },
+    { "LD [I], Vx", 0xf755 },
+    { "LD Vx, [I]", 0xf765 },
+};
+
+static void bench_exec(bench_results *res, keyboard *key, fb_console *display)
+{
+    chip8 *vm = calloc(1, sizeof(*vm));
+    chip8_reset(vm, key, display);
+
+    /* A key is down so that LD Vx, K doesn't wait */
+    keyboard_set_key(key, CHIP8_KEY_1, true);
+
+    for (size_t c = 0; c < sizeof(exec_cases) / sizeof(exec_cases[0]); c++) {
+        const exec_case *ec = &exec_cases[c];
+
+        uint64_t start = now_nsec();
+        for (size_t i = 0; i < EXEC_ITERATIONS; i++) {
+            /* Keep the machine in the same state for every iteration */
+            vm->PC = PROGRAM_START_BYTES;
+            vm->SP = 1;
+            vm->I = 0x300;
+            vm->regs[V1] = 0x0b;
+            chip8_exec(vm, ec->instruction);
+        }
+        uint64_t elapsed = now_nsec() - start;
+
+        results_add(res, "exec", ec->name, (double)elapsed / EXEC_ITERATIONS, "ns/op");
+    }
+
+    keyboard_set_key(key, CHIP8_KEY_1, false);
+    free(vm);
+}
+
+/*
+ * fb_draw_sprite() and fb_redraw() throughput
+ * */
+
+static void bench_sprites(bench_results *res, fb_console *display)
+{
+    static const struct {
+        const char *name;
+        uint8_t bytes;
+        uint8_t x;
+        uint8_t y;
+    } cases[] = {
+        { "8x1 aligned", 1, 8, 4 },
+        { "8x5 aligned", 5, 8, 4 },
+        { "8x15 aligned", 15, 8, 4 },
+        { "8x5 unaligned", 5, 13, 4 },
+        { "8x15 unaligned", 15, 13, 4 },
+        { "8x15 wrapping", 15, 61, 25 },
+    };
+    uint8_t sprite[SPRITE_MAX_SIZE * FRAMEBUF_PLANES];
+    for (size_t i = 0; i < sizeof(sprite); i++)
+        sprite[i] = 0xa5 ^ i;
+
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        bool is_pixel_erased = false;
+
+        uint64_t start = now_nsec();
+        for (size_t i = 0; i < SPRITE_ITERATIONS; i++)
+            fb_draw_sprite(display, sprite, cases[c].bytes, cases[c].x, cases[c].y, &is_pixel_erased);
+        uint64_t elapsed = now_nsec() - start;
+
+        results_add(res, "draw_sprite", cases[c].name,
+                    SPRITE_ITERATIONS / ((double)elapsed / 1e9), "sprites/s");
+    }
+}
+
+static void bench_redraw(bench_results *res, fb_console *display)
+{
+    bool keyboard_state[CHIP8_KEY_COUNT] = {0};
+
+    render_bytes_take();
+
+    uint64_t start = now_nsec();
+    for (size_t i = 0; i < REDRAW_ITERATIONS; i++) {
+        display->is_dirty = true;
+        fb_redraw(display, keyboard_state);
+    }
+    fflush(stdout);
+    uint64_t elapsed = now_nsec() - start;
+
+    size_t bytes = render_bytes_take();
+
+    results_add(res, "redraw", "full frame",
+                REDRAW_ITERATIONS / ((double)elapsed / 1e9), "frames/s");
+    results_add(res, "redraw", "full frame", (double)bytes / REDRAW_ITERATIONS, "bytes/frame");
+}
+
+/*
+ * ROM corpus
+ * */
+
+static int load_rom(chip8 *vm, const char *path)
+{
+    struct stat sb;
+    if (stat(path, &sb) == -1 || sb.st_size > MAX_ROM_SIZE_BYTES)
+        return -1;
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+        return -1;
+    ssize_t bytes_read = read(fd, vm->ram + PROGRAM_START_BYTES, (size_t)sb.st_size);
+    close(fd);
+
+    return bytes_read == sb.st_size ? 0 : -1;
+}
+
+/* chip8_cpu_tick() stops the clock at a fault, the ROM is reported instead of
+ * measured */
+static bool is_stopped(bench_results *res, const char *name, chip8 *vm, int rc, size_t frame)
+{
+    if (rc != CHIP8_FAULT && rc != CHIP8_FAIL)
+        return false;
+
+    if (rc == CHIP8_FAULT)
+        fprintf(stderr, "%s: %s at 0x%.3X, frame %zu\n", name, chip8_fault_name(vm->fault.kind), vm->fault.pc, frame);
+    else
+        fprintf(stderr, "%s: host failure, frame %zu\n", name, frame);
+    results_add(res, "rom_fault", name, frame, "frame");
+    return true;
+}
+
+static void bench_rom(bench_results *res, const char *path, size_t frames, keyboard *key, fb_console *display)
+{
+    chip8 *vm = calloc(1, sizeof(*vm));
+    bool keyboard_state[CHIP8_KEY_COUNT] = {0};
+    const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+
+    /* Core only: the regular scheduler loop without sleeping */
+    chip8_reset(vm, key, display);
+    if (load_rom(vm, path) != 0) {
+        fprintf(stderr, "Failed to load %s\n", path);
+        free(vm);
+        return;
+    }
+
+    uint64_t instructions = 0;
+    uint64_t start = now_nsec();
+    for (size_t frame = 0; frame < frames; ) {
+        instructions += vm->usec_to_cpu_tick == 0;
+        frame += vm->usec_to_timer_tick == 0;
+        if (is_stopped(res, name, vm, chip8_cpu_tick(vm), frame)) {
+            free(vm);
+            return;
+        }
+        chip8_timers_tick(vm);
+        chip8_tick(vm);
+    }
+    uint64_t elapsed = now_nsec() - start;
+
+    results_add(res, "rom_ips", name, instructions / ((double)elapsed / 1e9), "instr/s");
+
+    /* Same again, presenting every frame */
+    chip8_reset(vm, key, display);
+    load_rom(vm, path);
+    render_bytes_take();
+
+    size_t frames_presented = 0;
+    for (size_t frame = 0; frame < frames; ) {
+        bool is_frame = vm->usec_to_timer_tick == 0;
+        if (is_stopped(res, name, vm, chip8_cpu_tick(vm), frame)) {
+            free(vm);
+            return;
+        }
+        chip8_timers_tick(vm);
+        if (is_frame) {
+            frames_presented += display->is_dirty;
+            fb_redraw(display, keyboard_state);
+            frame++;
+        }
+        chip8_tick(vm);
+    }
+
+    size_t bytes = render_bytes_take();
+    results_add(res, "rom_output", name, (double)bytes / frames, "bytes/frame");
+    results_add(res, "rom_output", name, (double)frames_presented / frames, "redraws/frame");
+
+    free(vm);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [-f csv|json] [-o results] [-n frames] [path/to/rom ...]\n", prog);
+    fprintf(stderr, "  ROMs default to roms/games/*.ch8 and roms/demos/*.ch8\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+{
+    bench_results res = { .format = BENCH_FORMAT_CSV };
+    const char *out_path = NULL;
+    size_t frames = DEFAULT_FRAMES;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "f:o:n:")) != -1) {
+        switch (opt) {
+        case 'f':
+            if (strcmp(optarg, "json") == 0)
+                res.format = BENCH_FORMAT_JSON;
+            else if (strcmp(optarg, "csv") == 0)
+                res.format = BENCH_FORMAT_CSV;
+            else
+                usage(argv[0]);
+            break;
+        case 'o':
+            out_path = optarg;
+            break;
+        case 'n':
+            frames = strtoul(optarg, NULL, 10);
+            if (!frames)
+                usage(argv[0]);
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    /* Results go to the original stdout, fb_redraw() output to a scratch file */
+    res.out = out_path ? fopen(out_path, "w") : fdopen(dup(fileno(stdout)), "w");
+    if (!res.out) {
+        perror("results");
+        exit(EXIT_FAILURE);
+    }
+
+    FILE *scratch = tmpfile();
+    if (!scratch) {
+        perror("tmpfile");
+        exit(EXIT_FAILURE);
+    }
+    render_fd = fileno(scratch);
+    fflush(stdout);
+    dup2(render_fd, fileno(stdout));
+
+    keyboard *key = NULL;
+    int rc = keyboard_new_virtual(&key);
+    if (rc != KEYBOARD_SUCCESS) {
+        fprintf(stderr, "Failed to init keyboard\n");
+        exit(EXIT_FAILURE);
+    }
+
+    fb_console *display = NULL;
+    rc = fb_new(&display);
+    if (rc != FB_CONSOLE_SUCCESS) {
+        fprintf(stderr, "Failed to init display\n");
+        exit(EXIT_FAILURE);
+    }
+
+    results_begin(&res);
+
+    bench_exec(&res, key, display);
+    bench_sprites(&res, display);
+    bench_redraw(&res, display);
+
+    glob_t roms = {0};
+    if (optind < argc) {
+        for (int i = optind; i < argc; i++)
+            bench_rom(&res, argv[i], frames, key, display);
+    } else {
+        glob("roms/games/*.ch8", 0, NULL, &roms);
+        glob("roms/demos/*.ch8", GLOB_APPEND, NULL, &roms);
+        for (size_t i = 0; i < roms.gl_pathc; i++)
+            bench_rom(&res, roms.gl_pathv[i], frames, key, display);
+        globfree(&roms);
+    }
+
+    results_end(&res);
+    fclose(res.out);
+
+    fb_free(display);
+    keyboard_free(key);
+    fclose(scratch);
+
+    return 0;
+}
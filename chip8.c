@@ -1,6 +1,10 @@
 #include "chip8.h"
+#include "profile.h"
+#include "vip-timing.h"
+#include "latency.h"
 
 #include <stdio.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -11,22 +15,98 @@
         __auto_type _b = (b);                   \
         _a < _b ? _a : _b; })
 
-static void load_sprites(chip8 *vm);
+static void load_sprites(uint8_t *ram);
 
-void chip8_reset(chip8 *vm, keyboard *key, fb_console *display)
+/* Plain CHIP-8 buzzer, a 500Hz square wave at the default pitch */
+static const uint8_t audio_pattern_default[AUDIO_PATTERN_BYTES] = {
+    0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+    0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0,
+};
+
+static uint16_t mode_ram_mask(enum chip8_mode mode)
+{
+    return mode == CHIP8_MODE_XOCHIP ? XOCHIP_MEMORY_SIZE_BYTES - 1 : MEMORY_SIZE_BYTES - 1;
+}
+
+/* Everything but memory, the machine being zeroed */
+static int reset_machine(chip8 *vm, keyboard *key, fb_console *display, enum chip8_mode mode)
 {
-    *vm = (chip8){0};
     vm->PC = PROGRAM_START_BYTES;
     vm->key = key;
     vm->display = display;
-    assert(KEYBOARD_SUCCESS == keyboard_flush(vm->key));
+    vm->mode = mode;
+    vm->ram_mask = mode_ram_mask(mode);
+    vm->timing = CHIP8_TIMING_FIXED;
+    vm->usec_per_cpu_step = USECONDS_PER_STEP_CPU;
+    chip8_set_quirks(vm, 0);
+    vm->pitch = AUDIO_PITCH_DEFAULT;
+    memcpy(vm->audio_pattern, audio_pattern_default, AUDIO_PATTERN_BYTES);
+    chip8_set_seed(vm, time(NULL));
 
-    load_sprites(vm);
+    /* Blank on every plane, whatever the previous program drew */
+    fb_set_hires(vm->display, false);
+    fb_select_planes(vm->display, FRAMEBUF_PLANE_MASK);
+    fb_clear(vm->display);
+    fb_select_planes(vm->display, 0x1);
 
-    srand(time(NULL));
+    return keyboard_flush(vm->key) == KEYBOARD_SUCCESS ? CHIP8_SUCCESS : CHIP8_FAIL;
 }
 
-const uint8_t sprites[] = {
+int chip8_reset(chip8 *vm, keyboard *key, fb_console *display)
+{
+    *vm = (chip8){0};
+    vm->ram = vm->own_ram;
+    load_sprites(vm->ram);
+
+    return reset_machine(vm, key, display, CHIP8_MODE_CHIP8);
+}
+
+void chip8_init_image(uint8_t *image, enum chip8_mode mode, const uint8_t *rom, size_t rom_size)
+{
+    memset(image, 0, CHIP8_IMAGE_BYTES(mode));
+    load_sprites(image);
+    memcpy(image + PROGRAM_START_BYTES, rom, rom_size);
+}
+
+int chip8_reset_shared(chip8 *vm, keyboard *key, fb_console *display,
+                       const uint8_t *image, enum chip8_mode mode)
+{
+    chip8_release_ram(vm);
+
+    memset(vm, 0, CHIP8_COMPACT_BYTES);
+    vm->ram_image = image;
+    vm->ram = (uint8_t *)image;
+
+    return reset_machine(vm, key, display, mode);
+}
+
+int chip8_unshare_ram(chip8 *vm)
+{
+    if (!chip8_is_ram_shared(vm))
+        return CHIP8_SUCCESS;
+
+    size_t bytes = CHIP8_IMAGE_BYTES(vm->mode);
+    uint8_t *copy = malloc(bytes);
+    if (!copy) {
+        fprintf(stderr, "Malloc failure\n");
+        return CHIP8_FAIL;
+    }
+    memcpy(copy, vm->ram_image, bytes);
+    vm->ram = copy;
+
+    return CHIP8_SUCCESS;
+}
+
+void chip8_release_ram(chip8 *vm)
+{
+    if (!vm->ram_image || chip8_is_ram_shared(vm))
+        return;
+
+    free(vm->ram);
+    vm->ram = (uint8_t *)vm->ram_image;
+}
+
+static const uint8_t sprites[] = {
     0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
     0x20, 0x60, 0x20, 0x20, 0x70, // 1
     0xF0, 0x10, 0xF0, 0x80, 0xF0, // 2
@@ -45,21 +125,142 @@ const uint8_t sprites[] = {
     0xF0, 0x80, 0xF0, 0x80, 0x80, // F
 };
 
-static void load_sprites(chip8 *vm)
+static void load_sprites(uint8_t *ram)
+{
+    memcpy(&ram[0x00], &sprites[0], sizeof(sprites) / sizeof(sprites[0]));
+}
+
+void chip8_set_mode(chip8 *vm, enum chip8_mode mode)
 {
-    memcpy(&vm->ram[0x00], &sprites[0], sizeof(sprites) / sizeof(sprites[0]));
+    /* A shared image only has the memory of its own mode */
+    assert(!vm->ram_image || mode == vm->mode);
+    vm->mode = mode;
+    vm->ram_mask = mode_ram_mask(mode);
 }
 
 uint16_t chip8_fetch(chip8 *vm)
 {
     /* big-endian (MSB first) */
 
-    uint16_t instruction = vm->ram[vm->PC] << 8;
-    instruction |= vm->ram[vm->PC + 1];
+    uint16_t instruction = vm->ram[vm->PC & vm->ram_mask] << 8;
+    instruction |= vm->ram[(vm->PC + 1) & vm->ram_mask];
     return instruction;
 }
 
-void chip8_exec(chip8 *vm, uint16_t instruction)
+void chip8_set_timing(chip8 *vm, enum chip8_timing timing)
+{
+    vm->timing = timing;
+    vm->cycles_left = 0;
+}
+
+void chip8_set_speed(chip8 *vm, uint32_t frequency)
+{
+    assert(frequency >= FREQUENCY_TIMER);
+    vm->usec_per_cpu_step = USECONDS_PER_SECOND / frequency;
+}
+
+void chip8_set_audio(chip8 *vm, audio *sound)
+{
+    vm->sound = sound;
+}
+
+void chip8_set_profile(chip8 *vm, profile *prof)
+{
+    vm->prof = prof;
+}
+
+void chip8_set_latency(chip8 *vm, latency *lat)
+{
+    vm->lat = lat;
+}
+
+/* The first look at a key since it changed */
+static inline void observe_key(chip8 *vm, uint8_t key)
+{
+    uint64_t usec_input;
+    if (vm->lat && key < CHIP8_KEY_COUNT && keyboard_take_input_time(vm->key, key, &usec_input))
+        latency_observed(vm->lat, usec_input, latency_usec_now());
+}
+
+static inline void observe_display_change(chip8 *vm)
+{
+    if (latency_is_awaiting_draw(vm->lat))
+        latency_drawn(vm->lat, latency_usec_now());
+}
+
+static void push_tone_edge(chip8 *vm)
+{
+    if (vm->sound)
+        audio_push_edge(vm->sound, vm->usec_elapsed, vm->is_tone_on, vm->pitch, vm->audio_pattern);
+}
+
+/* The tone is on while ST is non-zero, report edges only */
+static inline void update_tone(chip8 *vm)
+{
+    bool is_on = vm->ST != 0;
+    if (is_on == vm->is_tone_on)
+        return;
+
+    vm->is_tone_on = is_on;
+    push_tone_edge(vm);
+}
+
+/* Skip the next instruction, XO-CHIP's F000 NNNN being 4 bytes long */
+static inline void skip_next(chip8 *vm)
+{
+    vm->PC += 2;
+
+    if (vm->mode == CHIP8_MODE_XOCHIP &&
+        vm->ram[vm->PC & vm->ram_mask] == 0xF0 && vm->ram[(vm->PC + 1) & vm->ram_mask] == 0x00)
+        vm->PC += 2;
+}
+
+static uint32_t ram_size(const chip8 *vm)
+{
+    return vm->mode == CHIP8_MODE_XOCHIP ? XOCHIP_MEMORY_SIZE_BYTES : MEMORY_SIZE_BYTES;
+}
+
+static int fault(chip8 *vm, enum chip8_fault_kind kind, uint16_t instruction, uint32_t address)
+{
+    vm->fault = (chip8_fault) {
+        .kind = kind,
+        .pc = vm->PC,
+        .instruction = instruction,
+        .address = address,
+    };
+    return CHIP8_FAULT;
+}
+
+/* Checked instances fault on accesses past the end of the mode's memory,
+ * unchecked ones wrap addresses around and rely on the RAM guard for the
+ * rest of a sprite */
+#define CHECK_RAM(addr, bytes)                                          \
+    do {                                                                \
+        if (checked && (uint32_t)(addr) + (bytes) > ram_size(vm))       \
+            return fault(vm, CHIP8_FAULT_RAM, instruction, (addr));     \
+    } while (0)
+
+/* Keys are a nibble: unchecked instances ignore the rest of Vx, checked ones
+ * fault on keys that don't exist */
+#define KEY_INDEX_MASK (CHIP8_KEY_COUNT - 1)
+#define CHECK_KEY(key)                                                  \
+    do {                                                                \
+        if (checked && (key) >= CHIP8_KEY_COUNT)                        \
+            return fault(vm, CHIP8_FAULT_KEY, instruction, (key));      \
+    } while (0)
+
+/* Shared memory is copied before the first write to it */
+#define UNSHARE_RAM()                                                   \
+    do {                                                                \
+        if (chip8_is_ram_shared(vm) && chip8_unshare_ram(vm) != CHIP8_SUCCESS) \
+            return CHIP8_FAIL;                                          \
+    } while (0)
+
+/* The interpreter, instantiated once per quirk combination and checking mode
+ * below. With both being constants every quirk check is resolved and checks
+ * are gone from unchecked instances at compile time. */
+static inline __attribute__((always_inline))
+int exec(chip8 *vm, uint16_t instruction, const uint32_t quirks, const bool checked)
 {
     uint16_t type = (0xF000 & instruction) >> 12;
     uint16_t x = (0x0F00 & instruction) >> 8;
@@ -69,6 +270,11 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
     uint16_t n = (0x000F & instruction);
 
     bool do_step = true;
+    int status = CHIP8_SUCCESS;
+
+    CHECK_RAM(vm->PC, 2);
+
+    profile_instruction(vm->prof, vm->PC, instruction, vm->mode);
 
     switch (type) {
     case 0x0:{
@@ -80,6 +286,18 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
             fprintf(stderr, "CLS\n");
 #endif
             fb_clear(vm->display);
+            observe_display_change(vm);
+            break;
+        }
+        case 0x230:{
+            /* 0230 - CLS in hires, SYS otherwise */
+#ifdef DEBUG_TRACE
+            fprintf(stderr, "CLS (hires)\n");
+#endif
+            if (vm->display->height == FRAMEBUF_HIRES_HEIGHT) {
+                fb_clear(vm->display);
+                observe_display_change(vm);
+            }
             break;
         }
         case 0x0ee:{
@@ -89,7 +307,10 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
             fprintf(stderr, "RET\n");
 #endif
 
-            vm->SP--;
+            if (checked && vm->SP == 0)
+                return fault(vm, CHIP8_FAULT_STACK_UNDERFLOW, instruction, vm->SP);
+
+            vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
             vm->PC = vm->stack[vm->SP];
             do_step = false;
             break;
@@ -113,6 +334,16 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
         fprintf(stderr, "JP 0x%.3X\n", nnn);
 #endif
 
+        if (instruction == HIRES_ENTRY_INSTRUCTION && vm->PC == PROGRAM_START_BYTES &&
+            vm->mode == CHIP8_MODE_CHIP8) {
+            fb_set_hires(vm->display, true);
+            nnn = HIRES_START_BYTES;
+        }
+
+        /* Jumping to itself is how programs stop, nothing but the timers
+         * can change from there on */
+        if (nnn == vm->PC)
+            status = CHIP8_HALT;
         vm->PC = nnn;
         do_step = false;
         break;
@@ -124,8 +355,12 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
         fprintf(stderr, "CALL %.3X\n", nnn);
 #endif
 
-        vm->stack[vm->SP] = vm->PC + 2;
-        vm->SP++;
+        if (checked && vm->SP >= MAX_STACK_DEPTH)
+            return fault(vm, CHIP8_FAULT_STACK_OVERFLOW, instruction, vm->SP);
+
+        /* Checked instances count up to a full stack, the next CALL faults */
+        vm->stack[vm->SP & STACK_INDEX_MASK] = vm->PC + 2;
+        vm->SP = checked ? vm->SP + 1 : (vm->SP + 1) & STACK_INDEX_MASK;
         vm->PC = nnn;
         do_step = false;
         break;
@@ -138,7 +373,7 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
 #endif
 
         if (vm->regs[x] == kk) {
-            vm->PC += 2;
+            skip_next(vm);
         }
         break;
     }
@@ -150,11 +385,45 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
 #endif
 
         if (vm->regs[x] != kk) {
-            vm->PC += 2;
+            skip_next(vm);
         }
         break;
     }
     case 0x5:{
+        if (vm->mode == CHIP8_MODE_XOCHIP && n == 0x2) {
+            /* 0x5xy2 - LD [I], Vx-Vy (XO-CHIP) */
+            /* Save registers Vx up to Vy (or down to, if y < x) into memory
+             * starting with addr I, I is left unchanged */
+#ifdef DEBUG_TRACE
+            fprintf(stderr, "LD [I], V%.1X-V%.1X\n", x, y);
+#endif
+
+            uint8_t count = (x <= y ? y - x : x - y) + 1;
+            CHECK_RAM(vm->I, count);
+            UNSHARE_RAM();
+
+            for (uint8_t i = 0; i < count; ++i)
+                vm->ram[(vm->I + i) & vm->ram_mask] = vm->regs[x <= y ? x + i : x - i];
+            profile_ram_write(vm->prof, vm->I, count);
+            break;
+        }
+        if (vm->mode == CHIP8_MODE_XOCHIP && n == 0x3) {
+            /* 0x5xy3 - LD Vx-Vy, [I] (XO-CHIP) */
+            /* Load registers Vx up to Vy (or down to, if y < x) from memory
+             * starting with addr I, I is left unchanged */
+#ifdef DEBUG_TRACE
+            fprintf(stderr, "LD V%.1X-V%.1X, [I]\n", x, y);
+#endif
+
+            uint8_t count = (x <= y ? y - x : x - y) + 1;
+            CHECK_RAM(vm->I, count);
+
+            for (uint8_t i = 0; i < count; ++i)
+                vm->regs[x <= y ? x + i : x - i] = vm->ram[(vm->I + i) & vm->ram_mask];
+            profile_ram_read(vm->prof, vm->I, count);
+            break;
+        }
+
         /* 0x5xy0 - SE Vx, Vy */
         /* Compare value in Vx with value in Vy, skip instr if equal */
 #ifdef DEBUG_TRACE
@@ -162,7 +431,7 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
 #endif
 
         if (vm->regs[x] == vm->regs[y]) {
-            vm->PC += 2;
+            skip_next(vm);
         }
         break;
     }
@@ -207,6 +476,8 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
 #endif
 
             vm->regs[x] |= vm->regs[y];
+            if (quirks & CHIP8_QUIRK_VF_RESET)
+                vm->regs[Vf] = 0;
             break;
         }
         case 0x2:{
@@ -217,6 +488,8 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
 #endif
 
             vm->regs[x] &= vm->regs[y];
+            if (quirks & CHIP8_QUIRK_VF_RESET)
+                vm->regs[Vf] = 0;
             break;
         }
         case 0x3:{
@@ -227,6 +500,8 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
 #endif
 
             vm->regs[x] ^= vm->regs[y];
+            if (quirks & CHIP8_QUIRK_VF_RESET)
+                vm->regs[Vf] = 0;
             break;
         }
         case 0x4:{
@@ -261,6 +536,8 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
             fprintf(stderr, "SHR\n");
 #endif
 
+            if (quirks & CHIP8_QUIRK_SHIFT_VY)
+                vm->regs[x] = vm->regs[y];
             vm->regs[Vf] = vm->regs[x] & 0x1;
             vm->regs[x] >>= 1;
             break;
@@ -285,13 +562,14 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
             fprintf(stderr, "SHL\n");
 #endif
 
+            if (quirks & CHIP8_QUIRK_SHIFT_VY)
+                vm->regs[x] = vm->regs[y];
             vm->regs[Vf] = !!(vm->regs[x] & (0x1 << 7));
             vm->regs[x] <<= 1;
             break;
         }
         default:{
-            fprintf(stderr, "Unknown inner instruction: 0x%04x\n", instruction);
-            exit(EXIT_FAILURE);
+            return fault(vm, CHIP8_FAULT_ILLEGAL_INSTRUCTION, instruction, vm->PC);
         }
         }
         break;
@@ -304,7 +582,7 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
 #endif
 
         if (vm->regs[x] != vm->regs[y])
-            vm->PC += 2;
+            skip_next(vm);
         break;
     }
     case 0xa:{
@@ -324,7 +602,8 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
         fprintf(stderr, "JP V0, %.3X\n", nnn);
 #endif
 
-        vm->PC = vm->regs[V0] + nnn;
+        /* 0xbxnn - JP Vx, xnn with the jump quirk */
+        vm->PC = vm->regs[(quirks & CHIP8_QUIRK_JUMP_VX) ? x : V0] + nnn;
         do_step = false;
         break;
     }
@@ -335,16 +614,36 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
         fprintf(stderr, "RND\n");
 #endif
 
-        vm->regs[x] = (rand() % 256) & kk;
+        vm->regs[x] = chip8_random(vm) & kk;
         break;
     }
     case 0xd:{
         /* 0xdxyn - DRW Vx, Vy, nibble */
         /* Display n-byte sprite starting at memory I to location Vx, Vy, while
          * also setting VF to collision check result */
+        /* XO-CHIP draws a 16x16 sprite when n is 0 */
         bool is_pixel_erased = false;
-        fb_draw_sprite(vm->display, &vm->ram[vm->I], n, vm->regs[x], vm->regs[y], &is_pixel_erased);
+        uint16_t sprite_bytes = (vm->mode == CHIP8_MODE_XOCHIP && n == 0) ? 32 : n;
+        CHECK_RAM(vm->I, sprite_bytes * __builtin_popcount(vm->display->planes));
+
+        uint8_t *sprite = &vm->ram[vm->I & vm->ram_mask];
+        if (vm->mode == CHIP8_MODE_XOCHIP && n == 0) {
+            if (quirks & CHIP8_QUIRK_CLIP)
+                fb_draw_sprite16_clipped(vm->display, sprite, vm->regs[x], vm->regs[y], &is_pixel_erased);
+            else
+                fb_draw_sprite16(vm->display, sprite, vm->regs[x], vm->regs[y], &is_pixel_erased);
+        } else {
+            if (quirks & CHIP8_QUIRK_CLIP)
+                fb_draw_sprite_clipped(vm->display, sprite, n, vm->regs[x], vm->regs[y], &is_pixel_erased);
+            else
+                fb_draw_sprite(vm->display, sprite, n, vm->regs[x], vm->regs[y], &is_pixel_erased);
+        }
         vm->regs[Vf] = is_pixel_erased;
+        observe_display_change(vm);
+
+        if (vm->prof) {
+            profile_draw(vm->prof, vm->I, sprite_bytes * __builtin_popcount(vm->display->planes));
+        }
 
 #ifdef DEBUG_TRACE
         fprintf(stderr, "DRW V%.1X, V%.1X, %u (%u %u %u)\n",
@@ -361,10 +660,15 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
             fprintf(stderr, "SKP\n");
 #endif
 
+            CHECK_KEY(vm->regs[x]);
+
+            uint8_t key = vm->regs[x] & KEY_INDEX_MASK;
             bool is_pressed = false;
-            keyboard_is_key_pressed(vm->key, vm->regs[x] , &is_pressed);
+            if (keyboard_is_key_pressed(vm->key, key, &is_pressed) != KEYBOARD_SUCCESS)
+                return CHIP8_FAIL;
+            observe_key(vm, key);
             if (is_pressed)
-                vm->PC += 2;
+                skip_next(vm);
             break;
         }
         case 0xa1:{
@@ -374,19 +678,75 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
             fprintf(stderr, "SKNP\n");
 #endif
 
+            CHECK_KEY(vm->regs[x]);
+
+            uint8_t key = vm->regs[x] & KEY_INDEX_MASK;
             bool is_pressed = false;
-            keyboard_is_key_pressed(vm->key, vm->regs[x] , &is_pressed);
+            if (keyboard_is_key_pressed(vm->key, key, &is_pressed) != KEYBOARD_SUCCESS)
+                return CHIP8_FAIL;
+            observe_key(vm, key);
             if (!is_pressed)
-                vm->PC += 2;
+                skip_next(vm);
             break;
         }
         default:
-            fprintf(stderr, "Unknown inner instruction: 0x%04x\n", instruction);
-            exit(EXIT_FAILURE);
+            return fault(vm, CHIP8_FAULT_ILLEGAL_INSTRUCTION, instruction, vm->PC);
         }
         break;
     }
     case 0xf:{
+        if (vm->mode == CHIP8_MODE_XOCHIP) {
+            if (instruction == 0xf000) {
+                /* 0xf000 nnnn - LD I, nnnn (XO-CHIP) */
+                /* Load the 16-bit addr following the instruction into I */
+                CHECK_RAM(vm->PC + 2, 2);
+                vm->I = (vm->ram[(vm->PC + 2) & vm->ram_mask] << 8) |
+                    vm->ram[(vm->PC + 3) & vm->ram_mask];
+#ifdef DEBUG_TRACE
+                fprintf(stderr, "LD I, 0x%.4X\n", vm->I);
+#endif
+                vm->PC += 2;
+                break;
+            }
+            if (kk == 0x01) {
+                /* 0xfn01 - PLANE n (XO-CHIP) */
+                /* Select bitplanes affected by drawing and clearing */
+#ifdef DEBUG_TRACE
+                fprintf(stderr, "PLANE %.1X\n", x);
+#endif
+
+                fb_select_planes(vm->display, x);
+                break;
+            }
+            if (instruction == 0xf002) {
+                /* 0xf002 - AUDIO (XO-CHIP) */
+                /* Load the 16-byte audio pattern buffer from addr I */
+#ifdef DEBUG_TRACE
+                fprintf(stderr, "AUDIO\n");
+#endif
+
+                CHECK_RAM(vm->I, AUDIO_PATTERN_BYTES);
+                for (uint8_t i = 0; i < AUDIO_PATTERN_BYTES; ++i)
+                    vm->audio_pattern[i] = vm->ram[(vm->I + i) & vm->ram_mask];
+                profile_ram_read(vm->prof, vm->I, AUDIO_PATTERN_BYTES);
+                if (vm->is_tone_on)
+                    push_tone_edge(vm);
+                break;
+            }
+            if (kk == 0x3a) {
+                /* 0xfx3a - PITCH Vx (XO-CHIP) */
+                /* Set audio pattern playback pitch to Vx */
+#ifdef DEBUG_TRACE
+                fprintf(stderr, "PITCH V%.1X\n", x);
+#endif
+
+                vm->pitch = vm->regs[x];
+                if (vm->is_tone_on)
+                    push_tone_edge(vm);
+                break;
+            }
+        }
+
         switch (kk) {
         case 0x07:{
             /* 0xfx07 - LD Vx, DT */
@@ -404,7 +764,15 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
 
             int key_pressed = 0x0;
             int rc = keyboard_wait_for_key(vm->key, &key_pressed);
+            if (rc == KEYBOARD_NO_KEY) {
+                /* Virtual keyboards don't block, retry on the next step */
+                do_step = false;
+                break;
+            }
+            if (rc < 0)
+                return CHIP8_FAIL;
             vm->regs[x] = key_pressed;
+            observe_key(vm, key_pressed);
 #ifdef DEBUG_TRACE
             fprintf(stderr, "LD V%.1X, K\n", x);
             fprintf(stderr, "Pressed key %.1X (rc=%d)\n", key_pressed, rc);
@@ -429,6 +797,7 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
 #endif
 
             vm->ST = vm->regs[x];
+            update_tone(vm);
             break;
         }
         case 0x1e:{
@@ -448,9 +817,8 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
             fprintf(stderr, "LD\n");
 #endif
 
-            assert(vm->regs[x] < 16);
-
-            vm->I = vm->regs[x] * 5;
+            /* There are only 16 digits */
+            vm->I = (vm->regs[x] & 0xF) * 5;
             break;
         }
         case 0x33:{
@@ -460,12 +828,16 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
             fprintf(stderr, "LD\n");
 #endif
 
+            CHECK_RAM(vm->I, 3);
+            UNSHARE_RAM();
+
             uint8_t reg_val = vm->regs[x];
-            vm->ram[vm->I] = reg_val / 100;
+            vm->ram[vm->I & vm->ram_mask] = reg_val / 100;
             reg_val %= 100;
-            vm->ram[vm->I + 1] = reg_val / 10;
+            vm->ram[(vm->I + 1) & vm->ram_mask] = reg_val / 10;
             reg_val %= 10;
-            vm->ram[vm->I + 2] = reg_val;
+            vm->ram[(vm->I + 2) & vm->ram_mask] = reg_val;
+            profile_ram_write(vm->prof, vm->I, 3);
             break;
         }
         case 0x55:{
@@ -475,8 +847,14 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
             fprintf(stderr, "LD\n");
 #endif
 
+            CHECK_RAM(vm->I, x + 1);
+            UNSHARE_RAM();
+
             for (uint8_t i = 0; i <= x; ++i)
-                vm->ram[vm->I + i] = vm->regs[i];
+                vm->ram[(vm->I + i) & vm->ram_mask] = vm->regs[i];
+            profile_ram_write(vm->prof, vm->I, x + 1);
+            if (quirks & CHIP8_QUIRK_MEMORY_INCREMENT_I)
+                vm->I += x + 1;
             break;
         }
         case 0x65:{
@@ -486,75 +864,161 @@ void chip8_exec(chip8 *vm, uint16_t instruction)
             fprintf(stderr, "LD\n");
 #endif
 
+            CHECK_RAM(vm->I, x + 1);
+
             for (uint8_t i = 0; i <= x; ++i)
-                vm->regs[i] = vm->ram[vm->I + i];
+                vm->regs[i] = vm->ram[(vm->I + i) & vm->ram_mask];
+            profile_ram_read(vm->prof, vm->I, x + 1);
+            if (quirks & CHIP8_QUIRK_MEMORY_INCREMENT_I)
+                vm->I += x + 1;
             break;
         }
         default:{
-            fprintf(stderr, "Unknown inner instruction: 0x%04x\n", instruction);
-            exit(EXIT_FAILURE);
+            return fault(vm, CHIP8_FAULT_ILLEGAL_INSTRUCTION, instruction, vm->PC);
         }
 
         }
         break;
     }
     default:{
-        fprintf(stderr, "Unknown instruction: 0x%04x\n", instruction);
-        exit(EXIT_FAILURE);
+        return fault(vm, CHIP8_FAULT_ILLEGAL_INSTRUCTION, instruction, vm->PC);
     }
     }
 
     if (do_step)
         vm->PC += 2;
+
+    return status;
+}
+
+#undef CHECK_RAM
+
+#define QUIRK_COMBINATIONS(X)                                   \
+    X(0)  X(1)  X(2)  X(3)  X(4)  X(5)  X(6)  X(7)              \
+    X(8)  X(9)  X(10) X(11) X(12) X(13) X(14) X(15)             \
+    X(16) X(17) X(18) X(19) X(20) X(21) X(22) X(23)             \
+    X(24) X(25) X(26) X(27) X(28) X(29) X(30) X(31)
+
+static_assert(CHIP8_QUIRK_MASK == 31, "QUIRK_COMBINATIONS is out of date");
+
+#define EXEC_INSTANCE(quirks)                                           \
+    static int exec_##quirks(chip8 *vm, uint16_t instruction)           \
+    {                                                                   \
+        return exec(vm, instruction, quirks, false);                    \
+    }                                                                   \
+    static int exec_checked_##quirks(chip8 *vm, uint16_t instruction)   \
+    {                                                                   \
+        return exec(vm, instruction, quirks, true);                     \
+    }
+QUIRK_COMBINATIONS(EXEC_INSTANCE)
+#undef EXEC_INSTANCE
+
+#define EXEC_ENTRY(quirks) exec_##quirks,
+#define EXEC_CHECKED_ENTRY(quirks) exec_checked_##quirks,
+static const chip8_exec_fn exec_instances[2][CHIP8_QUIRK_MASK + 1] = {
+    { QUIRK_COMBINATIONS(EXEC_ENTRY) },
+    { QUIRK_COMBINATIONS(EXEC_CHECKED_ENTRY) },
+};
+#undef EXEC_ENTRY
+#undef EXEC_CHECKED_ENTRY
+
+void chip8_set_quirks(chip8 *vm, uint32_t quirks)
+{
+    assert(!(quirks & ~CHIP8_QUIRK_MASK));
+    vm->quirks = quirks;
+    vm->exec = exec_instances[vm->is_checked][quirks];
+}
+
+const char *chip8_fault_name(enum chip8_fault_kind kind)
+{
+    switch (kind) {
+    case CHIP8_FAULT_NONE: return "no fault";
+    case CHIP8_FAULT_RAM: return "RAM access out of range";
+    case CHIP8_FAULT_STACK_OVERFLOW: return "stack overflow";
+    case CHIP8_FAULT_STACK_UNDERFLOW: return "stack underflow";
+    case CHIP8_FAULT_ILLEGAL_INSTRUCTION: return "illegal instruction";
+    case CHIP8_FAULT_KEY: return "key out of range";
+    }
+    return "unknown fault";
+}
+
+void chip8_set_seed(chip8 *vm, uint32_t seed)
+{
+    /* xorshift state can't be 0 */
+    vm->rng_state = seed ? seed : 0x9e3779b9;
+}
+
+void chip8_set_checked(chip8 *vm, bool is_checked)
+{
+    vm->is_checked = is_checked;
+    vm->exec = exec_instances[vm->is_checked][vm->quirks];
+}
+
+int chip8_exec(chip8 *vm, uint16_t instruction)
+{
+    return vm->exec(vm, instruction);
+}
+
+int chip8_exec_generic(chip8 *vm, uint16_t instruction)
+{
+    return exec(vm, instruction, vm->quirks, vm->is_checked);
 }
 
 
-void chip8_redraw(chip8 *vm)
+int chip8_redraw(chip8 *vm)
 {
     bool keyboard_state[CHIP8_KEY_COUNT] = {0};
 
     int rc = keyboard_get_key_state(vm->key, keyboard_state);
-    if (rc != KEYBOARD_SUCCESS) {
-        fprintf(stderr, "keyboard failure\n");
-        exit(EXIT_FAILURE);
-    }
+    if (rc != KEYBOARD_SUCCESS)
+        return CHIP8_FAIL;
 
-    fb_redraw(vm->display, keyboard_state);
+    /* Written out, as far as we can tell */
+    if (fb_redraw(vm->display, keyboard_state) && latency_is_awaiting_show(vm->lat))
+        latency_shown(vm->lat, latency_usec_now());
+    return CHIP8_SUCCESS;
 }
 
-void chip8_cpu_tick(chip8 *vm)
+int chip8_cpu_tick(chip8 *vm)
 {
     int rc = keyboard_flush(vm->key);
-    if (rc != KEYBOARD_SUCCESS) {
-        fprintf(stderr, "keyboard failure\n");
-        exit(EXIT_FAILURE);
-    }
+    if (rc != KEYBOARD_SUCCESS)
+        return CHIP8_FAIL;
 
     if (vm->usec_to_cpu_tick)
-        return;
+        return CHIP8_SUCCESS;
 
     uint16_t instruction = chip8_fetch(vm);
 #ifdef DEBUG_TRACE
     fprintf(stderr, "PC: %.3X\n", vm->PC);
 #endif
-    chip8_exec(vm, instruction);
+    rc = chip8_exec(vm, instruction);
+    if (rc == CHIP8_FAULT)
+        return rc;
 
-    vm->usec_to_cpu_tick += USECONDS_PER_STEP_CPU;
+    vm->usec_to_cpu_tick += vm->usec_per_cpu_step;
+    return rc;
 }
 
-void chip8_timers_tick(chip8 *vm)
+static void timers_step(chip8 *vm)
 {
-    /* some time left until the next tick? */
-    if (vm->usec_to_timer_tick)
-        return;
-
     if (vm->DT) {
         vm->DT -= 1;
     }
 
     if (vm->ST) {
         vm->ST -= 1;
+        update_tone(vm);
     }
+}
+
+void chip8_timers_tick(chip8 *vm)
+{
+    /* some time left until the next tick? */
+    if (vm->usec_to_timer_tick)
+        return;
+
+    timers_step(vm);
 
     vm->usec_to_timer_tick += USECONDS_PER_STEP_TIMER;
 }
@@ -564,5 +1028,154 @@ uint32_t chip8_tick(chip8 *vm)
     uint32_t usec_to_next = MIN(vm->usec_to_cpu_tick, vm->usec_to_timer_tick);
     vm->usec_to_cpu_tick -= usec_to_next;
     vm->usec_to_timer_tick -= usec_to_next;
+
+    vm->usec_elapsed += usec_to_next;
+    if (vm->sound)
+        audio_set_clock(vm->sound, vm->usec_elapsed);
+
     return usec_to_next;
 }
+
+static int32_t frame_budget(chip8 *vm)
+{
+    return vm->timing == CHIP8_TIMING_VIP ? VIP_CYCLES_FRAME_BUDGET : USECONDS_PER_STEP_TIMER;
+}
+
+int chip8_frame_begin(chip8 *vm)
+{
+    int rc = keyboard_flush(vm->key);
+    if (rc != KEYBOARD_SUCCESS)
+        return CHIP8_FAIL;
+
+    timers_step(vm);
+
+    vm->usec_frame_start = vm->usec_elapsed;
+    vm->cycles_left += frame_budget(vm);
+    return CHIP8_SUCCESS;
+}
+
+/* A halted machine would repeat the same jump until the end of the frame,
+ * charge for all of that at once */
+static void skip_halted(chip8 *vm, uint32_t cost)
+{
+    if (vm->cycles_left > 0)
+        vm->cycles_left -= (vm->cycles_left + cost - 1) / cost * cost;
+}
+
+int chip8_frame_step(chip8 *vm)
+{
+    int32_t budget = frame_budget(vm);
+    uint16_t instruction = chip8_fetch(vm);
+#ifdef DEBUG_TRACE
+    fprintf(stderr, "PC: %.3X\n", vm->PC);
+#endif
+
+    /* Spread emulated time over the frame so that audio edges land where
+     * they belong */
+    vm->usec_elapsed = vm->usec_frame_start +
+        (uint64_t)(budget - vm->cycles_left) * USECONDS_PER_STEP_TIMER / budget;
+
+    uint32_t cost = vm->timing == CHIP8_TIMING_VIP ?
+        vip_timing_cycles(vm, instruction) : vm->usec_per_cpu_step;
+
+    int rc = vm->exec(vm, instruction);
+    if (rc == CHIP8_FAULT)
+        return rc;
+    vm->cycles_left -= cost;
+
+    if (rc == CHIP8_HALT)
+        skip_halted(vm, cost);
+
+    /* DRW waits for the display interrupt */
+    if (vm->timing == CHIP8_TIMING_VIP && (instruction & 0xF000) == 0xD000 && vm->cycles_left > 0)
+        vm->cycles_left = 0;
+
+    return rc;
+}
+
+void chip8_frame_end(chip8 *vm)
+{
+    vm->usec_elapsed = vm->usec_frame_start + USECONDS_PER_STEP_TIMER;
+    if (vm->sound)
+        audio_set_clock(vm->sound, vm->usec_elapsed);
+}
+
+size_t chip8_state_size(const chip8 *vm)
+{
+    return CHIP8_COMPACT_BYTES + sizeof(fb_console) + ram_size(vm);
+}
+
+void chip8_save_state(const chip8 *vm, uint8_t *state)
+{
+    memcpy(state, vm, CHIP8_COMPACT_BYTES);
+    state += CHIP8_COMPACT_BYTES;
+    memcpy(state, vm->display, sizeof(fb_console));
+    state += sizeof(fb_console);
+    memcpy(state, vm->ram, ram_size(vm));
+}
+
+static int load_state(chip8 *vm, const uint8_t *state, bool is_resharing)
+{
+    const uint8_t *saved_ram = state + CHIP8_COMPACT_BYTES + sizeof(fb_console);
+
+    /* Back on the image if memory is what it was, a private copy otherwise */
+    if (is_resharing && vm->ram_image && !memcmp(saved_ram, vm->ram_image, ram_size(vm))) {
+        chip8_release_ram(vm);
+    } else {
+        if (chip8_unshare_ram(vm) != CHIP8_SUCCESS)
+            return CHIP8_FAIL;
+        memcpy(vm->ram, saved_ram, ram_size(vm));
+    }
+
+    chip8 attached;
+    memcpy(&attached, vm, CHIP8_COMPACT_BYTES);
+
+    memcpy(vm, state, CHIP8_COMPACT_BYTES);
+    fb_load(vm->display, state + CHIP8_COMPACT_BYTES);
+
+    /* The state is the machine, not how it's run and hooked up */
+    vm->ram = attached.ram;
+    vm->ram_image = attached.ram_image;
+    assert(!vm->ram_image || vm->mode == attached.mode);
+    vm->display = attached.display;
+    vm->key = attached.key;
+    vm->sound = attached.sound;
+    vm->prof = attached.prof;
+    vm->lat = attached.lat;
+    vm->exec = attached.exec;
+    vm->quirks = attached.quirks;
+    vm->is_checked = attached.is_checked;
+    vm->timing = attached.timing;
+    vm->usec_per_cpu_step = attached.usec_per_cpu_step;
+
+    /* Emulated time timestamps audio, it only goes forward */
+    vm->usec_elapsed = attached.usec_elapsed;
+    vm->usec_frame_start = attached.usec_frame_start;
+    if (vm->is_tone_on != attached.is_tone_on)
+        push_tone_edge(vm);
+
+    return CHIP8_SUCCESS;
+}
+
+int chip8_load_state(chip8 *vm, const uint8_t *state)
+{
+    return load_state(vm, state, true);
+}
+
+int chip8_load_state_private(chip8 *vm, const uint8_t *state)
+{
+    return load_state(vm, state, false);
+}
+
+int chip8_run_frame(chip8 *vm)
+{
+    int rc = chip8_frame_begin(vm);
+    if (rc != CHIP8_SUCCESS)
+        return rc;
+
+    while (vm->cycles_left > 0 && rc == CHIP8_SUCCESS)
+        rc = chip8_frame_step(vm);
+    chip8_frame_end(vm);
+
+    return rc;
+}
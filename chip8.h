@@ -3,16 +3,38 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <assert.h>
 
 #include "common.h"
 #include "keyboard.h"
 #include "fb-console.h"
+#include "audio.h"
+
+typedef struct profile profile;
+typedef struct latency latency;
 
 #define MEMORY_SIZE_BYTES (1 << 12) /* 4K */
+#define XOCHIP_MEMORY_SIZE_BYTES (1 << 16) /* 64K */
 #define PROGRAM_START_BYTES (0x200)   /* 512 */
 #define MAX_ROM_SIZE_BYTES (MEMORY_SIZE_BYTES - PROGRAM_START_BYTES)
+#define XOCHIP_MAX_ROM_SIZE_BYTES (XOCHIP_MEMORY_SIZE_BYTES - PROGRAM_START_BYTES)
+
+/* COSMAC VIP two-page hires programs jump over the interpreter extension they
+ * carry at the start, the extension is emulated instead: 64x64 pixels and a
+ * clear screen of its own */
+#define HIRES_ENTRY_INSTRUCTION 0x1260
+#define HIRES_START_BYTES (0x2C0)
+#define HIRES_CLS_INSTRUCTION 0x0230
 #define MAX_STACK_DEPTH 16
+#define STACK_INDEX_MASK (MAX_STACK_DEPTH - 1)
+static_assert((MAX_STACK_DEPTH & STACK_INDEX_MASK) == 0,
+              "Stack depth is expected to be a power of 2 for index masking");
+
+/* Slack after the memory of a mode so that unchecked accesses, wrapped around
+ * within it, stay within the array: the longest is a 16x16 sprite on both
+ * planes */
+#define RAM_GUARD_BYTES 64
 
 #define FREQUENCY_CPU 500      /* Hz */
 #define FREQUENCY_TIMER 60     /* Hz */
@@ -26,50 +48,286 @@ static_assert(FREQUENCY_CPU > FREQUENCY_TIMER,
 enum {
     V0, V1,V2, V3, V4, V5, V6, V7, V8, V9, Va, Vb, Vc, Vd, Ve,
     Vf
-} reg_names;
+};
 
-typedef struct chip8 {
-    /* Microseconds left to next CPU/DT/ST ticks */
-    uint32_t usec_to_cpu_tick;
-    uint32_t usec_to_timer_tick;
+enum chip8_mode {
+    CHIP8_MODE_CHIP8,
+    CHIP8_MODE_XOCHIP,
+};
+
+enum chip8_timing {
+    /* Every instruction takes usec_per_cpu_step, USECONDS_PER_STEP_CPU by
+     * default */
+    CHIP8_TIMING_FIXED,
+    /* Per-instruction COSMAC VIP machine cycles, see vip-timing.h */
+    CHIP8_TIMING_VIP,
+};
+
+/* Behaviours differing between interpreters, none set is this emulator's
+ * traditional behaviour */
+enum chip8_quirk {
+    /* 8XY6/8XYE shift Vy into Vx, not Vx in place (COSMAC VIP) */
+    CHIP8_QUIRK_SHIFT_VY = 1 << 0,
+    /* FX55/FX65 leave I incremented past the last register (COSMAC VIP) */
+    CHIP8_QUIRK_MEMORY_INCREMENT_I = 1 << 1,
+    /* 8XY1/8XY2/8XY3 reset VF (COSMAC VIP) */
+    CHIP8_QUIRK_VF_RESET = 1 << 2,
+    /* Sprites are clipped at the screen edges instead of wrapping around */
+    CHIP8_QUIRK_CLIP = 1 << 3,
+    /* BNNN jumps to VX + NNN, X being the top nibble of NNN (SUPER-CHIP) */
+    CHIP8_QUIRK_JUMP_VX = 1 << 4,
+};
+
+#define CHIP8_QUIRK_COUNT 5
+#define CHIP8_QUIRK_MASK ((1u << CHIP8_QUIRK_COUNT) - 1)
+
+enum chip8_status {
+    CHIP8_SUCCESS,
+    /* Guest fault in checked mode, see chip8.fault */
+    CHIP8_FAULT,
+    /* The program jumped to itself and is waiting for the timers only */
+    CHIP8_HALT,
+    /* Host side failure, e.g. the keyboard went away */
+    CHIP8_FAIL,
+};
+
+enum chip8_fault_kind {
+    CHIP8_FAULT_NONE,
+    /* Access past the end of memory, fetches included */
+    CHIP8_FAULT_RAM,
+    /* CALL with a full stack */
+    CHIP8_FAULT_STACK_OVERFLOW,
+    /* RET with an empty stack */
+    CHIP8_FAULT_STACK_UNDERFLOW,
+    /* Not an instruction in the current mode, reported in both modes */
+    CHIP8_FAULT_ILLEGAL_INSTRUCTION,
+    /* SKP/SKNP on a key past F, the address being the key */
+    CHIP8_FAULT_KEY,
+};
+
+typedef struct chip8_fault {
+    uint8_t kind;               /* enum chip8_fault_kind */
+    uint16_t pc;
+    uint16_t instruction;
+    /* First byte of the faulting access, SP for stack faults */
+    uint32_t address;
+} chip8_fault;
+
+typedef struct chip8 chip8;
+
+/* Interpreter specialized for a quirk combination and checking mode */
+typedef int (*chip8_exec_fn)(chip8 *vm, uint16_t instruction);
+
+struct chip8 {
+    /* Hot: everything a typical instruction touches shares the first cache
+     * line, see CHIP8_HOT_BYTES */
+    chip8_exec_fn exec;
+
+    /* Memory in use: own_ram, or a shared read-only image until the first
+     * write, see chip8_reset_shared() */
+    uint8_t *ram;
 
     /* 0x0..0xE - general purpose registers, 0xF for flags  */
-    uint8_t regs[0xf];
+    uint8_t regs[16];
 
-    /* Mostly for memory addresses, only 12 lower bits used */
+    /* Memory addresses, 12-bit in CHIP-8, 16-bit with XO-CHIP F000 NNNN.
+     * Accesses through it are masked with ram_mask. */
     uint16_t I;
     /* Program counter */
     uint16_t PC;
+    /* Unchecked accesses wrap around within the memory of the mode */
+    uint16_t ram_mask;
 
     /* Delay and sound timers, 60 Hz */
     uint8_t DT;
     uint8_t ST;
 
-    /* Stack pointer */
+    /* Stack pointer, wraps around unless checked */
     uint8_t SP;
+
+    /* CHIP-8 or XO-CHIP instruction set */
+    uint8_t mode;
+    /* Instruction cost model used by chip8_run_frame() */
+    uint8_t timing;
+
+    /* Frame scheduler budget left, in the timing model units, negative when
+     * the last instruction overran the previous frame */
+    int32_t cycles_left;
+    /* Microseconds left to next CPU/DT/ST ticks */
+    uint32_t usec_to_cpu_tick;
+    uint32_t usec_to_timer_tick;
+    /* Fixed timing instruction cost, see chip8_set_speed() */
+    uint32_t usec_per_cpu_step;
+
+    /* RND generator, per machine so that instances are independent and
+     * reproducible */
+    uint32_t rng_state;
+
     /* Stack */
     uint16_t stack[MAX_STACK_DEPTH];
 
-    /* Memory */
-    uint8_t ram[MEMORY_SIZE_BYTES];
+    /* Emulated time since reset, timestamps audio */
+    uint64_t usec_elapsed;
+    uint64_t usec_frame_start;
+
+    /* enum chip8_quirk bits and the interpreter instance handling them */
+    uint32_t quirks;
+
+    /* Checked mode: guest faults stop execution and are reported instead
+     * of being absorbed by masking and the RAM guard */
+    bool is_checked;
+    chip8_fault fault;
+
+    /* XO-CHIP audio pattern buffer and its playback pitch */
+    uint8_t pitch;
+    uint8_t audio_pattern[AUDIO_PATTERN_BYTES];
+    /* Is the tone currently on, i.e. ST > 0 */
+    bool is_tone_on;
 
     /* IO */
     fb_console *display;
     keyboard *key;
-} chip8;
+    audio *sound;               /* optional */
+
+    /* Guest profiling, optional */
+    profile *prof;
+
+    /* Input latency measurement, optional */
+    latency *lat;
+
+    /* Shared memory image of the machine, NULL for machines on own_ram */
+    const uint8_t *ram_image;
+
+    /* Memory of machines reset with chip8_reset(), the whole 64K is always
+     * there so that the mode can change any time. Machines on a shared image
+     * are allocated without it, see CHIP8_COMPACT_BYTES. */
+    uint8_t own_ram[XOCHIP_MEMORY_SIZE_BYTES + RAM_GUARD_BYTES];
+};
 
-void chip8_reset(chip8 *vm, keyboard *key, fb_console *display);
+#define CHIP8_HOT_BYTES 64
+static_assert(offsetof(struct chip8, rng_state) + sizeof(uint32_t) <= CHIP8_HOT_BYTES,
+              "Hot machine fields are expected to fit a cache line");
+
+/* A machine without own_ram, enough for chip8_reset_shared() */
+#define CHIP8_COMPACT_BYTES offsetof(struct chip8, own_ram)
+
+/* Memory of a mode as a shared image or a private copy of one, the RAM guard
+ * included */
+#define CHIP8_IMAGE_BYTES(mode) \
+    (((mode) == CHIP8_MODE_XOCHIP ? XOCHIP_MEMORY_SIZE_BYTES : MEMORY_SIZE_BYTES) + RAM_GUARD_BYTES)
+
+/* CHIP8_FAIL if the keyboard can't be flushed */
+int chip8_reset(chip8 *vm, keyboard *key, fb_console *display);
+
+/* Memory as a machine starts with it: the font and a ROM, CHIP8_IMAGE_BYTES()
+ * of image */
+void chip8_init_image(uint8_t *image, enum chip8_mode mode, const uint8_t *rom, size_t rom_size);
+
+/* chip8_reset() for machines of CHIP8_COMPACT_BYTES, zeroed or reset this way
+ * before. Memory is the image, shared read-only with other machines until the
+ * first write copies it, and the mode is the image's one. */
+int chip8_reset_shared(chip8 *vm, keyboard *key, fb_console *display,
+                       const uint8_t *image, enum chip8_mode mode);
+
+static inline bool chip8_is_ram_shared(const chip8 *vm)
+{
+    return vm->ram == vm->ram_image;
+}
+
+/* A private copy of a shared image to write to, CHIP8_FAIL if it can't be
+ * allocated. Nothing to do for machines on own_ram. */
+int chip8_unshare_ram(chip8 *vm);
+
+/* Drop the private copy, back to the shared image */
+void chip8_release_ram(chip8 *vm);
+
+void chip8_set_mode(chip8 *vm, enum chip8_mode mode);
+
+void chip8_set_timing(chip8 *vm, enum chip8_timing timing);
+
+/* Select the interpreter instance for a combination of enum chip8_quirk */
+void chip8_set_quirks(chip8 *vm, uint32_t quirks);
+
+/* Checked or fast (default) instances, see chip8.is_checked */
+void chip8_set_checked(chip8 *vm, bool is_checked);
+
+/* Seed RND, chip8_reset() seeds from the clock */
+void chip8_set_seed(chip8 *vm, uint32_t seed);
+
+/* xorshift32 */
+static inline uint8_t chip8_random(chip8 *vm)
+{
+    uint32_t s = vm->rng_state;
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    vm->rng_state = s;
+    return s >> 24;
+}
+
+const char *chip8_fault_name(enum chip8_fault_kind kind);
+
+/* Instructions per second under fixed timing, FREQUENCY_TIMER and up */
+void chip8_set_speed(chip8 *vm, uint32_t frequency);
+
+void chip8_set_audio(chip8 *vm, audio *sound);
+
+void chip8_set_profile(chip8 *vm, profile *prof);
+
+void chip8_set_latency(chip8 *vm, latency *lat);
 
 uint16_t chip8_fetch(chip8 *vm);
 
-void chip8_exec(chip8 *vm, uint16_t instruction);
+/* enum chip8_status: CHIP8_FAULT with the instruction not executed,
+ * CHIP8_HALT for a jump to itself */
+int chip8_exec(chip8 *vm, uint16_t instruction);
 
-void chip8_redraw(chip8 *vm);
+/* Same as chip8_exec(), except that quirks and checking are looked up at run
+ * time instead of being specialized: the reference for faster interpreters,
+ * see lockstep.h */
+int chip8_exec_generic(chip8 *vm, uint16_t instruction);
 
-void chip8_cpu_tick(chip8 *vm);
+int chip8_redraw(chip8 *vm);
+
+/* An instruction if one is due. The CPU clock stays stopped after a
+ * CHIP8_FAULT, callers looping on chip8_tick() have to stop there. */
+int chip8_cpu_tick(chip8 *vm);
 
 void chip8_timers_tick(chip8 *vm);
 
 uint32_t chip8_tick(chip8 *vm);
 
+/* Frame scheduler: tick the timers once and run instructions until the 60Hz
+ * frame budget of the timing model is spent. Under VIP timing a DRW waits for
+ * the display and ends the frame. A guest fault or a host failure ends the
+ * frame early, a halted program sleeps through the rest of it. */
+int chip8_run_frame(chip8 *vm);
+
+/* chip8_run_frame() pieces for alternative execution engines: begin the
+ * frame, step single instructions while cycles_left > 0, end the frame */
+int chip8_frame_begin(chip8 *vm);
+
+int chip8_frame_step(chip8 *vm);
+
+void chip8_frame_end(chip8 *vm);
+
+/* Machine state as a flat buffer: registers, timers, the display and RAM in
+ * use, I/O attachments excluded. The size depends on the mode. */
+size_t chip8_state_size(const chip8 *vm);
+
+/* Largest chip8_state_size(), XO-CHIP */
+#define CHIP8_MAX_STATE_BYTES \
+    (CHIP8_COMPACT_BYTES + sizeof(fb_console) + XOCHIP_MEMORY_SIZE_BYTES)
+
+void chip8_save_state(const chip8 *vm, uint8_t *state);
+
+/* A state saved in the same mode, attachments, settings and the emulated
+ * clock are kept. CHIP8_FAIL if a shared image can't be copied. */
+int chip8_load_state(chip8 *vm, const uint8_t *state);
+
+/* chip8_load_state() into the private copy of a machine that has one, memory
+ * is overwritten and nothing is allocated or freed. A machine still on its
+ * shared image gets a copy first. */
+int chip8_load_state_private(chip8 *vm, const uint8_t *state);
+
 #endif /* CHIP8_H */
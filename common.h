@@ -1,7 +1,10 @@
 #ifndef COMMON_H
 #define COMMON_H
 
+/* Instruction trace on stderr, build with -DNO_DEBUG_TRACE to disable */
+#ifndef NO_DEBUG_TRACE
 #define DEBUG_TRACE
+#endif
 
 #define CHIP8_KEY_1 0x1
 #define CHIP8_KEY_2 0x2
@@ -0,0 +1,799 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "debugger.h"
+#include "disasm.h"
+
+/* Largest packet either way, advertised to GDB */
+#define PACKET_MAX 4096
+
+/* Stop replies, signal numbers as GDB knows them */
+#define STOP_INTERRUPT "S02"
+#define STOP_TRAP "S05"
+#define STOP_ILLEGAL "S04"
+#define STOP_SEGV "S0b"
+
+/* Register numbers in the target description order */
+enum debugger_reg {
+    REG_V0 = 0,
+    REG_I = 16,
+    REG_PC,
+    REG_SP,
+    REG_DT,
+    REG_ST,
+    REG_COUNT
+};
+
+/* Register bytes in the 'g' layout, I and PC take 2 bytes each */
+#define REG_BYTES (REG_COUNT + 2)
+
+static const char target_xml[] =
+    "<?xml version=\"1.0\"?>"
+    "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">"
+    "<target version=\"1.0\">"
+    "<feature name=\"org.pchip.chip8\">"
+    "<reg name=\"v0\" bitsize=\"8\" type=\"uint8\" regnum=\"0\"/>"
+    "<reg name=\"v1\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"v2\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"v3\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"v4\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"v5\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"v6\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"v7\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"v8\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"v9\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"va\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"vb\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"vc\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"vd\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"ve\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"vf\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"i\" bitsize=\"16\" type=\"data_ptr\"/>"
+    "<reg name=\"pc\" bitsize=\"16\" type=\"code_ptr\"/>"
+    "<reg name=\"sp\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"dt\" bitsize=\"8\" type=\"uint8\"/>"
+    "<reg name=\"st\" bitsize=\"8\" type=\"uint8\"/>"
+    "</feature>"
+    "</target>";
+
+typedef struct watchpoint {
+    uint32_t addr;
+    uint32_t bytes;
+    uint8_t kind;               /* enum debugger_watch */
+} watchpoint;
+
+struct debugger {
+    int listen_fd;
+    int fd;                     /* GDB connection, -1 if there is none */
+
+    bool is_stopped;
+    /* GDB is waiting for a stop reply after a continue or step */
+    bool is_reply_pending;
+    bool is_stepping;
+    /* Resuming from a breakpoint, don't stop at it right away */
+    bool is_breakpoint_skipped;
+    /* Stopped halfway through a frame */
+    bool is_in_frame;
+    char stop_reply[32];
+
+    size_t breakpoint_count;
+    uint64_t breakpoints[XOCHIP_MEMORY_SIZE_BYTES / 64];
+
+    size_t watchpoint_count;
+    watchpoint watchpoints[DEBUGGER_MAX_WATCHPOINTS];
+
+    char in[PACKET_MAX * 2];
+    size_t in_bytes;
+};
+
+int debugger_new(uint16_t port, debugger **dbg)
+{
+    *dbg = calloc(1, sizeof(**dbg));
+    if (!*dbg) {
+        fprintf(stderr, "Calloc failure\n");
+        return DEBUGGER_FAIL;
+    }
+
+    debugger *d = *dbg;
+    d->fd = -1;
+    strcpy(d->stop_reply, STOP_TRAP);
+
+    d->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (d->listen_fd == -1) {
+        perror("socket");
+        goto err;
+    }
+
+    int yes = 1;
+    setsockopt(d->listen_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    /* Loopback only, the stub can do anything to the machine */
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (bind(d->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        perror("bind");
+        goto err;
+    }
+    if (listen(d->listen_fd, 1) == -1) {
+        perror("listen");
+        goto err;
+    }
+
+    return DEBUGGER_SUCCESS;
+
+err:
+    if (d->listen_fd != -1)
+        close(d->listen_fd);
+    free(d);
+    *dbg = NULL;
+    return DEBUGGER_FAIL;
+}
+
+static void disconnect(debugger *dbg)
+{
+    close(dbg->fd);
+    dbg->fd = -1;
+    dbg->in_bytes = 0;
+    dbg->is_reply_pending = false;
+}
+
+void debugger_free(debugger *dbg)
+{
+    if (!dbg)
+        return;
+    if (dbg->fd != -1)
+        disconnect(dbg);
+    close(dbg->listen_fd);
+    free(dbg);
+}
+
+uint16_t debugger_port(const debugger *dbg)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    if (getsockname(dbg->listen_fd, (struct sockaddr *)&addr, &len) == -1)
+        return 0;
+    return ntohs(addr.sin_port);
+}
+
+bool debugger_is_stopped(const debugger *dbg)
+{
+    return dbg->is_stopped;
+}
+
+bool debugger_is_in_frame(const debugger *dbg)
+{
+    return dbg->is_in_frame;
+}
+
+/*
+ * Breakpoints and watchpoints
+ */
+
+void debugger_set_breakpoint(debugger *dbg, uint16_t addr, bool is_armed)
+{
+    uint64_t bit = 1ull << (addr % 64);
+    uint64_t *word = &dbg->breakpoints[addr / 64];
+
+    if (is_armed == !!(*word & bit))
+        return;
+
+    *word ^= bit;
+    if (is_armed)
+        dbg->breakpoint_count++;
+    else
+        dbg->breakpoint_count--;
+}
+
+static bool is_breakpoint(const debugger *dbg, uint16_t addr)
+{
+    return dbg->breakpoints[addr / 64] & (1ull << (addr % 64));
+}
+
+int debugger_set_watchpoint(debugger *dbg, uint32_t addr, uint32_t bytes, enum debugger_watch kind)
+{
+    if (dbg->watchpoint_count == DEBUGGER_MAX_WATCHPOINTS)
+        return DEBUGGER_FAIL;
+
+    dbg->watchpoints[dbg->watchpoint_count++] = (watchpoint){ addr, bytes, kind };
+    return DEBUGGER_SUCCESS;
+}
+
+void debugger_clear_watchpoint(debugger *dbg, uint32_t addr, uint32_t bytes, enum debugger_watch kind)
+{
+    for (size_t i = 0; i < dbg->watchpoint_count; i++) {
+        watchpoint *wp = &dbg->watchpoints[i];
+        if (wp->addr == addr && wp->bytes == bytes && wp->kind == kind) {
+            *wp = dbg->watchpoints[--dbg->watchpoint_count];
+            return;
+        }
+    }
+}
+
+/* RAM an instruction is about to read or write, decoded the same way
+ * chip8_exec() does it. False if it doesn't touch RAM beyond the fetch. */
+static bool ram_access(const chip8 *vm, uint16_t instruction, uint32_t *addr, uint32_t *bytes,
+                       enum debugger_watch *kind)
+{
+    uint16_t x = (0x0F00 & instruction) >> 8;
+    uint16_t y = (0x00F0 & instruction) >> 4;
+    uint16_t n = (0x000F & instruction);
+
+    *addr = vm->I;
+    switch (disasm_class(instruction, vm->mode)) {
+    case DISASM_DRW:{
+        uint32_t sprite_bytes = (vm->mode == CHIP8_MODE_XOCHIP && n == 0) ? 32 : n;
+        *bytes = sprite_bytes * __builtin_popcount(vm->display->planes);
+        *kind = DEBUGGER_WATCH_READ;
+        break;
+    }
+    case DISASM_AUDIO:
+        *bytes = AUDIO_PATTERN_BYTES;
+        *kind = DEBUGGER_WATCH_READ;
+        break;
+    case DISASM_LD_REGS:
+        *bytes = x + 1;
+        *kind = DEBUGGER_WATCH_READ;
+        break;
+    case DISASM_LOAD_RANGE:
+        *bytes = (x <= y ? y - x : x - y) + 1;
+        *kind = DEBUGGER_WATCH_READ;
+        break;
+    case DISASM_LD_B:
+        *bytes = 3;
+        *kind = DEBUGGER_WATCH_WRITE;
+        break;
+    case DISASM_LD_MEM:
+        *bytes = x + 1;
+        *kind = DEBUGGER_WATCH_WRITE;
+        break;
+    case DISASM_SAVE_RANGE:
+        *bytes = (x <= y ? y - x : x - y) + 1;
+        *kind = DEBUGGER_WATCH_WRITE;
+        break;
+    default:
+        return false;
+    }
+
+    return *bytes > 0;
+}
+
+/* Watchpoint the instruction triggers, NULL if none */
+static const watchpoint *watch_hit(const debugger *dbg, const chip8 *vm, uint16_t instruction)
+{
+    uint32_t addr, bytes;
+    enum debugger_watch kind;
+    if (!ram_access(vm, instruction, &addr, &bytes, &kind))
+        return NULL;
+
+    for (size_t i = 0; i < dbg->watchpoint_count; i++) {
+        const watchpoint *wp = &dbg->watchpoints[i];
+        if ((wp->kind & kind) && addr < wp->addr + wp->bytes && wp->addr < addr + bytes)
+            return wp;
+    }
+    return NULL;
+}
+
+/*
+ * Protocol
+ */
+
+static const char hex_digits[] = "0123456789abcdef";
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+/* Parse a hex number, NULL if there are no digits */
+static const char *parse_hex(const char *s, uint32_t *value)
+{
+    *value = 0;
+    const char *start = s;
+    for (int digit; (digit = hex_value(*s)) >= 0; s++)
+        *value = (*value << 4) | digit;
+    return s == start ? NULL : s;
+}
+
+static char *write_hex_bytes(char *out, const uint8_t *bytes, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        *out++ = hex_digits[bytes[i] >> 4];
+        *out++ = hex_digits[bytes[i] & 0xF];
+    }
+    *out = '\0';
+    return out;
+}
+
+static bool read_hex_bytes(const char *in, uint8_t *bytes, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        int hi = hex_value(in[2 * i]), lo = hex_value(in[2 * i + 1]);
+        if (hi < 0 || lo < 0)
+            return false;
+        bytes[i] = hi << 4 | lo;
+    }
+    return true;
+}
+
+static void send_packet(debugger *dbg, const char *body)
+{
+    if (dbg->fd == -1)
+        return;
+
+    static const size_t framing = 4;  /* $ # and the checksum */
+    char packet[PACKET_MAX + framing + 1];
+    size_t len = strlen(body);
+    if (len > PACKET_MAX)
+        len = PACKET_MAX;
+
+    uint8_t checksum = 0;
+    for (size_t i = 0; i < len; i++)
+        checksum += (uint8_t)body[i];
+
+    packet[0] = '$';
+    memcpy(packet + 1, body, len);
+    packet[len + 1] = '#';
+    packet[len + 2] = hex_digits[checksum >> 4];
+    packet[len + 3] = hex_digits[checksum & 0xF];
+
+    for (size_t sent = 0; sent < len + framing;) {
+        ssize_t rc = send(dbg->fd, packet + sent, len + framing - sent, MSG_NOSIGNAL);
+        if (rc == -1 && errno == EINTR)
+            continue;
+        if (rc <= 0) {
+            disconnect(dbg);
+            return;
+        }
+        sent += rc;
+    }
+}
+
+static void stop_with(debugger *dbg, const char *reply)
+{
+    dbg->is_stopped = true;
+    dbg->is_stepping = false;
+    snprintf(dbg->stop_reply, sizeof(dbg->stop_reply), "%s", reply);
+    if (dbg->is_reply_pending) {
+        dbg->is_reply_pending = false;
+        send_packet(dbg, dbg->stop_reply);
+    }
+}
+
+void debugger_stop(debugger *dbg)
+{
+    if (!dbg->is_stopped)
+        stop_with(dbg, STOP_INTERRUPT);
+}
+
+void debugger_continue(debugger *dbg)
+{
+    dbg->is_stopped = false;
+    dbg->is_stepping = false;
+    dbg->is_breakpoint_skipped = true;
+}
+
+void debugger_step(debugger *dbg)
+{
+    dbg->is_stopped = false;
+    dbg->is_stepping = true;
+    dbg->is_breakpoint_skipped = true;
+}
+
+static uint32_t ram_size(const chip8 *vm)
+{
+    return vm->mode == CHIP8_MODE_XOCHIP ? XOCHIP_MEMORY_SIZE_BYTES : MEMORY_SIZE_BYTES;
+}
+
+static void read_registers(const chip8 *vm, uint8_t regs[REG_BYTES])
+{
+    memcpy(regs, vm->regs, 16);
+    regs[REG_I] = vm->I & 0xFF;
+    regs[REG_I + 1] = vm->I >> 8;
+    regs[REG_PC + 1] = vm->PC & 0xFF;
+    regs[REG_PC + 2] = vm->PC >> 8;
+    regs[REG_SP + 2] = vm->SP;
+    regs[REG_DT + 2] = vm->DT;
+    regs[REG_ST + 2] = vm->ST;
+}
+
+static void write_registers(chip8 *vm, const uint8_t regs[REG_BYTES])
+{
+    memcpy(vm->regs, regs, 16);
+    vm->I = regs[REG_I] | regs[REG_I + 1] << 8;
+    vm->PC = regs[REG_PC + 1] | regs[REG_PC + 2] << 8;
+    vm->SP = regs[REG_SP + 2] & STACK_INDEX_MASK;
+    vm->DT = regs[REG_DT + 2];
+    vm->ST = regs[REG_ST + 2];
+}
+
+/* Offset and size of register n in the 'g' layout */
+static bool register_slot(uint32_t n, size_t *offset, size_t *size)
+{
+    if (n >= REG_COUNT)
+        return false;
+    *offset = n <= REG_I ? n : n <= REG_PC ? n + 1 : n + 2;
+    *size = (n == REG_I || n == REG_PC) ? 2 : 1;
+    return true;
+}
+
+static void handle_breakpoint_packet(debugger *dbg, const char *packet)
+{
+    bool is_insert = packet[0] == 'Z';
+    uint32_t type, addr, kind;
+    const char *p = parse_hex(packet + 1, &type);
+    if (!p || *p != ',' || !(p = parse_hex(p + 1, &addr)) || *p != ',' || !parse_hex(p + 1, &kind)) {
+        send_packet(dbg, "E01");
+        return;
+    }
+
+    switch (type) {
+    case 0:
+    case 1:
+        if (addr >= XOCHIP_MEMORY_SIZE_BYTES) {
+            send_packet(dbg, "E01");
+            return;
+        }
+        debugger_set_breakpoint(dbg, addr, is_insert);
+        break;
+    case 2:
+    case 3:
+    case 4:{
+        static const enum debugger_watch kinds[] = {
+            DEBUGGER_WATCH_WRITE, DEBUGGER_WATCH_READ, DEBUGGER_WATCH_ACCESS
+        };
+        enum debugger_watch watch = kinds[type - 2];
+        if (!is_insert) {
+            debugger_clear_watchpoint(dbg, addr, kind, watch);
+        } else if (debugger_set_watchpoint(dbg, addr, kind, watch) != DEBUGGER_SUCCESS) {
+            send_packet(dbg, "E02");
+            return;
+        }
+        break;
+    }
+    default:
+        send_packet(dbg, "");
+        return;
+    }
+    send_packet(dbg, "OK");
+}
+
+static void handle_query(debugger *dbg, const char *packet)
+{
+    static const char xfer[] = "qXfer:features:read:target.xml:";
+
+    if (strncmp(packet, "qSupported", 10) == 0) {
+        char reply[64];
+        snprintf(reply, sizeof(reply), "PacketSize=%x;qXfer:features:read+", PACKET_MAX);
+        send_packet(dbg, reply);
+    } else if (strncmp(packet, xfer, sizeof(xfer) - 1) == 0) {
+        uint32_t offset, length;
+        const char *p = parse_hex(packet + sizeof(xfer) - 1, &offset);
+        if (!p || *p != ',' || !parse_hex(p + 1, &length)) {
+            send_packet(dbg, "E01");
+            return;
+        }
+
+        size_t total = sizeof(target_xml) - 1;
+        if (offset > total)
+            offset = total;
+        if (length > PACKET_MAX - 1)
+            length = PACKET_MAX - 1;
+        size_t chunk = total - offset < length ? total - offset : length;
+
+        char reply[PACKET_MAX + 1];
+        reply[0] = offset + chunk < total ? 'm' : 'l';
+        memcpy(reply + 1, target_xml + offset, chunk);
+        reply[chunk + 1] = '\0';
+        send_packet(dbg, reply);
+    } else if (strcmp(packet, "qAttached") == 0) {
+        send_packet(dbg, "1");
+    } else if (strcmp(packet, "qC") == 0) {
+        send_packet(dbg, "QC1");
+    } else if (strcmp(packet, "qfThreadInfo") == 0) {
+        send_packet(dbg, "m1");
+    } else if (strcmp(packet, "qsThreadInfo") == 0) {
+        send_packet(dbg, "l");
+    } else {
+        send_packet(dbg, "");
+    }
+}
+
+/* Optional resume address of c and s */
+static bool parse_resume(chip8 *vm, const char *args)
+{
+    uint32_t addr;
+    if (!*args)
+        return true;
+    if (!parse_hex(args, &addr) || addr >= ram_size(vm))
+        return false;
+    vm->PC = addr;
+    return true;
+}
+
+static void handle_packet(debugger *dbg, chip8 *vm, const char *packet)
+{
+    char reply[PACKET_MAX + 1];
+
+    switch (packet[0]) {
+    case '?':
+        send_packet(dbg, dbg->stop_reply);
+        break;
+    case 'g':{
+        uint8_t regs[REG_BYTES] = {0};
+        read_registers(vm, regs);
+        write_hex_bytes(reply, regs, sizeof(regs));
+        send_packet(dbg, reply);
+        break;
+    }
+    case 'G':{
+        uint8_t regs[REG_BYTES];
+        if (strlen(packet + 1) != 2 * sizeof(regs) || !read_hex_bytes(packet + 1, regs, sizeof(regs))) {
+            send_packet(dbg, "E01");
+            break;
+        }
+        write_registers(vm, regs);
+        send_packet(dbg, "OK");
+        break;
+    }
+    case 'p':{
+        uint32_t n;
+        size_t offset, size;
+        uint8_t regs[REG_BYTES] = {0};
+        if (!parse_hex(packet + 1, &n) || !register_slot(n, &offset, &size)) {
+            send_packet(dbg, "E01");
+            break;
+        }
+        read_registers(vm, regs);
+        write_hex_bytes(reply, regs + offset, size);
+        send_packet(dbg, reply);
+        break;
+    }
+    case 'P':{
+        uint32_t n;
+        size_t offset, size;
+        uint8_t regs[REG_BYTES] = {0};
+        const char *p = parse_hex(packet + 1, &n);
+        if (!p || *p != '=' || !register_slot(n, &offset, &size) || strlen(p + 1) != 2 * size) {
+            send_packet(dbg, "E01");
+            break;
+        }
+        read_registers(vm, regs);
+        if (!read_hex_bytes(p + 1, regs + offset, size)) {
+            send_packet(dbg, "E01");
+            break;
+        }
+        write_registers(vm, regs);
+        send_packet(dbg, "OK");
+        break;
+    }
+    case 'm':{
+        uint32_t addr, length;
+        const char *p = parse_hex(packet + 1, &addr);
+        if (!p || *p != ',' || !parse_hex(p + 1, &length) || addr >= ram_size(vm)) {
+            send_packet(dbg, "E01");
+            break;
+        }
+        if (length > ram_size(vm) - addr)
+            length = ram_size(vm) - addr;
+        if (length > PACKET_MAX / 2)
+            length = PACKET_MAX / 2;
+        write_hex_bytes(reply, vm->ram + addr, length);
+        send_packet(dbg, reply);
+        break;
+    }
+    case 'M':{
+        uint32_t addr, length;
+        const char *p = parse_hex(packet + 1, &addr);
+        if (!p || *p != ',' || !(p = parse_hex(p + 1, &length)) || *p != ':' ||
+            addr >= ram_size(vm) || length > ram_size(vm) - addr || strlen(p + 1) != 2 * length ||
+            chip8_unshare_ram(vm) != CHIP8_SUCCESS || !read_hex_bytes(p + 1, vm->ram + addr, length)) {
+            send_packet(dbg, "E01");
+            break;
+        }
+        send_packet(dbg, "OK");
+        break;
+    }
+    case 'c':
+    case 's':
+        if (!parse_resume(vm, packet + 1)) {
+            send_packet(dbg, "E01");
+            break;
+        }
+        if (packet[0] == 'c')
+            debugger_continue(dbg);
+        else
+            debugger_step(dbg);
+        dbg->is_reply_pending = true;
+        break;
+    case 'Z':
+    case 'z':
+        handle_breakpoint_packet(dbg, packet);
+        break;
+    case 'q':
+        handle_query(dbg, packet);
+        break;
+    case 'H':
+    case 'T':
+        send_packet(dbg, "OK");
+        break;
+    case 'D':
+        send_packet(dbg, "OK");
+        /* fall through */
+    case 'k':
+        /* Let the machine go on its own */
+        memset(dbg->breakpoints, 0, sizeof(dbg->breakpoints));
+        dbg->breakpoint_count = 0;
+        dbg->watchpoint_count = 0;
+        debugger_continue(dbg);
+        disconnect(dbg);
+        break;
+    default:
+        /* Not supported */
+        send_packet(dbg, "");
+        break;
+    }
+}
+
+/* Handle every complete packet in the input buffer */
+static void handle_input(debugger *dbg, chip8 *vm)
+{
+    size_t i = 0;
+
+    while (i < dbg->in_bytes && dbg->fd != -1) {
+        char c = dbg->in[i];
+
+        if (c == 0x03) {
+            debugger_stop(dbg);
+            if (dbg->is_reply_pending) {
+                dbg->is_reply_pending = false;
+                send_packet(dbg, dbg->stop_reply);
+            }
+            i++;
+            continue;
+        }
+        if (c != '$') {
+            /* Acks and line noise */
+            i++;
+            continue;
+        }
+
+        char *end = memchr(dbg->in + i, '#', dbg->in_bytes - i);
+        if (!end || (size_t)(end - dbg->in) + 3 > dbg->in_bytes)
+            break;
+
+        uint8_t checksum = 0;
+        for (char *p = dbg->in + i + 1; p < end; p++)
+            checksum += (uint8_t)*p;
+        int hi = hex_value(end[1]), lo = hex_value(end[2]);
+        bool is_valid = hi >= 0 && lo >= 0 && (hi << 4 | lo) == checksum;
+
+        send(dbg->fd, is_valid ? "+" : "-", 1, MSG_NOSIGNAL);
+        if (is_valid) {
+            *end = '\0';
+            handle_packet(dbg, vm, dbg->in + i + 1);
+        }
+        i = end - dbg->in + 3;
+    }
+
+    if (dbg->fd == -1)
+        return;
+
+    memmove(dbg->in, dbg->in + i, dbg->in_bytes - i);
+    dbg->in_bytes -= i;
+
+    /* A packet that doesn't fit is garbage */
+    if (dbg->in_bytes == sizeof(dbg->in))
+        dbg->in_bytes = 0;
+}
+
+static void serve(debugger *dbg, chip8 *vm)
+{
+    if (dbg->fd == -1) {
+        dbg->fd = accept(dbg->listen_fd, NULL, NULL);
+        if (dbg->fd == -1)
+            return;
+
+        int yes = 1;
+        setsockopt(dbg->fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        /* GDB expects a stopped target */
+        dbg->is_reply_pending = false;
+        if (!dbg->is_stopped)
+            stop_with(dbg, STOP_TRAP);
+    }
+
+    for (;;) {
+        ssize_t got = recv(dbg->fd, dbg->in + dbg->in_bytes, sizeof(dbg->in) - dbg->in_bytes,
+                           MSG_DONTWAIT);
+        if (got == -1 && errno == EINTR)
+            continue;
+        if (got == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        if (got <= 0) {
+            /* GDB went away, let the machine run */
+            disconnect(dbg);
+            debugger_continue(dbg);
+            return;
+        }
+
+        dbg->in_bytes += got;
+        handle_input(dbg, vm);
+        if (dbg->fd == -1)
+            return;
+    }
+}
+
+int debugger_run_frame(debugger *dbg, chip8 *vm)
+{
+    serve(dbg, vm);
+    if (dbg->is_stopped)
+        return CHIP8_SUCCESS;
+
+    if (!dbg->is_in_frame) {
+        int rc = chip8_frame_begin(vm);
+        if (rc != CHIP8_SUCCESS)
+            return rc;
+        dbg->is_in_frame = true;
+    }
+
+    while (vm->cycles_left > 0) {
+        if (dbg->breakpoint_count && !dbg->is_breakpoint_skipped && is_breakpoint(dbg, vm->PC)) {
+            stop_with(dbg, STOP_TRAP);
+            return CHIP8_SUCCESS;
+        }
+        dbg->is_breakpoint_skipped = false;
+
+        const watchpoint *wp = NULL;
+        if (dbg->watchpoint_count) {
+            uint16_t instruction = vm->ram[vm->PC] << 8 | vm->ram[vm->PC + 1];
+            wp = watch_hit(dbg, vm, instruction);
+        }
+
+        int rc = chip8_frame_step(vm);
+        if (rc == CHIP8_FAIL)
+            return rc;
+        if (rc == CHIP8_FAULT) {
+            bool is_illegal = vm->fault.kind == CHIP8_FAULT_ILLEGAL_INSTRUCTION;
+            stop_with(dbg, is_illegal ? STOP_ILLEGAL : STOP_SEGV);
+            return CHIP8_SUCCESS;
+        }
+
+        if (wp) {
+            static const char *names[] = {
+                [DEBUGGER_WATCH_WRITE] = "watch",
+                [DEBUGGER_WATCH_READ] = "rwatch",
+                [DEBUGGER_WATCH_ACCESS] = "awatch",
+            };
+            char reply[32];
+            snprintf(reply, sizeof(reply), "T05%s:%x;", names[wp->kind], wp->addr);
+            stop_with(dbg, reply);
+            return CHIP8_SUCCESS;
+        }
+
+        if (dbg->is_stepping) {
+            stop_with(dbg, STOP_TRAP);
+            return CHIP8_SUCCESS;
+        }
+    }
+
+    chip8_frame_end(vm);
+    dbg->is_in_frame = false;
+
+    return CHIP8_SUCCESS;
+}
@@ -0,0 +1,75 @@
+#ifndef DEBUGGER_H
+#define DEBUGGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chip8.h"
+
+/*
+ * Debugger with a GDB remote serial protocol stub
+ *
+ * Listens on a loopback TCP port for a single GDB connection:
+ *
+ *   (gdb) target remote :1234
+ *
+ * Supported: register and memory inspection and changes, single-step,
+ * continue, interrupt, PC breakpoints (Z0/Z1) and write/read/access
+ * watchpoints (Z2/Z3/Z4). The register layout comes with a target
+ * description: V0-VF, I, PC, SP, DT and ST, little endian.
+ *
+ * The machine stops when GDB attaches. Frames are run by debugger_run_frame()
+ * instead of chip8_run_frame(): it's the same scheduler, except that a frame
+ * can stop halfway and resume later. Breakpoints are a bitmap over the address
+ * space, it's only looked at while a breakpoint is armed and watchpoints only
+ * while a watchpoint is, normal execution pays nothing else.
+ */
+
+#define DEBUGGER_MAX_WATCHPOINTS 16
+
+enum debugger_status {
+    DEBUGGER_SUCCESS,
+    DEBUGGER_FAIL,
+};
+
+typedef struct debugger debugger;
+
+/* Port 0 picks a free one, see debugger_port() */
+int debugger_new(uint16_t port, debugger **dbg);
+
+void debugger_free(debugger *dbg);
+
+uint16_t debugger_port(const debugger *dbg);
+
+/* Serve GDB and run a frame unless the machine is stopped, enum chip8_status.
+ * Guest faults stop the machine and are reported to GDB, only host failures
+ * come back. */
+int debugger_run_frame(debugger *dbg, chip8 *vm);
+
+bool debugger_is_stopped(const debugger *dbg);
+
+/* A frame was begun and has not run to its end yet */
+bool debugger_is_in_frame(const debugger *dbg);
+
+/* Local interface, what GDB packets end up calling */
+void debugger_set_breakpoint(debugger *dbg, uint16_t addr, bool is_armed);
+
+enum debugger_watch {
+    DEBUGGER_WATCH_WRITE = 1 << 0,
+    DEBUGGER_WATCH_READ = 1 << 1,
+    DEBUGGER_WATCH_ACCESS = DEBUGGER_WATCH_WRITE | DEBUGGER_WATCH_READ,
+};
+
+/* DEBUGGER_FAIL when out of watchpoints */
+int debugger_set_watchpoint(debugger *dbg, uint32_t addr, uint32_t bytes, enum debugger_watch kind);
+
+void debugger_clear_watchpoint(debugger *dbg, uint32_t addr, uint32_t bytes, enum debugger_watch kind);
+
+void debugger_stop(debugger *dbg);
+
+void debugger_continue(debugger *dbg);
+
+/* Run a single instruction on the next debugger_run_frame() and stop */
+void debugger_step(debugger *dbg);
+
+#endif /* DEBUGGER_H */
@@ -0,0 +1,70 @@
+#include <string.h>
+
+#include "delta.h"
+
+/* Unchanged bytes from i on, a word at a time while it lasts */
+static size_t unchanged_run(const uint8_t *prev, const uint8_t *cur, size_t i, size_t bytes)
+{
+    size_t start = i;
+
+    for (; i + sizeof(uint64_t) <= bytes; i += sizeof(uint64_t)) {
+        uint64_t a, b;
+        memcpy(&a, prev + i, sizeof(a));
+        memcpy(&b, cur + i, sizeof(b));
+        if (a != b)
+            break;
+    }
+    while (i < bytes && prev[i] == cur[i])
+        i++;
+
+    return i - start;
+}
+
+size_t delta_encode(const uint8_t *prev, const uint8_t *cur, size_t bytes, uint8_t *out)
+{
+    size_t n = 0;
+
+    for (size_t i = 0; i < bytes;) {
+        size_t unchanged = unchanged_run(prev, cur, i, bytes);
+        if (i + unchanged == bytes)
+            break;
+        i += unchanged;
+
+        /* Long runs take empty tokens */
+        for (; unchanged > UINT8_MAX; unchanged -= UINT8_MAX) {
+            out[n++] = UINT8_MAX;
+            out[n++] = 0;
+        }
+
+        size_t changed = 0;
+        while (i + changed < bytes && changed < UINT8_MAX && prev[i + changed] != cur[i + changed])
+            changed++;
+
+        out[n++] = unchanged;
+        out[n++] = changed;
+        for (size_t j = 0; j < changed; j++, i++)
+            out[n++] = prev[i] ^ cur[i];
+    }
+
+    return n;
+}
+
+int delta_apply(uint8_t *buf, size_t bytes, const uint8_t *delta, size_t delta_bytes)
+{
+    size_t i = 0;
+
+    for (size_t in = 0; in < delta_bytes;) {
+        if (delta_bytes - in < 2)
+            return DELTA_FAIL;
+        size_t unchanged = delta[in++];
+        size_t changed = delta[in++];
+        if (i + unchanged + changed > bytes || delta_bytes - in < changed)
+            return DELTA_FAIL;
+
+        i += unchanged;
+        for (size_t j = 0; j < changed; j++)
+            buf[i++] ^= delta[in++];
+    }
+
+    return DELTA_SUCCESS;
+}
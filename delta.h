@@ -0,0 +1,30 @@
+#ifndef DELTA_H
+#define DELTA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * XOR deltas, run-length encoded
+ *
+ * Tokens: <unchanged bytes> <changed bytes> <changed bytes of XOR>, counts
+ * being a byte each. Trailing unchanged bytes are not encoded, so identical
+ * buffers encode to nothing. Applying a delta to either buffer gives the
+ * other one.
+ */
+
+/* Alternating single changed and unchanged bytes are the worst case */
+#define DELTA_MAX_ENCODED(bytes) ((bytes) * 3 / 2 + 2)
+
+enum delta_status {
+    DELTA_SUCCESS,
+    DELTA_FAIL,
+};
+
+/* Encode the delta between two buffers, the encoded length */
+size_t delta_encode(const uint8_t *prev, const uint8_t *cur, size_t bytes, uint8_t *out);
+
+/* Apply a delta to a buffer, DELTA_FAIL if it doesn't fit */
+int delta_apply(uint8_t *buf, size_t bytes, const uint8_t *delta, size_t delta_bytes);
+
+#endif /* DELTA_H */
@@ -0,0 +1,197 @@
+#include <stdio.h>
+
+#include "disasm.h"
+
+static const char *class_names[DISASM_CLASS_COUNT] = {
+    [DISASM_SYS] = "SYS addr",
+    [DISASM_CLS] = "CLS",
+    [DISASM_RET] = "RET",
+    [DISASM_JP] = "JP addr",
+    [DISASM_CALL] = "CALL addr",
+    [DISASM_SE_BYTE] = "SE Vx, byte",
+    [DISASM_SNE_BYTE] = "SNE Vx, byte",
+    [DISASM_SE_REG] = "SE Vx, Vy",
+    [DISASM_SAVE_RANGE] = "LD [I], Vx-Vy",
+    [DISASM_LOAD_RANGE] = "LD Vx-Vy, [I]",
+    [DISASM_LD_BYTE] = "LD Vx, byte",
+    [DISASM_ADD_BYTE] = "ADD Vx, byte",
+    [DISASM_LD_REG] = "LD Vx, Vy",
+    [DISASM_OR] = "OR Vx, Vy",
+    [DISASM_AND] = "AND Vx, Vy",
+    [DISASM_XOR] = "XOR Vx, Vy",
+    [DISASM_ADD_REG] = "ADD Vx, Vy",
+    [DISASM_SUB] = "SUB Vx, Vy",
+    [DISASM_SHR] = "SHR Vx",
+    [DISASM_SUBN] = "SUBN Vx, Vy",
+    [DISASM_SHL] = "SHL Vx",
+    [DISASM_SNE_REG] = "SNE Vx, Vy",
+    [DISASM_LD_I] = "LD I, addr",
+    [DISASM_JP_V0] = "JP V0, addr",
+    [DISASM_RND] = "RND Vx, byte",
+    [DISASM_DRW] = "DRW Vx, Vy, nibble",
+    [DISASM_SKP] = "SKP Vx",
+    [DISASM_SKNP] = "SKNP Vx",
+    [DISASM_LD_I_LONG] = "LD I, long",
+    [DISASM_PLANE] = "PLANE n",
+    [DISASM_AUDIO] = "AUDIO",
+    [DISASM_LD_VX_DT] = "LD Vx, DT",
+    [DISASM_LD_K] = "LD Vx, K",
+    [DISASM_LD_DT] = "LD DT, Vx",
+    [DISASM_LD_ST] = "LD ST, Vx",
+    [DISASM_ADD_I] = "ADD I, Vx",
+    [DISASM_LD_F] = "LD F, Vx",
+    [DISASM_LD_B] = "LD B, Vx",
+    [DISASM_PITCH] = "PITCH Vx",
+    [DISASM_LD_MEM] = "LD [I], Vx",
+    [DISASM_LD_REGS] = "LD Vx, [I]",
+    [DISASM_UNKNOWN] = "unknown",
+};
+
+enum disasm_class disasm_class(uint16_t instruction, enum chip8_mode mode)
+{
+    uint16_t type = (0xF000 & instruction) >> 12;
+    uint16_t nnn = (0x0FFF & instruction);
+    uint16_t kk = (0x00FF & instruction);
+    uint16_t n = (0x000F & instruction);
+    bool is_xochip = mode == CHIP8_MODE_XOCHIP;
+
+    switch (type) {
+    case 0x0:
+        if (nnn == 0x0e0)
+            return DISASM_CLS;
+        if (nnn == 0x0ee)
+            return DISASM_RET;
+        return DISASM_SYS;
+    case 0x1:
+        return DISASM_JP;
+    case 0x2:
+        return DISASM_CALL;
+    case 0x3:
+        return DISASM_SE_BYTE;
+    case 0x4:
+        return DISASM_SNE_BYTE;
+    case 0x5:
+        if (is_xochip && n == 0x2)
+            return DISASM_SAVE_RANGE;
+        if (is_xochip && n == 0x3)
+            return DISASM_LOAD_RANGE;
+        return DISASM_SE_REG;
+    case 0x6:
+        return DISASM_LD_BYTE;
+    case 0x7:
+        return DISASM_ADD_BYTE;
+    case 0x8:
+        switch (n) {
+        case 0x0: return DISASM_LD_REG;
+        case 0x1: return DISASM_OR;
+        case 0x2: return DISASM_AND;
+        case 0x3: return DISASM_XOR;
+        case 0x4: return DISASM_ADD_REG;
+        case 0x5: return DISASM_SUB;
+        case 0x6: return DISASM_SHR;
+        case 0x7: return DISASM_SUBN;
+        case 0xe: return DISASM_SHL;
+        default: return DISASM_UNKNOWN;
+        }
+    case 0x9:
+        return DISASM_SNE_REG;
+    case 0xa:
+        return DISASM_LD_I;
+    case 0xb:
+        return DISASM_JP_V0;
+    case 0xc:
+        return DISASM_RND;
+    case 0xd:
+        return DISASM_DRW;
+    case 0xe:
+        if (kk == 0x9e)
+            return DISASM_SKP;
+        if (kk == 0xa1)
+            return DISASM_SKNP;
+        return DISASM_UNKNOWN;
+    case 0xf:
+        if (is_xochip) {
+            if (instruction == 0xf000)
+                return DISASM_LD_I_LONG;
+            if (kk == 0x01)
+                return DISASM_PLANE;
+            if (instruction == 0xf002)
+                return DISASM_AUDIO;
+            if (kk == 0x3a)
+                return DISASM_PITCH;
+        }
+        switch (kk) {
+        case 0x07: return DISASM_LD_VX_DT;
+        case 0x0a: return DISASM_LD_K;
+        case 0x15: return DISASM_LD_DT;
+        case 0x18: return DISASM_LD_ST;
+        case 0x1e: return DISASM_ADD_I;
+        case 0x29: return DISASM_LD_F;
+        case 0x33: return DISASM_LD_B;
+        case 0x55: return DISASM_LD_MEM;
+        case 0x65: return DISASM_LD_REGS;
+        default: return DISASM_UNKNOWN;
+        }
+    }
+
+    return DISASM_UNKNOWN;
+}
+
+const char *disasm_class_name(enum disasm_class cls)
+{
+    return cls < DISASM_CLASS_COUNT ? class_names[cls] : class_names[DISASM_UNKNOWN];
+}
+
+void disasm_format(uint16_t instruction, enum chip8_mode mode, char *buf, size_t size)
+{
+    unsigned x = (0x0F00 & instruction) >> 8;
+    unsigned y = (0x00F0 & instruction) >> 4;
+    unsigned nnn = (0x0FFF & instruction);
+    unsigned kk = (0x00FF & instruction);
+    unsigned n = (0x000F & instruction);
+
+    switch (disasm_class(instruction, mode)) {
+    case DISASM_SYS: snprintf(buf, size, "SYS 0x%.3X", nnn); break;
+    case DISASM_CLS: snprintf(buf, size, "CLS"); break;
+    case DISASM_RET: snprintf(buf, size, "RET"); break;
+    case DISASM_JP: snprintf(buf, size, "JP 0x%.3X", nnn); break;
+    case DISASM_CALL: snprintf(buf, size, "CALL 0x%.3X", nnn); break;
+    case DISASM_SE_BYTE: snprintf(buf, size, "SE V%X, 0x%.2X", x, kk); break;
+    case DISASM_SNE_BYTE: snprintf(buf, size, "SNE V%X, 0x%.2X", x, kk); break;
+    case DISASM_SE_REG: snprintf(buf, size, "SE V%X, V%X", x, y); break;
+    case DISASM_SAVE_RANGE: snprintf(buf, size, "LD [I], V%X-V%X", x, y); break;
+    case DISASM_LOAD_RANGE: snprintf(buf, size, "LD V%X-V%X, [I]", x, y); break;
+    case DISASM_LD_BYTE: snprintf(buf, size, "LD V%X, 0x%.2X", x, kk); break;
+    case DISASM_ADD_BYTE: snprintf(buf, size, "ADD V%X, 0x%.2X", x, kk); break;
+    case DISASM_LD_REG: snprintf(buf, size, "LD V%X, V%X", x, y); break;
+    case DISASM_OR: snprintf(buf, size, "OR V%X, V%X", x, y); break;
+    case DISASM_AND: snprintf(buf, size, "AND V%X, V%X", x, y); break;
+    case DISASM_XOR: snprintf(buf, size, "XOR V%X, V%X", x, y); break;
+    case DISASM_ADD_REG: snprintf(buf, size, "ADD V%X, V%X", x, y); break;
+    case DISASM_SUB: snprintf(buf, size, "SUB V%X, V%X", x, y); break;
+    case DISASM_SHR: snprintf(buf, size, "SHR V%X", x); break;
+    case DISASM_SUBN: snprintf(buf, size, "SUBN V%X, V%X", x, y); break;
+    case DISASM_SHL: snprintf(buf, size, "SHL V%X", x); break;
+    case DISASM_SNE_REG: snprintf(buf, size, "SNE V%X, V%X", x, y); break;
+    case DISASM_LD_I: snprintf(buf, size, "LD I, 0x%.3X", nnn); break;
+    case DISASM_JP_V0: snprintf(buf, size, "JP V0, 0x%.3X", nnn); break;
+    case DISASM_RND: snprintf(buf, size, "RND V%X, 0x%.2X", x, kk); break;
+    case DISASM_DRW: snprintf(buf, size, "DRW V%X, V%X, %u", x, y, n); break;
+    case DISASM_SKP: snprintf(buf, size, "SKP V%X", x); break;
+    case DISASM_SKNP: snprintf(buf, size, "SKNP V%X", x); break;
+    case DISASM_LD_I_LONG: snprintf(buf, size, "LD I, long"); break;
+    case DISASM_PLANE: snprintf(buf, size, "PLANE %u", x); break;
+    case DISASM_AUDIO: snprintf(buf, size, "AUDIO"); break;
+    case DISASM_LD_VX_DT: snprintf(buf, size, "LD V%X, DT", x); break;
+    case DISASM_LD_K: snprintf(buf, size, "LD V%X, K", x); break;
+    case DISASM_LD_DT: snprintf(buf, size, "LD DT, V%X", x); break;
+    case DISASM_LD_ST: snprintf(buf, size, "LD ST, V%X", x); break;
+    case DISASM_ADD_I: snprintf(buf, size, "ADD I, V%X", x); break;
+    case DISASM_LD_F: snprintf(buf, size, "LD F, V%X", x); break;
+    case DISASM_LD_B: snprintf(buf, size, "LD B, V%X", x); break;
+    case DISASM_PITCH: snprintf(buf, size, "PITCH V%X", x); break;
+    case DISASM_LD_MEM: snprintf(buf, size, "LD [I], V%X", x); break;
+    case DISASM_LD_REGS: snprintf(buf, size, "LD V%X, [I]", x); break;
+    default: snprintf(buf, size, "DW 0x%.4X", instruction); break;
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef DISASM_H
+#define DISASM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "chip8.h"
+
+#define DISASM_MAX_SIZE 32      /* Enough for any formatted instruction */
+
+enum disasm_class {
+    DISASM_SYS,
+    DISASM_CLS,
+    DISASM_RET,
+    DISASM_JP,
+    DISASM_CALL,
+    DISASM_SE_BYTE,
+    DISASM_SNE_BYTE,
+    DISASM_SE_REG,
+    DISASM_SAVE_RANGE,          /* XO-CHIP */
+    DISASM_LOAD_RANGE,          /* XO-CHIP */
+    DISASM_LD_BYTE,
+    DISASM_ADD_BYTE,
+    DISASM_LD_REG,
+    DISASM_OR,
+    DISASM_AND,
+    DISASM_XOR,
+    DISASM_ADD_REG,
+    DISASM_SUB,
+    DISASM_SHR,
+    DISASM_SUBN,
+    DISASM_SHL,
+    DISASM_SNE_REG,
+    DISASM_LD_I,
+    DISASM_JP_V0,
+    DISASM_RND,
+    DISASM_DRW,
+    DISASM_SKP,
+    DISASM_SKNP,
+    DISASM_LD_I_LONG,           /* XO-CHIP */
+    DISASM_PLANE,               /* XO-CHIP */
+    DISASM_AUDIO,               /* XO-CHIP */
+    DISASM_LD_VX_DT,
+    DISASM_LD_K,
+    DISASM_LD_DT,
+    DISASM_LD_ST,
+    DISASM_ADD_I,
+    DISASM_LD_F,
+    DISASM_LD_B,
+    DISASM_PITCH,               /* XO-CHIP */
+    DISASM_LD_MEM,
+    DISASM_LD_REGS,
+    DISASM_UNKNOWN,
+
+    DISASM_CLASS_COUNT
+};
+
+/* Classify an instruction the same way chip8_exec() decodes it */
+enum disasm_class disasm_class(uint16_t instruction, enum chip8_mode mode);
+
+const char *disasm_class_name(enum disasm_class cls);
+
+/* Format an instruction as assembly, e.g. "ADD V1, V2" */
+void disasm_format(uint16_t instruction, enum chip8_mode mode, char *buf, size_t size);
+
+#endif /* DISASM_H */
@@ -0,0 +1,50 @@
+#include "fast-forward.h"
+
+void fast_forward_init(fast_forward *ff, uint32_t speed, uint64_t usec_now)
+{
+    *ff = (fast_forward){
+        .speed = speed,
+        .usec_tick_start = usec_now,
+        .usec_next_present = usec_now,
+        .usec_window_start = usec_now,
+        .effective_speed = 1.0,
+    };
+}
+
+void fast_forward_begin_tick(fast_forward *ff, uint64_t usec_now)
+{
+    ff->usec_tick_start = usec_now;
+}
+
+bool fast_forward_is_frame_due(const fast_forward *ff, uint32_t frames_run, uint64_t usec_now)
+{
+    if (!frames_run)
+        return true;
+    if (!ff->is_on)
+        return false;
+    if (ff->speed != FAST_FORWARD_UNLIMITED && frames_run >= ff->speed)
+        return false;
+    return usec_now - ff->usec_tick_start < FAST_FORWARD_USEC_BUDGET;
+}
+
+bool fast_forward_end_tick(fast_forward *ff, uint32_t frames_run, uint64_t usec_now)
+{
+    ff->window_frames += frames_run;
+    uint64_t usec_window = usec_now - ff->usec_window_start;
+    if (usec_window >= FAST_FORWARD_USEC_SPEED_WINDOW) {
+        ff->effective_speed = (double)ff->window_frames * USECONDS_PER_STEP_TIMER / usec_window;
+        ff->usec_window_start = usec_now;
+        ff->window_frames = 0;
+    }
+
+    bool is_due = !ff->is_on || usec_now >= ff->usec_next_present;
+    ff->skipped_frames += frames_run - is_due;
+    return is_due;
+}
+
+void fast_forward_presented(fast_forward *ff, uint64_t usec_start, uint64_t usec_end)
+{
+    uint64_t cost = usec_end - usec_start;
+    ff->usec_present_cost = (ff->usec_present_cost * 7 + cost) / 8;
+    ff->usec_next_present = usec_end + ff->usec_present_cost;
+}
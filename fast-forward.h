@@ -0,0 +1,62 @@
+#ifndef FAST_FORWARD_H
+#define FAST_FORWARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "chip8.h"
+
+/*
+ * Fast-forward scheduling
+ *
+ * The host loop wakes up every 60Hz tick. Normally a tick is a single frame,
+ * fast-forwarding runs speed frames per tick or as many as fit into the
+ * emulation share of the tick, and presents a frame only once the output is
+ * done with the previous one: the next frame is due no earlier than the
+ * time the last one took to present, averaged.
+ */
+
+/* Frames per tick, FAST_FORWARD_UNLIMITED meaning as many as fit */
+#define FAST_FORWARD_UNLIMITED 0
+#define FAST_FORWARD_MAX_SPEED 64
+
+/* Emulation share of a tick, the rest is for presenting and input */
+#define FAST_FORWARD_USEC_BUDGET (USECONDS_PER_STEP_TIMER * 3 / 4)
+
+/* Effective speed is measured over this much wall time */
+#define FAST_FORWARD_USEC_SPEED_WINDOW USECONDS_PER_SECOND
+
+typedef struct fast_forward {
+    uint32_t speed;
+    bool is_on;
+
+    uint64_t usec_tick_start;
+
+    /* Moving average of presenting a frame */
+    uint64_t usec_present_cost;
+    uint64_t usec_next_present;
+
+    /* Frames run and never presented */
+    uint64_t skipped_frames;
+
+    /* Emulated frames per nominal frame over the last window */
+    uint64_t usec_window_start;
+    uint64_t window_frames;
+    double effective_speed;
+} fast_forward;
+
+void fast_forward_init(fast_forward *ff, uint32_t speed, uint64_t usec_now);
+
+void fast_forward_begin_tick(fast_forward *ff, uint64_t usec_now);
+
+/* Whether to run another frame this tick, frames_run so far */
+bool fast_forward_is_frame_due(const fast_forward *ff, uint32_t frames_run, uint64_t usec_now);
+
+/* Account for the frames run this tick, true if the last one should be
+ * presented */
+bool fast_forward_end_tick(fast_forward *ff, uint32_t frames_run, uint64_t usec_now);
+
+/* Presenting took from usec_start to usec_end */
+void fast_forward_presented(fast_forward *ff, uint64_t usec_start, uint64_t usec_end);
+
+#endif /* FAST_FORWARD_H */
@@ -4,14 +4,77 @@
 #include <string.h>
 #include <unistd.h>
 #include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 
 #include "fb-console.h"
 
+/* Borders, rows, the keypad and a status line */
+#define FB_OUTPUT_STATUS_BYTES 128
+#define FB_OUTPUT_MAX_BYTES \
+    (2 + (FRAMEBUF_WIDTH + 3) * (FRAMEBUF_MAX_HEIGHT + 2) + 5 * 4 + FB_OUTPUT_STATUS_BYTES)
+
+/* Hires frames never hash the same as lores ones */
+#define FB_HIRES_FRAME_HASH 0x5851f42d4c957f2dull
+
+struct fb_output {
+    int fd;
+    /* fd is a non-blocking descriptor of our own, stdout otherwise */
+    bool is_own_fd;
+
+    /* The frame being written out */
+    char buf[FB_OUTPUT_MAX_BYTES];
+    size_t bytes;
+    size_t sent;
+
+    /* A frame is waiting for the terminal to take the previous one */
+    bool is_waiting;
+
+    char status[FB_OUTPUT_STATUS_BYTES];
+
+    fb_output_counters counters;
+};
+
+/* Stdout opened again, non-blocking. Its own file description keeps
+ * O_NONBLOCK away from stderr and stdin, which usually share stdout's, and
+ * from the shell if we crash. -1 for regular files, they never block and
+ * reopening would lose the offset, and where reopening isn't possible. */
+static int open_output(void)
+{
+    struct stat st;
+    if (fstat(STDOUT_FILENO, &st) == -1 || S_ISREG(st.st_mode))
+        return -1;
+
+    return open("/proc/self/fd/1", O_WRONLY | O_NONBLOCK | O_NOCTTY | O_CLOEXEC);
+}
+
 int fb_new(fb_console **fb)
 {
     *fb = calloc(1, sizeof(**fb));
+    if (!*fb) {
+        fprintf(stderr, "Calloc failure\n");
+        return FB_CONSOLE_FAIL;
+    }
+
+    **fb = (typeof(**fb)){ .planes = 0x1, .height = FRAMEBUF_LORES_HEIGHT, .is_dirty = true };
 
-    **fb = (typeof(**fb)){ .is_dirty = true };
+    fb_output *out = calloc(1, sizeof(*out));
+    if (!out) {
+        fprintf(stderr, "Calloc failure\n");
+        return FB_CONSOLE_FAIL;
+    }
+    (*fb)->out = out;
+
+    /* A slow terminal drops frames instead of stalling the emulator */
+    out->fd = open_output();
+    out->is_own_fd = out->fd != -1;
+    if (!out->is_own_fd)
+        out->fd = STDOUT_FILENO;
+
+    /* Nothing to set up when running headless */
+    if (!isatty(fileno(stdin)))
+        return FB_CONSOLE_SUCCESS;
 
     struct termios orig_term_attr;
     struct termios new_term_attr;
@@ -35,105 +98,364 @@ int fb_new(fb_console **fb)
     return FB_CONSOLE_SUCCESS;
 }
 
+int fb_new_headless(fb_console **fb)
+{
+    *fb = calloc(1, sizeof(**fb));
+    if (!*fb) {
+        fprintf(stderr, "Calloc failure\n");
+        return FB_CONSOLE_FAIL;
+    }
+
+    fb_init_headless(*fb);
+
+    return FB_CONSOLE_SUCCESS;
+}
+
+void fb_init_headless(fb_console *fb)
+{
+    *fb = (fb_console){ .planes = 0x1, .height = FRAMEBUF_LORES_HEIGHT, .is_dirty = true };
+}
+
 void fb_free(fb_console *fb)
 {
     if (!fb)
         return;
+
+    fb_output *out = fb->out;
+    if (out) {
+        /* The last frame goes out whole */
+        int flags = out->is_own_fd ? fcntl(out->fd, F_GETFL) : -1;
+        if (flags != -1)
+            fcntl(out->fd, F_SETFL, flags & ~O_NONBLOCK);
+        while (out->sent < out->bytes) {
+            ssize_t n = write(out->fd, out->buf + out->sent, out->bytes - out->sent);
+            if (n <= 0 && errno != EINTR)
+                break;
+            if (n > 0)
+                out->sent += n;
+        }
+        if (out->is_own_fd)
+            close(out->fd);
+    }
+
+    free(out);
     free(fb);
 }
 
-void fb_draw_sprite(fb_console *fb, uint8_t *source, uint8_t bytes, uint8_t x, uint8_t y, bool *is_pixel_erased)
+/* Rows are mixed with their position so that moving a row changes the frame
+ * hash, blank rows hash to 0 wherever they are */
+static uint64_t hash_row(const fb_console *fb, size_t y)
 {
-    assert(bytes <= SPRITE_MAX_SIZE);
+    uint64_t h = (y + 1) * 0x9e3779b97f4a7c15ull;
+    fb_row any = 0;
 
-    *is_pixel_erased = false;
+    for (size_t plane = 0; plane < FRAMEBUF_PLANES; plane++) {
+        fb_row row = fb->fb[plane][y];
+        any |= row;
+        h = (h ^ row) * 0xbf58476d1ce4e5b9ull;
+        h ^= h >> 29;
+    }
 
-    for (size_t byt = 0; byt < bytes; byt++ ) {
-        for (size_t bt = 0; bt < 8; bt++) {
-            /* make sure sprites wrap around */
-            uint8_t target_y = (y + byt) % FRAMEBUF_HEIGHT;
-            uint8_t target_x = (x + (7u - bt)) % FRAMEBUF_WIDTH;
+    /* splitmix64 finalizer */
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+    h ^= h >> 31;
+
+    return any ? h : 0;
+}
+
+static void update_rows(fb_console *fb, fb_row_mask rows)
+{
+    for (; rows; rows &= rows - 1) {
+        size_t y = __builtin_ctzll(rows);
+        uint64_t h = hash_row(fb, y);
+        if (h == fb->row_hashes[y])
+            continue;
+        fb->frame_hash ^= fb->row_hashes[y] ^ h;
+        fb->row_hashes[y] = h;
+        fb->dirty_rows |= (fb_row_mask)1 << y;
+    }
+}
+
+static inline fb_row ror_row(fb_row row, uint8_t x)
+{
+    x %= FRAMEBUF_WIDTH;
+    return x ? (row >> x) | (row << (FRAMEBUF_WIDTH - x)) : row;
+}
+
+/* XOR a sprite row placed at the leftmost pixel onto the screen. Rotating
+ * makes sprites wrap around horizontally, shifting clips whatever is past the
+ * right edge. */
+static inline bool xor_row(fb_row *target, fb_row sprite_row, uint8_t x, bool is_clipped)
+{
+    fb_row sprite = is_clipped ? sprite_row >> (x % FRAMEBUF_WIDTH) : ror_row(sprite_row, x);
+    bool is_pixel_erased = (*target & sprite) != 0;
+    *target ^= sprite;
+    return is_pixel_erased;
+}
+
+/* Sprite rows are width bits (8 or 16) wide, with constant arguments every
+ * caller gets its own copy with no clipping checks left and wrapping at a
+ * constant height */
+static inline __attribute__((always_inline))
+void draw(fb_console *fb, uint8_t *source, uint8_t lines, uint8_t width, uint8_t x, uint8_t y,
+          bool is_clipped, uint8_t height, bool *is_pixel_erased)
+{
+    uint8_t line_bytes = width / 8;
+    y %= height;
 
-            /* get the final pixel index */
-            size_t fb_idx = target_y * FRAMEBUF_WIDTH + target_x;
+    *is_pixel_erased = false;
 
-            /* XOR the pixel onto the screen */
-            uint8_t sprite_pixel = !!(source[byt] & (1 << bt));
-            uint8_t target_pixel = !!(fb->fb[fb_idx]);
-            fb->fb[fb_idx] = sprite_pixel ^ target_pixel;
+    fb_row_mask touched = 0;
+    for (size_t plane = 0; plane < FRAMEBUF_PLANES; plane++) {
+        if (!(fb->planes & (1u << plane)))
+            continue;
 
-            /* Check if a pixel was erased */
-            if (target_pixel && !fb->fb[fb_idx])
-                *is_pixel_erased = true;
+        fb_row *rows = fb->fb[plane];
+        for (size_t line = 0; line < lines; line++) {
+            if (is_clipped && y + line >= height)
+                break;
+            /* make sure sprites wrap around */
+            uint8_t target_y = (y + line) % height;
+            uint16_t line_bits = source[line_bytes * line];
+            if (width == 16)
+                line_bits = (line_bits << 8) | source[line_bytes * line + 1];
+            fb_row sprite_row = (fb_row)line_bits << (FRAMEBUF_WIDTH - width);
+            *is_pixel_erased |= xor_row(&rows[target_y], sprite_row, x, is_clipped);
+            touched |= (fb_row_mask)1 << target_y;
         }
+        source += lines * line_bytes;
     }
+    update_rows(fb, touched);
 
     fb->is_dirty = true;
 }
 
-void fb_redraw(fb_console *fb, bool keyboard_state[CHIP8_KEY_COUNT])
+void fb_draw_sprite(fb_console *fb, uint8_t *source, uint8_t bytes, uint8_t x, uint8_t y, bool *is_pixel_erased)
 {
-    if (!fb->is_dirty)
+    assert(bytes <= SPRITE_MAX_SIZE);
+    if (fb->height == FRAMEBUF_LORES_HEIGHT)
+        draw(fb, source, bytes, 8, x, y, false, FRAMEBUF_LORES_HEIGHT, is_pixel_erased);
+    else
+        draw(fb, source, bytes, 8, x, y, false, FRAMEBUF_HIRES_HEIGHT, is_pixel_erased);
+}
+
+void fb_draw_sprite16(fb_console *fb, uint8_t *source, uint8_t x, uint8_t y, bool *is_pixel_erased)
+{
+    if (fb->height == FRAMEBUF_LORES_HEIGHT)
+        draw(fb, source, 16, 16, x, y, false, FRAMEBUF_LORES_HEIGHT, is_pixel_erased);
+    else
+        draw(fb, source, 16, 16, x, y, false, FRAMEBUF_HIRES_HEIGHT, is_pixel_erased);
+}
+
+void fb_draw_sprite_clipped(fb_console *fb, uint8_t *source, uint8_t bytes, uint8_t x, uint8_t y, bool *is_pixel_erased)
+{
+    assert(bytes <= SPRITE_MAX_SIZE);
+    if (fb->height == FRAMEBUF_LORES_HEIGHT)
+        draw(fb, source, bytes, 8, x, y, true, FRAMEBUF_LORES_HEIGHT, is_pixel_erased);
+    else
+        draw(fb, source, bytes, 8, x, y, true, FRAMEBUF_HIRES_HEIGHT, is_pixel_erased);
+}
+
+void fb_draw_sprite16_clipped(fb_console *fb, uint8_t *source, uint8_t x, uint8_t y, bool *is_pixel_erased)
+{
+    if (fb->height == FRAMEBUF_LORES_HEIGHT)
+        draw(fb, source, 16, 16, x, y, true, FRAMEBUF_LORES_HEIGHT, is_pixel_erased);
+    else
+        draw(fb, source, 16, 16, x, y, true, FRAMEBUF_HIRES_HEIGHT, is_pixel_erased);
+}
+
+void fb_select_planes(fb_console *fb, uint8_t planes)
+{
+    fb->planes = planes & FRAMEBUF_PLANE_MASK;
+}
+
+void fb_set_hires(fb_console *fb, bool is_hires)
+{
+    uint8_t height = is_hires ? FRAMEBUF_HIRES_HEIGHT : FRAMEBUF_LORES_HEIGHT;
+    if (fb->height == height)
         return;
-    fb->is_dirty = false;
+
+    /* Every plane, rows past the old height included */
+    memset(fb->fb, 0, sizeof(fb->fb));
+    memset(fb->row_hashes, 0, sizeof(fb->row_hashes));
+    fb->height = height;
+    fb->frame_hash = is_hires ? FB_HIRES_FRAME_HASH : 0;
+    fb->dirty_rows = FRAMEBUF_ALL_ROWS(height);
+    fb->is_dirty = true;
+}
+
+/* Rows are height, a constant in every caller */
+static inline __attribute__((always_inline))
+size_t render_frame(const fb_console *fb, const bool keyboard_state[CHIP8_KEY_COUNT], char *buf,
+                    uint8_t height)
+{
+    char *p = buf;
 
     /* Clear screen */
-    write(fileno(stdout), "\033c", 3);
+    *p++ = '\033';
+    *p++ = 'c';
 
-    putchar('*');
-    for (size_t y = 0; y < FRAMEBUF_WIDTH; y++)
-        putchar('-');
-    putchar('*');
-    putchar('\n');
+    *p++ = '*';
+    memset(p, '-', FRAMEBUF_WIDTH);
+    p += FRAMEBUF_WIDTH;
+    *p++ = '*';
+    *p++ = '\n';
 
-    for (size_t y = 0; y < FRAMEBUF_HEIGHT; y++) {
-        putchar('|');
+    /* Plane 0 only pixels look like plain CHIP-8 ones */
+    static const char pixel_chars[1 << FRAMEBUF_PLANES] = { ' ', '0', '+', '#' };
+
+    for (size_t y = 0; y < height; y++) {
+        *p++ = '|';
         for (size_t x = 0; x < FRAMEBUF_WIDTH; x++) {
-            size_t idx = y * FRAMEBUF_WIDTH + x;
-            uint8_t pixel = fb->fb[idx];
-            if (pixel)
-                putchar('0');
-            else
-                putchar(' ');
+            unsigned bit = FRAMEBUF_WIDTH - 1 - x;
+            unsigned pixel = 0;
+            for (size_t plane = 0; plane < FRAMEBUF_PLANES; plane++)
+                pixel |= ((fb->fb[plane][y] >> bit) & 0x1) << plane;
+            *p++ = pixel_chars[pixel];
+        }
+        *p++ = '|';
+        *p++ = '\n';
+    }
+    *p++ = '*';
+    memset(p, '-', FRAMEBUF_WIDTH);
+    p += FRAMEBUF_WIDTH;
+    *p++ = '*';
+    *p++ = '\n';
+
+    /* Keypad layout, pressed keys are shown */
+    static const uint8_t keypad[4][4] = {
+        { 0x1, 0x2, 0x3, 0xC },
+        { 0x4, 0x5, 0x6, 0xD },
+        { 0x7, 0x8, 0x9, 0xE },
+        { 0xA, 0x0, 0xB, 0xF },
+    };
+    for (size_t row = 0; row < 4; row++) {
+        for (size_t col = 0; col < 4; col++) {
+            uint8_t key = keypad[row][col];
+            *p++ = keyboard_state[key] ? "0123456789ABCDEF"[key] : ' ';
+        }
+        *p++ = '\n';
+    }
+
+    size_t status_bytes = strlen(fb->out->status);
+    if (status_bytes) {
+        memcpy(p, fb->out->status, status_bytes);
+        p += status_bytes;
+        *p++ = '\n';
+    }
+
+    return p - buf;
+}
+
+static size_t render(const fb_console *fb, const bool keyboard_state[CHIP8_KEY_COUNT], char *buf)
+{
+    if (fb->height == FRAMEBUF_LORES_HEIGHT)
+        return render_frame(fb, keyboard_state, buf, FRAMEBUF_LORES_HEIGHT);
+    return render_frame(fb, keyboard_state, buf, FRAMEBUF_HIRES_HEIGHT);
+}
+
+/* Write as much as the terminal takes, true once nothing is left */
+static bool flush(fb_output *out)
+{
+    while (out->sent < out->bytes) {
+        ssize_t n = write(out->fd, out->buf + out->sent, out->bytes - out->sent);
+        if (n > 0) {
+            out->sent += n;
+        } else if (n == -1 && errno == EINTR) {
+            continue;
+        } else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            out->counters.writes_blocked++;
+            return false;
+        } else {
+            /* Nowhere to write to, the frame is lost */
+            break;
         }
-        putchar('|');
-        putchar('\n');
-    }
-    putchar('*');
-    for (size_t y = 0; y < FRAMEBUF_WIDTH; y++)
-        putchar('-');
-    putchar('*');
-    putchar('\n');
-
-    /* TODO: cleaner  */
-    if (keyboard_state[0x1]) printf("%.1X", 0x1); else printf(" ");
-    if (keyboard_state[0x2]) printf("%.1X", 0x2); else printf(" ");
-    if (keyboard_state[0x3]) printf("%.1X", 0x3); else printf(" ");
-    if (keyboard_state[0xC]) printf("%.1X", 0xC); else printf(" ");
-    putchar('\n');
-    if (keyboard_state[0x4]) printf("%.1X", 0x4); else printf(" ");
-    if (keyboard_state[0x5]) printf("%.1X", 0x5); else printf(" ");
-    if (keyboard_state[0x6]) printf("%.1X", 0x6); else printf(" ");
-    if (keyboard_state[0xD]) printf("%.1X", 0xD); else printf(" ");
-    putchar('\n');
-    if (keyboard_state[0x7]) printf("%.1X", 0x7); else printf(" ");
-    if (keyboard_state[0x8]) printf("%.1X", 0x8); else printf(" ");
-    if (keyboard_state[0x9]) printf("%.1X", 0x9); else printf(" ");
-    if (keyboard_state[0xE]) printf("%.1X", 0xE); else printf(" ");
-    putchar('\n');
-    if (keyboard_state[0xA]) printf("%.1X", 0xA); else printf(" ");
-    if (keyboard_state[0x0]) printf("%.1X", 0x0); else printf(" ");
-    if (keyboard_state[0xB]) printf("%.1X", 0xB); else printf(" ");
-    if (keyboard_state[0xF]) printf("%.1X", 0xF); else printf(" ");
-    putchar('\n');
-
-    fb->is_dirty = false;
+    }
+
+    if (out->bytes && out->sent == out->bytes)
+        out->counters.frames_written++;
+    out->bytes = out->sent = 0;
+    return true;
+}
+
+bool fb_redraw(fb_console *fb, bool keyboard_state[CHIP8_KEY_COUNT])
+{
+    fb_output *out = fb->out;
+    if (!out) {
+        bool is_dirty = fb->is_dirty;
+        fb->is_dirty = false;
+        return is_dirty;
+    }
+
+    uint64_t frames_written = out->counters.frames_written;
+    bool is_idle = flush(out);
+
+    if (fb->is_dirty) {
+        /* The one waiting is never going to be seen */
+        if (out->is_waiting)
+            out->counters.frames_dropped++;
+        out->is_waiting = true;
+        fb->is_dirty = false;
+    }
+
+    /* Always the latest frame, once the terminal is done with the previous
+     * one */
+    if (is_idle && out->is_waiting) {
+        out->bytes = render(fb, keyboard_state, out->buf);
+        out->is_waiting = false;
+        flush(out);
+    }
+
+    return out->counters.frames_written != frames_written;
+}
+
+void fb_set_status(fb_console *fb, const char *status)
+{
+    if (!fb->out)
+        return;
+    snprintf(fb->out->status, sizeof(fb->out->status), "%s", status ? status : "");
+}
+
+void fb_get_output_counters(const fb_console *fb, fb_output_counters *counters)
+{
+    *counters = fb->out ? fb->out->counters : (fb_output_counters){0};
 }
 
 
 void fb_clear(fb_console *fb)
 {
-    memset(fb->fb, 0, FRAMEBUF_SIZE);
+    for (size_t plane = 0; plane < FRAMEBUF_PLANES; plane++)
+        if (fb->planes & (1u << plane))
+            memset(fb->fb[plane], 0, fb->height * sizeof(fb_row));
+    update_rows(fb, FRAMEBUF_ALL_ROWS(fb->height));
 
     fb->is_dirty = true;
 }
+
+void fb_load(fb_console *fb, const void *saved)
+{
+    uint64_t row_hashes[FRAMEBUF_MAX_HEIGHT];
+    memcpy(row_hashes, fb->row_hashes, sizeof(row_hashes));
+    fb_row_mask dirty_rows = fb->dirty_rows;
+    uint8_t height = fb->height;
+    fb_output *out = fb->out;
+
+    memcpy(fb, saved, sizeof(*fb));
+    fb->out = out;
+
+    if (fb->height != height)
+        dirty_rows |= FRAMEBUF_ALL_ROWS(fb->height);
+    for (size_t y = 0; y < FRAMEBUF_MAX_HEIGHT; y++)
+        if (fb->row_hashes[y] != row_hashes[y])
+            dirty_rows |= (fb_row_mask)1 << y;
+    fb->dirty_rows = dirty_rows;
+    fb->is_dirty = true;
+}
+
+fb_row_mask fb_take_dirty_rows(fb_console *fb)
+{
+    fb_row_mask rows = fb->dirty_rows;
+    fb->dirty_rows = 0;
+    return rows;
+}
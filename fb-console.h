@@ -3,36 +3,127 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <assert.h>
 #include "common.h"
 
-#define FRAMEBUF_HEIGHT 32u
+/* 64x32 normally, 64x64 for COSMAC VIP two-page hires programs */
 #define FRAMEBUF_WIDTH 64u
-#define FRAMEBUF_SIZE (FRAMEBUF_HEIGHT * FRAMEBUF_WIDTH)
+#define FRAMEBUF_LORES_HEIGHT 32u
+#define FRAMEBUF_HIRES_HEIGHT 64u
+#define FRAMEBUF_MAX_HEIGHT FRAMEBUF_HIRES_HEIGHT
 #define SPRITE_MAX_SIZE 15
 
+/* XO-CHIP has 2 bitplanes, plain CHIP-8 only ever draws on the first one */
+#define FRAMEBUF_PLANES 2
+#define FRAMEBUF_PLANE_MASK ((1u << FRAMEBUF_PLANES) - 1)
+
+/* A row is packed into a single word, MSB being the leftmost pixel */
+typedef uint64_t fb_row;
+static_assert(FRAMEBUF_WIDTH == 8 * sizeof(fb_row),
+              "A framebuffer row is expected to fit a word exactly");
+
+/* Bit N for row N */
+typedef uint64_t fb_row_mask;
+static_assert(FRAMEBUF_MAX_HEIGHT <= 8 * sizeof(fb_row_mask),
+              "Every framebuffer row is expected to have a dirty bit");
+#define FRAMEBUF_ALL_ROWS(height) (~(fb_row_mask)0 >> (8 * sizeof(fb_row_mask) - (height)))
+
 enum fb_console_status {
     FB_CONSOLE_SUCCESS,
     FB_CONSOLE_FAIL,
 };
 
+/* Terminal output, see fb_redraw() */
+typedef struct fb_output fb_output;
+
+typedef struct fb_output_counters {
+    uint64_t frames_written;
+    /* Frames replaced by a newer one before the terminal took them */
+    uint64_t frames_dropped;
+    /* Writes cut short by a full terminal */
+    uint64_t writes_blocked;
+} fb_output_counters;
+
 typedef struct fb_console {
-    /* Framebuffer, previous and new */
-    uint8_t fb[FRAMEBUF_SIZE];
-    uint8_t fb_old[FRAMEBUF_SIZE];
+    /* Framebuffer, one packed row array per plane, height rows in use */
+    fb_row fb[FRAMEBUF_PLANES][FRAMEBUF_MAX_HEIGHT];
+    uint8_t height;
+
+    /* Planes affected by drawing and clearing, bit N for plane N */
+    uint8_t planes;
 
     bool is_dirty;
 
+    /* Hashes of rows across all planes, kept up to date by drawing and
+     * clearing. A blank row hashes to 0. The frame hash is all of them
+     * XORed together. */
+    uint64_t row_hashes[FRAMEBUF_MAX_HEIGHT];
+    uint64_t frame_hash;
+
+    /* Rows changed since the last fb_take_dirty_rows() */
+    fb_row_mask dirty_rows;
+
+    /* NULL when headless */
+    fb_output *out;
+
 } fb_console;
 
 int fb_new(fb_console **fb);
 
+/* A framebuffer that never touches the terminal, for embedding */
+int fb_new_headless(fb_console **fb);
+
+/* fb_new_headless() in place, for framebuffers allocated by the caller. Not to
+ * be fb_free()d. */
+void fb_init_headless(fb_console *fb);
+
 void fb_free(fb_console *fb);
 
+/* Draw an 8-pixel wide sprite on every selected plane, sprite data for the
+ * planes follows one another in source */
 void fb_draw_sprite(fb_console *fb, uint8_t *source, uint8_t bytes, uint8_t x, uint8_t y, bool *is_pixel_erased);
 
-/* TODO: bad naming, should be something like refresh */
-void fb_redraw(fb_console *fb, bool keyboard_state[16]);
+/* Draw a 16x16 sprite (XO-CHIP DXY0), 32 bytes per selected plane */
+void fb_draw_sprite16(fb_console *fb, uint8_t *source, uint8_t x, uint8_t y, bool *is_pixel_erased);
+
+/* Same as above, except that sprites are clipped at the screen edges instead
+ * of wrapping around. The starting position still wraps. */
+void fb_draw_sprite_clipped(fb_console *fb, uint8_t *source, uint8_t bytes, uint8_t x, uint8_t y, bool *is_pixel_erased);
+
+void fb_draw_sprite16_clipped(fb_console *fb, uint8_t *source, uint8_t x, uint8_t y, bool *is_pixel_erased);
+
+void fb_select_planes(fb_console *fb, uint8_t planes);
+
+/* 64x64 or 64x32, switching clears the screen */
+void fb_set_hires(fb_console *fb, bool is_hires);
+
+/* TODO: bad naming, should be something like refresh
+ *
+ * Frames go to stdout through a non-blocking descriptor of their own, a
+ * frame is rendered into a buffer and written out
+ * as far as the terminal takes it. The rest goes out on the following calls,
+ * meanwhile newer frames replace one another and only the latest one is
+ * written next. True if a frame got written out completely. */
+bool fb_redraw(fb_console *fb, bool keyboard_state[16]);
+
+/* A line shown under the frame from the next redraw on, NULL for none */
+void fb_set_status(fb_console *fb, const char *status);
+
+void fb_get_output_counters(const fb_console *fb, fb_output_counters *counters);
 
 void fb_clear(fb_console *fb);
 
+/* Replace the framebuffer with a copy saved before, rows that differ become
+ * dirty */
+void fb_load(fb_console *fb, const void *saved);
+
+/* Hash of the whole framebuffer, equal framebuffers hash the same */
+static inline uint64_t fb_frame_hash(const fb_console *fb)
+{
+    return fb->frame_hash;
+}
+
+/* Rows changed since the last call, which resets them */
+fb_row_mask fb_take_dirty_rows(fb_console *fb);
+
 #endif /* FB_CONSOLE_H */
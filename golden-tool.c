@@ -0,0 +1,419 @@
+/*
+ * pchip-golden: golden frame regression runs over a ROM corpus
+ *
+ *   pchip-golden check [options] <rom>...   compare against the golden file
+ *   pchip-golden update [options] <rom>...  write the golden file
+ *
+ * Every ROM runs headless with its roms.db settings and scripted input, the
+ * framebuffer is hashed every checkpoint interval. ROMs run in parallel, one
+ * pchip instance per ROM.
+ *
+ * Golden file lines: <ROM hash> <frame>:<framebuffer hash>... [fault:<frame>] # name
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <libgen.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pchip.h"
+
+#define DEFAULT_FRAMES 600
+#define DEFAULT_INTERVAL 60
+#define MAX_CHECKPOINTS 256
+
+/* Input script: after a second of boot every key in turn is held for 10
+ * frames out of 30 */
+#define SCRIPT_START_FRAME 60
+#define SCRIPT_SLOT_FRAMES 30
+#define SCRIPT_HOLD_FRAMES 10
+
+enum rom_result {
+    ROM_PASS,
+    ROM_FAIL,
+    ROM_NEW,
+    ROM_ERROR,
+};
+
+static const char *result_names[] = {
+    [ROM_PASS] = "pass",
+    [ROM_FAIL] = "FAIL",
+    [ROM_NEW] = "new",
+    [ROM_ERROR] = "ERROR",
+};
+
+typedef struct golden_run {
+    uint64_t rom_hash;
+    uint32_t checkpoints;
+    uint32_t frames[MAX_CHECKPOINTS];
+    uint64_t frame_hashes[MAX_CHECKPOINTS];
+    /* Frame the guest faulted in, -1 for none */
+    int32_t fault_frame;
+} golden_run;
+
+typedef struct rom_job {
+    char *path;
+    const char *name;
+    golden_run run;
+    enum rom_result result;
+    /* First checkpoint differing from the golden one */
+    uint32_t failed_frame;
+    double msec;
+} rom_job;
+
+typedef struct runner {
+    const romdb *db;
+    const golden_run *golden;
+    size_t golden_count;
+    uint32_t frames;
+    uint32_t interval;
+
+    rom_job *jobs;
+    size_t job_count;
+    atomic_size_t next_job;
+} runner;
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s check|update [-g roms.golden] [-d roms.db] [-j jobs] [-f frames] [-c interval] <path/to/rom>...\n", prog);
+    fprintf(stderr, "  -g  golden file, roms.golden by default\n");
+    fprintf(stderr, "  -d  ROM settings database, roms.db by default\n");
+    fprintf(stderr, "  -j  parallel runs, one per online CPU by default\n");
+    fprintf(stderr, "  -f  frames per ROM, %d by default\n", DEFAULT_FRAMES);
+    fprintf(stderr, "  -c  frames between framebuffer hashes, %d by default\n", DEFAULT_INTERVAL);
+    exit(EXIT_FAILURE);
+}
+
+static double msec_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+}
+
+static uint16_t script_keys(uint32_t frame)
+{
+    if (frame < SCRIPT_START_FRAME)
+        return 0;
+    frame -= SCRIPT_START_FRAME;
+    if (frame % SCRIPT_SLOT_FRAMES >= SCRIPT_HOLD_FRAMES)
+        return 0;
+    return 1u << (frame / SCRIPT_SLOT_FRAMES % CHIP8_KEY_COUNT);
+}
+
+static uint8_t *read_rom(const char *path, size_t *size)
+{
+    FILE *in = fopen(path, "rb");
+    if (!in)
+        return NULL;
+
+    uint8_t *data = malloc(XOCHIP_MAX_ROM_SIZE_BYTES);
+    if (data) {
+        *size = fread(data, 1, XOCHIP_MAX_ROM_SIZE_BYTES, in);
+        if (ferror(in) || fgetc(in) != EOF) {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(in);
+
+    return data;
+}
+
+static const golden_run *find_golden(const runner *r, uint64_t rom_hash)
+{
+    for (size_t i = 0; i < r->golden_count; i++)
+        if (r->golden[i].rom_hash == rom_hash)
+            return &r->golden[i];
+    return NULL;
+}
+
+static enum rom_result run_rom(const runner *r, rom_job *job)
+{
+    size_t size = 0;
+    uint8_t *rom = read_rom(job->path, &size);
+    if (!rom)
+        return ROM_ERROR;
+
+    golden_run *run = &job->run;
+    run->rom_hash = romdb_hash(rom, size);
+    run->fault_frame = -1;
+
+    pchip_config config;
+    pchip_config_default(&config);
+    if (!r->db || !romdb_lookup(r->db, run->rom_hash, &config.settings))
+        romdb_settings_default(&config.settings);
+
+    pchip *inst = NULL;
+    if (pchip_new(&config, &inst) != PCHIP_SUCCESS || pchip_load(inst, rom, size) != PCHIP_SUCCESS) {
+        pchip_free(inst);
+        free(rom);
+        return ROM_ERROR;
+    }
+    free(rom);
+
+    for (uint32_t frame = 1; frame <= r->frames; frame++) {
+        /* A faulted machine stays as it is */
+        if (run->fault_frame < 0) {
+            pchip_set_keys(inst, script_keys(frame));
+            int rc = pchip_run_frame(inst);
+            if (rc == CHIP8_FAULT || rc == CHIP8_FAIL)
+                run->fault_frame = frame;
+        }
+        if (frame % r->interval == 0 && run->checkpoints < MAX_CHECKPOINTS) {
+            run->frames[run->checkpoints] = frame;
+            run->frame_hashes[run->checkpoints++] = fb_frame_hash(pchip_display(inst));
+        }
+    }
+    pchip_free(inst);
+
+    const golden_run *golden = find_golden(r, run->rom_hash);
+    if (!golden)
+        return ROM_NEW;
+
+    for (uint32_t i = 0; i < run->checkpoints; i++) {
+        if (i >= golden->checkpoints || golden->frames[i] != run->frames[i] ||
+            golden->frame_hashes[i] != run->frame_hashes[i]) {
+            job->failed_frame = run->frames[i];
+            return ROM_FAIL;
+        }
+    }
+    if (golden->checkpoints != run->checkpoints || golden->fault_frame != run->fault_frame) {
+        job->failed_frame = r->frames;
+        return ROM_FAIL;
+    }
+    return ROM_PASS;
+}
+
+static void *worker(void *arg)
+{
+    runner *r = arg;
+    for (;;) {
+        size_t i = atomic_fetch_add(&r->next_job, 1);
+        if (i >= r->job_count)
+            return NULL;
+
+        rom_job *job = &r->jobs[i];
+        double start = msec_now();
+        job->result = run_rom(r, job);
+        job->msec = msec_now() - start;
+    }
+}
+
+/* Golden lines, false if the file is broken. No file is no golden runs. */
+static bool load_golden(const char *path, golden_run **runs, size_t *count)
+{
+    *runs = NULL;
+    *count = 0;
+
+    FILE *in = fopen(path, "r");
+    if (!in)
+        return true;
+
+    size_t capacity = 0;
+    char line[8192];
+    bool is_ok = true;
+    while (is_ok && fgets(line, sizeof(line), in)) {
+        char *comment = strchr(line, '#');
+        if (comment)
+            *comment = '\0';
+
+        char *save = NULL;
+        char *token = strtok_r(line, " \t\n", &save);
+        if (!token)
+            continue;
+
+        if (*count == capacity) {
+            capacity = capacity ? capacity * 2 : 128;
+            golden_run *grown = realloc(*runs, capacity * sizeof(**runs));
+            if (!grown) {
+                is_ok = false;
+                break;
+            }
+            *runs = grown;
+        }
+        golden_run *run = &(*runs)[(*count)++];
+        *run = (golden_run){ .fault_frame = -1 };
+
+        char *end = NULL;
+        run->rom_hash = strtoull(token, &end, 16);
+        is_ok = !*end;
+
+        while (is_ok && (token = strtok_r(NULL, " \t\n", &save))) {
+            if (strncmp(token, "fault:", 6) == 0) {
+                run->fault_frame = strtol(token + 6, &end, 10);
+                is_ok = !*end;
+            } else if (run->checkpoints < MAX_CHECKPOINTS) {
+                run->frames[run->checkpoints] = strtoul(token, &end, 10);
+                is_ok = *end == ':';
+                if (is_ok)
+                    run->frame_hashes[run->checkpoints++] = strtoull(end + 1, &end, 16);
+                is_ok = is_ok && !*end;
+            } else {
+                is_ok = false;
+            }
+        }
+    }
+    fclose(in);
+
+    if (!is_ok) {
+        fprintf(stderr, "Broken golden file: %s\n", path);
+        free(*runs);
+        *runs = NULL;
+    }
+    return is_ok;
+}
+
+static int write_golden(const char *path, const runner *r)
+{
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(out, "# Golden framebuffer hashes, see pchip-golden and README.org\n");
+    fprintf(out, "# %u frames, every %u\n", r->frames, r->interval);
+    for (size_t i = 0; i < r->job_count; i++) {
+        const rom_job *job = &r->jobs[i];
+        if (job->result == ROM_ERROR)
+            continue;
+        fprintf(out, "%016" PRIx64, job->run.rom_hash);
+        for (uint32_t c = 0; c < job->run.checkpoints; c++)
+            fprintf(out, " %u:%016" PRIx64, job->run.frames[c], job->run.frame_hashes[c]);
+        if (job->run.fault_frame >= 0)
+            fprintf(out, " fault:%d", job->run.fault_frame);
+        fprintf(out, " # %s\n", job->name);
+    }
+
+    fclose(out);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+        usage(argv[0]);
+    const char *cmd = argv[1];
+    bool is_update = strcmp(cmd, "update") == 0;
+    if (!is_update && strcmp(cmd, "check") != 0)
+        usage(argv[0]);
+
+    const char *golden_path = "roms.golden";
+    const char *db_path = "roms.db";
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    long frames = DEFAULT_FRAMES;
+    long interval = DEFAULT_INTERVAL;
+
+    /* Options follow the command */
+    optind = 2;
+    int opt;
+    while ((opt = getopt(argc, argv, "g:d:j:f:c:")) != -1) {
+        char *end = NULL;
+        switch (opt) {
+        case 'g':
+            golden_path = optarg;
+            break;
+        case 'd':
+            db_path = optarg;
+            break;
+        case 'j':
+            jobs = strtol(optarg, &end, 10);
+            if (*end || jobs <= 0)
+                usage(argv[0]);
+            break;
+        case 'f':
+            frames = strtol(optarg, &end, 10);
+            if (*end || frames <= 0)
+                usage(argv[0]);
+            break;
+        case 'c':
+            interval = strtol(optarg, &end, 10);
+            if (*end || interval <= 0)
+                usage(argv[0]);
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (argc == optind)
+        usage(argv[0]);
+    if (jobs < 1)
+        jobs = 1;
+    if (frames / interval > MAX_CHECKPOINTS) {
+        fprintf(stderr, "Up to %d checkpoints\n", MAX_CHECKPOINTS);
+        exit(EXIT_FAILURE);
+    }
+
+    runner r = { .frames = frames, .interval = interval, .job_count = argc - optind };
+
+    romdb *db = NULL;
+    if (romdb_load(db_path, &db) != ROMDB_SUCCESS)
+        fprintf(stderr, "No ROM settings, defaults for all: %s\n", db_path);
+    r.db = db;
+
+    golden_run *golden = NULL;
+    if (!is_update && !load_golden(golden_path, &golden, &r.golden_count))
+        exit(EXIT_FAILURE);
+    r.golden = golden;
+
+    r.jobs = calloc(r.job_count, sizeof(*r.jobs));
+    if (!r.jobs) {
+        fprintf(stderr, "Calloc failure\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < r.job_count; i++) {
+        r.jobs[i].path = argv[optind + i];
+        r.jobs[i].name = basename(strdup(argv[optind + i]));
+    }
+
+    if ((size_t)jobs > r.job_count)
+        jobs = r.job_count;
+    pthread_t *threads = calloc(jobs, sizeof(*threads));
+    if (!threads) {
+        fprintf(stderr, "Calloc failure\n");
+        exit(EXIT_FAILURE);
+    }
+
+    double start = msec_now();
+    long started = 0;
+    for (; started < jobs; started++)
+        if (pthread_create(&threads[started], NULL, worker, &r) != 0)
+            break;
+    /* Whatever couldn't be started is done here */
+    if (!started)
+        worker(&r);
+    for (long i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+    double msec = msec_now() - start;
+
+    size_t counts[ROM_ERROR + 1] = {0};
+    printf("%-64s %-6s %8s\n", "ROM", "result", "ms");
+    for (size_t i = 0; i < r.job_count; i++) {
+        const rom_job *job = &r.jobs[i];
+        counts[job->result]++;
+        printf("%-64.64s %-6s %8.1f", job->name, result_names[job->result], job->msec);
+        if (job->result == ROM_FAIL)
+            printf("  differs at frame %u", job->failed_frame);
+        if (job->run.fault_frame >= 0)
+            printf("  guest fault at frame %d", job->run.fault_frame);
+        putchar('\n');
+    }
+    printf("%zu passed, %zu failed, %zu new, %zu errors, %zu ROMs in %.2fs on %ld threads\n",
+           counts[ROM_PASS], counts[ROM_FAIL], counts[ROM_NEW], counts[ROM_ERROR], r.job_count,
+           msec / 1000, started ? started : 1);
+
+    int exit_code = counts[ROM_FAIL] || counts[ROM_ERROR] ? EXIT_FAILURE : EXIT_SUCCESS;
+    if (is_update)
+        exit_code = write_golden(golden_path, &r);
+
+    free(threads);
+    free(golden);
+    romdb_free(db);
+    return exit_code;
+}
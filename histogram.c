@@ -0,0 +1,49 @@
+#include "histogram.h"
+
+static unsigned bucket_of(uint64_t value)
+{
+    if (value < 16)
+        return value;
+    unsigned exp = 63 - __builtin_clzll(value);
+    unsigned sub = (value >> (exp - 3)) & (HISTOGRAM_SUB_BUCKETS - 1);
+    return 16 + (exp - 4) * HISTOGRAM_SUB_BUCKETS + sub;
+}
+
+/* Largest value falling into the bucket */
+static uint64_t bucket_limit(unsigned bucket)
+{
+    if (bucket < 16)
+        return bucket;
+    unsigned exp = (bucket - 16) / HISTOGRAM_SUB_BUCKETS + 4;
+    uint64_t sub = (bucket - 16) % HISTOGRAM_SUB_BUCKETS;
+    return ((HISTOGRAM_SUB_BUCKETS + sub + 1) << (exp - 3)) - 1;
+}
+
+void histogram_record(histogram *h, uint64_t value)
+{
+    h->counts[bucket_of(value)]++;
+    h->samples++;
+    if (value > h->max)
+        h->max = value;
+}
+
+uint64_t histogram_percentile(const histogram *h, double fraction)
+{
+    if (!h->samples)
+        return 0;
+
+    /* Rank of the sample, 1-based */
+    uint64_t rank = (uint64_t)(fraction * h->samples + 0.999999);
+    if (rank < 1)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for (unsigned bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+        seen += h->counts[bucket];
+        if (seen >= rank) {
+            uint64_t limit = bucket_limit(bucket);
+            return limit < h->max ? limit : h->max;
+        }
+    }
+    return h->max;
+}
@@ -0,0 +1,27 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+/*
+ * Log-linear histogram of durations or any other non-negative values:
+ * exact under 16, then 8 buckets per power of two, i.e. percentiles are
+ * within 12.5%. Zero initialized is empty.
+ */
+
+#define HISTOGRAM_SUB_BUCKETS 8
+#define HISTOGRAM_BUCKETS (16 + (64 - 4) * HISTOGRAM_SUB_BUCKETS)
+
+typedef struct histogram {
+    uint64_t counts[HISTOGRAM_BUCKETS];
+    uint64_t samples;
+    uint64_t max;
+} histogram;
+
+void histogram_record(histogram *h, uint64_t value);
+
+/* Value that fraction of the samples are at or under, the upper bound of the
+ * bucket, 0 for no samples */
+uint64_t histogram_percentile(const histogram *h, double fraction);
+
+#endif /* HISTOGRAM_H */
@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "history.h"
+#include "delta.h"
+
+typedef struct history_entry {
+    uint8_t *data;
+    uint32_t size;
+    bool is_keyframe;
+} history_entry;
+
+struct history {
+    size_t budget_bytes;
+    size_t used_bytes;
+    uint32_t keyframe_interval;
+    /* Entries since the newest keyframe, itself included */
+    uint32_t since_keyframe;
+
+    /* Ring, oldest first, the oldest one is always a keyframe */
+    history_entry *entries;
+    uint32_t capacity;
+    uint32_t first;
+    uint32_t count;
+
+    size_t state_bytes;
+    uint8_t *last;              /* Last captured state */
+    uint8_t *state;             /* Scratch */
+    uint8_t *blank;
+    uint8_t *encoded;
+};
+
+int history_new(size_t budget_bytes, uint32_t max_frames, uint32_t keyframe_interval, history **hist)
+{
+    *hist = calloc(1, sizeof(**hist));
+    if (!*hist) {
+        fprintf(stderr, "Calloc failure\n");
+        return HISTORY_FAIL;
+    }
+
+    history *h = *hist;
+    h->budget_bytes = budget_bytes;
+    h->keyframe_interval = keyframe_interval ? keyframe_interval : 1;
+    h->capacity = max_frames ? max_frames : 1;
+    h->entries = calloc(h->capacity, sizeof(*h->entries));
+    h->last = malloc(CHIP8_MAX_STATE_BYTES);
+    h->state = malloc(CHIP8_MAX_STATE_BYTES);
+    h->blank = calloc(1, CHIP8_MAX_STATE_BYTES);
+    h->encoded = malloc(DELTA_MAX_ENCODED(CHIP8_MAX_STATE_BYTES));
+    if (!h->entries || !h->last || !h->state || !h->blank || !h->encoded) {
+        fprintf(stderr, "Malloc failure\n");
+        history_free(h);
+        *hist = NULL;
+        return HISTORY_FAIL;
+    }
+
+    return HISTORY_SUCCESS;
+}
+
+static history_entry *entry_at(history *hist, uint32_t i)
+{
+    return &hist->entries[(hist->first + i) % hist->capacity];
+}
+
+static void drop_newest(history *hist)
+{
+    history_entry *entry = entry_at(hist, hist->count - 1);
+    hist->used_bytes -= entry->size;
+    free(entry->data);
+    hist->count--;
+}
+
+/* The oldest keyframe and its deltas */
+static void drop_oldest_group(history *hist)
+{
+    do {
+        history_entry *entry = entry_at(hist, 0);
+        hist->used_bytes -= entry->size;
+        free(entry->data);
+        hist->first = (hist->first + 1) % hist->capacity;
+        hist->count--;
+    } while (hist->count && !entry_at(hist, 0)->is_keyframe);
+}
+
+static void clear(history *hist)
+{
+    while (hist->count)
+        drop_newest(hist);
+    hist->first = 0;
+    hist->since_keyframe = 0;
+}
+
+void history_free(history *hist)
+{
+    if (!hist)
+        return;
+    if (hist->entries)
+        clear(hist);
+    free(hist->entries);
+    free(hist->last);
+    free(hist->state);
+    free(hist->blank);
+    free(hist->encoded);
+    free(hist);
+}
+
+size_t history_frame_count(const history *hist)
+{
+    return hist->count;
+}
+
+size_t history_bytes(const history *hist)
+{
+    return hist->used_bytes;
+}
+
+void history_capture(history *hist, const chip8 *vm)
+{
+    size_t bytes = chip8_state_size(vm);
+    if (bytes != hist->state_bytes) {
+        clear(hist);
+        hist->state_bytes = bytes;
+    }
+
+    chip8_save_state(vm, hist->state);
+
+    bool is_keyframe = !hist->count || hist->since_keyframe >= hist->keyframe_interval;
+    size_t size = delta_encode(is_keyframe ? hist->blank : hist->last, hist->state, bytes, hist->encoded);
+
+    while (hist->count && (hist->used_bytes + size > hist->budget_bytes || hist->count == hist->capacity)) {
+        drop_oldest_group(hist);
+        /* Nothing left to be a delta against */
+        if (!hist->count && !is_keyframe) {
+            is_keyframe = true;
+            size = delta_encode(hist->blank, hist->state, bytes, hist->encoded);
+        }
+    }
+
+    uint8_t *data = size <= hist->budget_bytes ? malloc(size ? size : 1) : NULL;
+    if (!data) {
+        /* Start over with a keyframe next time */
+        clear(hist);
+        return;
+    }
+    memcpy(data, hist->encoded, size);
+
+    hist->count++;
+    *entry_at(hist, hist->count - 1) = (history_entry){ data, size, is_keyframe };
+    hist->used_bytes += size;
+    hist->since_keyframe = is_keyframe ? 1 : hist->since_keyframe + 1;
+
+    uint8_t *last = hist->last;
+    hist->last = hist->state;
+    hist->state = last;
+}
+
+bool history_step_back(history *hist, chip8 *vm)
+{
+    if (hist->count < 2)
+        return false;
+
+    size_t bytes = hist->state_bytes;
+    history_entry *newest = entry_at(hist, hist->count - 1);
+    uint32_t since_keyframe = hist->since_keyframe;
+
+    if (!newest->is_keyframe) {
+        /* XOR goes both ways */
+        memcpy(hist->state, hist->last, bytes);
+        delta_apply(hist->state, bytes, newest->data, newest->size);
+        since_keyframe--;
+    } else {
+        uint32_t target = hist->count - 2;
+        uint32_t keyframe = target;
+        while (!entry_at(hist, keyframe)->is_keyframe)
+            keyframe--;
+
+        memset(hist->state, 0, bytes);
+        for (uint32_t i = keyframe; i <= target; i++) {
+            history_entry *entry = entry_at(hist, i);
+            delta_apply(hist->state, bytes, entry->data, entry->size);
+        }
+        since_keyframe = target - keyframe + 1;
+    }
+
+    /* The entry stays when the machine cannot take the state */
+    if (chip8_load_state(vm, hist->state) != CHIP8_SUCCESS)
+        return false;
+    drop_newest(hist);
+    hist->since_keyframe = since_keyframe;
+
+    uint8_t *last = hist->last;
+    hist->last = hist->state;
+    hist->state = last;
+
+    return true;
+}
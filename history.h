@@ -0,0 +1,47 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "chip8.h"
+
+/*
+ * Rewind history
+ *
+ * A ring of per-frame machine states (chip8_save_state()), every entry is a
+ * delta.h encoded XOR against the previous frame, every keyframe_interval-th
+ * one against a blank state. Going back a frame replays deltas from the
+ * closest keyframe. When the memory budget or the frame limit is reached the
+ * oldest keyframe goes along with its deltas.
+ */
+
+#define HISTORY_DEFAULT_BUDGET_BYTES (8u << 20)
+#define HISTORY_DEFAULT_KEYFRAME_INTERVAL 60
+
+enum history_status {
+    HISTORY_SUCCESS,
+    HISTORY_FAIL,
+};
+
+typedef struct history history;
+
+int history_new(size_t budget_bytes, uint32_t max_frames, uint32_t keyframe_interval, history **hist);
+
+void history_free(history *hist);
+
+/* Record the state at the end of a frame */
+void history_capture(history *hist, const chip8 *vm);
+
+/* Restore the frame before the last captured one and forget the latter,
+ * false if there is nothing to go back to or the machine can't load the state
+ * (chip8_load_state()), the history is kept as it was then */
+bool history_step_back(history *hist, chip8 *vm);
+
+size_t history_frame_count(const history *hist);
+
+/* Encoded bytes held */
+size_t history_bytes(const history *hist);
+
+#endif /* HISTORY_H */
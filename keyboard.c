@@ -9,6 +9,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <unistd.h>
+#include <time.h>
 #include <linux/input.h>
 
 #include <libevdev/libevdev.h>
@@ -16,7 +17,14 @@
 #include "keyboard.h"
 
 struct keyboard {
+    /* NULL for virtual keyboards */
     struct libevdev *dev;
+    bool key_state[CHIP8_KEY_COUNT];
+    bool host_key_state[KEYBOARD_HOST_KEY_COUNT];
+
+    /* Kernel timestamps of key state changes nobody has looked at yet, 0 for
+     * none */
+    uint64_t usec_unobserved[CHIP8_KEY_COUNT];
 };
 
 static const int keys_used[] = {
@@ -70,8 +78,14 @@ static const uint8_t chip8_key_to_key[] = {
     [CHIP8_KEY_F] = KEY_V,
 };
 
+static const int host_key_to_key[KEYBOARD_HOST_KEY_COUNT] = {
+    [KEYBOARD_HOST_REWIND] = KEY_BACKSPACE,
+    [KEYBOARD_HOST_FAST_FORWARD] = KEY_TAB,
+};
+
 static bool is_suitable_device(struct libevdev *dev);
 static void evdev_resync(keyboard *ke);
+static void note_event(keyboard *ke, const struct input_event *ev);
 
 int keyboard_new(const char *path, keyboard **ke_ptr)
 {
@@ -105,6 +119,9 @@ int keyboard_new(const char *path, keyboard **ke_ptr)
 
     ke->dev = dev;
 
+    /* Event timestamps comparable to the emulator's clock */
+    libevdev_set_clock_id(dev, CLOCK_MONOTONIC);
+
     *ke_ptr = ke;
 
     rc = 0;
@@ -116,11 +133,50 @@ err2:
     return KEYBOARD_FAIL;
 }
 
+int keyboard_new_virtual(keyboard **ke_ptr)
+{
+    keyboard *ke = calloc(1, sizeof(keyboard));
+    if (ke == NULL) {
+        fprintf(stderr, "Calloc failure\n");
+        return KEYBOARD_FAIL;
+    }
+
+    *ke_ptr = ke;
+    return KEYBOARD_SUCCESS;
+}
+
+size_t keyboard_virtual_size(void)
+{
+    return sizeof(keyboard);
+}
+
+void keyboard_init_virtual(keyboard *ke)
+{
+    *ke = (keyboard){0};
+}
+
+void keyboard_set_key(keyboard *ke, int key, bool is_pressed)
+{
+    assert(key < CHIP8_KEY_COUNT);
+    ke->key_state[key] = is_pressed;
+}
+
+void keyboard_set_host_key(keyboard *ke, enum keyboard_host_key key, bool is_pressed)
+{
+    assert(key < KEYBOARD_HOST_KEY_COUNT);
+    ke->host_key_state[key] = is_pressed;
+}
+
 void keyboard_free(keyboard *ke)
 {
     if (!ke)
         return;
 
+    if (!ke->dev) {
+        free(ke);
+        return;
+    }
+
     int fd = libevdev_get_fd(ke->dev);
     if (fd != -1)
         close(fd);
@@ -141,6 +197,16 @@ int keyboard_wait_for_key(keyboard *ke, int *key_pressed)
 {
     int rc = -1;
 
+    if (!ke->dev) {
+        for (int key = 0; key < CHIP8_KEY_COUNT; key++) {
+            if (ke->key_state[key]) {
+                *key_pressed = key;
+                return KEYBOARD_SUCCESS;
+            }
+        }
+        return KEYBOARD_NO_KEY;
+    }
+
     for (;;) {
         struct input_event ev;
         rc = libevdev_next_event(ke->dev, LIBEVDEV_READ_FLAG_NORMAL, &ev);
@@ -148,6 +214,7 @@ int keyboard_wait_for_key(keyboard *ke, int *key_pressed)
         if (rc == LIBEVDEV_READ_STATUS_SYNC) {
             evdev_resync(ke);
         } else if (rc == LIBEVDEV_READ_STATUS_SUCCESS) {
+            note_event(ke, &ev);
             /* Done waiting? */
             if (ev.type == EV_KEY && ev.value == 1 && is_key_code_defined(ev.code)) {
                 *key_pressed = key_to_chip8_key[ev.code];
@@ -168,6 +235,12 @@ int keyboard_is_key_pressed(keyboard *ke, int key_to_check, bool *is_key_pressed
 {
     int rc = -1;
 
+    assert(key_to_check >= 0 && key_to_check < CHIP8_KEY_COUNT);
+    if (!ke->dev) {
+        *is_key_pressed = ke->key_state[key_to_check];
+        return KEYBOARD_SUCCESS;
+    }
+
     for (;;) {
         struct input_event ev;
         rc = libevdev_next_event(ke->dev, LIBEVDEV_READ_FLAG_NORMAL, &ev);
@@ -177,6 +250,7 @@ int keyboard_is_key_pressed(keyboard *ke, int key_to_check, bool *is_key_pressed
         } else if (rc == LIBEVDEV_READ_STATUS_SUCCESS) {
             /* Just flush all the events and update the internal libevdev
              * state */
+            note_event(ke, &ev);
         } else if (rc == -EAGAIN) {
             /* No more events, so let's check keyboard state  */
             int value = libevdev_get_event_value(
@@ -192,6 +266,15 @@ int keyboard_is_key_pressed(keyboard *ke, int key_to_check, bool *is_key_pressed
 
 }
 
+int keyboard_is_host_key_pressed(keyboard *ke, enum keyboard_host_key key, bool *is_pressed)
+{
+    if (!ke->dev)
+        *is_pressed = ke->host_key_state[key];
+    else
+        *is_pressed = libevdev_get_event_value(ke->dev, EV_KEY, host_key_to_key[key]) != 0;
+    return KEYBOARD_SUCCESS;
+}
+
 int keyboard_get_key_state(keyboard *ke, bool keyboard_state[CHIP8_KEY_COUNT])
 {
     for (size_t i = 0; i < CHIP8_KEY_COUNT; i++ ){
@@ -206,6 +289,9 @@ int keyboard_flush(keyboard *ke)
 {
     int rc = -1;
 
+    if (!ke->dev)
+        return KEYBOARD_SUCCESS;
+
     for (;;) {
         struct input_event ev;
         rc = libevdev_next_event(ke->dev, LIBEVDEV_READ_FLAG_NORMAL, &ev);
@@ -214,6 +300,7 @@ int keyboard_flush(keyboard *ke)
             evdev_resync(ke);
         } else if (rc == LIBEVDEV_READ_STATUS_SUCCESS) {
             /* Just flush events */
+            note_event(ke, &ev);
         } else if (rc == -EAGAIN) {
             /* No more events so we're done  */
             return KEYBOARD_SUCCESS;
@@ -224,6 +311,27 @@ int keyboard_flush(keyboard *ke)
     }
 }
 
+bool keyboard_take_input_time(keyboard *ke, int key, uint64_t *usec)
+{
+    assert(key < CHIP8_KEY_COUNT);
+    if (!ke->usec_unobserved[key])
+        return false;
+    *usec = ke->usec_unobserved[key];
+    ke->usec_unobserved[key] = 0;
+    return true;
+}
+
+/* Presses and releases of CHIP-8 keys, the earliest one not looked at */
+static void note_event(keyboard *ke, const struct input_event *ev)
+{
+    if (ev->type != EV_KEY || ev->value == 2 || !is_key_code_defined(ev->code))
+        return;
+
+    int key = key_to_chip8_key[ev->code];
+    if (!ke->usec_unobserved[key])
+        ke->usec_unobserved[key] = (uint64_t)ev->time.tv_sec * 1000000 + ev->time.tv_usec;
+}
+
 static void evdev_resync(keyboard *ke)
 {
     int rc = -1;
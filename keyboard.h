@@ -2,26 +2,59 @@
 #define KEYBOARD_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
 
 #include "common.h"
 
 enum keyboard_status {
     KEYBOARD_SUCCESS,
     KEYBOARD_FAIL,
+    KEYBOARD_NO_KEY,
+};
+
+/* Emulator controls on the host keyboard, the guest never sees them */
+enum keyboard_host_key {
+    KEYBOARD_HOST_REWIND,       /* Backspace */
+    KEYBOARD_HOST_FAST_FORWARD, /* Tab */
+    KEYBOARD_HOST_KEY_COUNT
 };
 
 typedef struct keyboard keyboard;
 
 int keyboard_new(const char *path, keyboard **ke_ptr);
 
+/* A keyboard without a device, key state is only changed with
+ * keyboard_set_key(). Waiting for a key never blocks and returns
+ * KEYBOARD_NO_KEY if nothing is pressed. */
+int keyboard_new_virtual(keyboard **ke_ptr);
+
+/* keyboard_new_virtual() in place, in keyboard_virtual_size() bytes allocated
+ * by the caller. Not to be keyboard_free()d. */
+size_t keyboard_virtual_size(void);
+
+void keyboard_init_virtual(keyboard *ke);
+
+void keyboard_set_key(keyboard *ke, int key, bool is_pressed);
+
+void keyboard_set_host_key(keyboard *ke, enum keyboard_host_key key, bool is_pressed);
+
 void keyboard_free(keyboard *ke);
 
 int keyboard_wait_for_key(keyboard *ke, int *key_pressed);
 
 int keyboard_is_key_pressed(keyboard *ke, int key_to_check, bool *is_key_pressed);
 
+/* State as of the last keyboard_flush() */
+int keyboard_is_host_key_pressed(keyboard *ke, enum keyboard_host_key key, bool *is_pressed);
+
 int keyboard_get_key_state(keyboard *ke, bool key_state[CHIP8_KEY_COUNT]);
 
+/* Kernel timestamp (CLOCK_MONOTONIC, usec) of the first change of the key
+ * since the last call, false if it hasn't changed. Virtual keyboards never
+ * have one. */
+bool keyboard_take_input_time(keyboard *ke, int key, uint64_t *usec);
+
 int keyboard_flush(keyboard *ke);
 
 #endif /* KEYBOARD_H */
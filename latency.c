@@ -0,0 +1,80 @@
+#include <stdlib.h>
+#include <time.h>
+
+#include "latency.h"
+
+static const char *stage_names[LATENCY_STAGE_COUNT] = {
+    [LATENCY_OBSERVED] = "observed",
+    [LATENCY_DRAWN] = "drawn",
+    [LATENCY_SHOWN] = "shown",
+};
+
+int latency_new(latency **lat)
+{
+    *lat = calloc(1, sizeof(**lat));
+    if (!*lat) {
+        fprintf(stderr, "Calloc failure\n");
+        return LATENCY_FAIL;
+    }
+    return LATENCY_SUCCESS;
+}
+
+void latency_free(latency *lat)
+{
+    free(lat);
+}
+
+uint64_t latency_usec_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static void record(latency *lat, enum latency_stage stage, uint64_t usec_input, uint64_t usec_now)
+{
+    /* Clock trouble, an event from before the emulator's clock reading */
+    uint64_t usec = usec_now > usec_input ? usec_now - usec_input : 0;
+
+    histogram_record(&lat->stages[stage], usec);
+}
+
+void latency_observed(latency *lat, uint64_t usec_input, uint64_t usec_now)
+{
+    if (usec_now > usec_input + LATENCY_USEC_STALE)
+        return;
+
+    record(lat, LATENCY_OBSERVED, usec_input, usec_now);
+    if (!lat->usec_awaiting_draw && !lat->usec_awaiting_show)
+        lat->usec_awaiting_draw = usec_input;
+}
+
+void latency_drawn(latency *lat, uint64_t usec_now)
+{
+    if (!lat->usec_awaiting_draw)
+        return;
+    record(lat, LATENCY_DRAWN, lat->usec_awaiting_draw, usec_now);
+    lat->usec_awaiting_show = lat->usec_awaiting_draw;
+    lat->usec_awaiting_draw = 0;
+}
+
+void latency_shown(latency *lat, uint64_t usec_now)
+{
+    if (!lat->usec_awaiting_show)
+        return;
+    record(lat, LATENCY_SHOWN, lat->usec_awaiting_show, usec_now);
+    lat->usec_awaiting_show = 0;
+}
+
+void latency_report(const latency *lat, FILE *out)
+{
+    fprintf(out, "Input latency from the key event, ms:\n");
+    fprintf(out, "%-10s %10s %10s %10s %10s\n", "stage", "samples", "p50", "p99", "max");
+    for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+        const histogram *h = &lat->stages[stage];
+        fprintf(out, "%-10s %10llu %10.2f %10.2f %10.2f\n", stage_names[stage],
+                (unsigned long long)h->samples, histogram_percentile(h, 0.50) / 1000.0,
+                histogram_percentile(h, 0.99) / 1000.0, h->max / 1000.0);
+    }
+    fflush(out);
+}
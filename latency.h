@@ -0,0 +1,79 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "histogram.h"
+
+/*
+ * Input to display latency
+ *
+ * A key press or release is timestamped by the kernel and followed from
+ * there to:
+ *
+ *   - observed: SKP, SKNP or FX0A first looks at the key
+ *   - drawn: the framebuffer changes next
+ *   - shown: the redraw of that change is written out
+ *
+ * Every stage is a histogram of latencies from the input, one input is
+ * followed at a time, the ones coming in the meantime only count as observed.
+ */
+
+/* Inputs nobody looked at for this long aren't waited on, the program just
+ * wasn't interested in the key at the time */
+#define LATENCY_USEC_STALE 1000000
+
+enum latency_status {
+    LATENCY_SUCCESS,
+    LATENCY_FAIL,
+};
+
+enum latency_stage {
+    LATENCY_OBSERVED,
+    LATENCY_DRAWN,
+    LATENCY_SHOWN,
+    LATENCY_STAGE_COUNT
+};
+
+typedef struct latency {
+    /* usec */
+    histogram stages[LATENCY_STAGE_COUNT];
+
+    /* Input being followed, 0 for none */
+    uint64_t usec_awaiting_draw;
+    uint64_t usec_awaiting_show;
+} latency;
+
+int latency_new(latency **lat);
+
+void latency_free(latency *lat);
+
+/* CLOCK_MONOTONIC, same as input timestamps */
+uint64_t latency_usec_now(void);
+
+void latency_observed(latency *lat, uint64_t usec_input, uint64_t usec_now);
+
+void latency_drawn(latency *lat, uint64_t usec_now);
+
+void latency_shown(latency *lat, uint64_t usec_now);
+
+/* p50, p99 and max per stage */
+void latency_report(const latency *lat, FILE *out);
+
+/*
+ * Hooks called by the core, a NULL latency means it's not measured
+ * */
+
+static inline bool latency_is_awaiting_draw(const latency *lat)
+{
+    return lat && lat->usec_awaiting_draw;
+}
+
+static inline bool latency_is_awaiting_show(const latency *lat)
+{
+    return lat && lat->usec_awaiting_show;
+}
+
+#endif /* LATENCY_H */
@@ -0,0 +1,179 @@
+/*
+ * pchip-lockstep: differential execution of an engine against the reference
+ * interpreter, see lockstep.h
+ *
+ *   pchip-lockstep [options] <rom>           run a ROM on both
+ *   pchip-lockstep [options] -z count        random programs, seeds from -s on
+ *
+ * Built with -DPCHIP_AOT and a recompiled ROM (make lockstep-recompile) the
+ * candidate is the recompiled code, otherwise the specialized interpreter.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lockstep.h"
+#ifdef PCHIP_AOT
+#include "aot.h"
+#endif
+
+#define DEFAULT_FRAMES 600
+#define RANDOM_ROM_SIZE 256
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [-f frames] [-F] [-x] [-T fixed|vip] [-Q quirks] [-C] [-s seed] <path/to/rom>\n", prog);
+    fprintf(stderr, "       %s [options] -z count\n", prog);
+    fprintf(stderr, "  -f  frames to run, %d by default\n", DEFAULT_FRAMES);
+    fprintf(stderr, "  -F  compare after every frame, not every instruction\n");
+    fprintf(stderr, "  -x, -T, -Q and -C as in pchip\n");
+    fprintf(stderr, "  -s  RND seed, the first random program seed with -z\n");
+    fprintf(stderr, "  -z  run count random programs of valid instructions\n");
+    exit(EXIT_FAILURE);
+}
+
+#ifdef PCHIP_AOT
+static int run_recompiled(chip8 *vm, void *ctx)
+{
+    return aot_run_frame(vm, ctx);
+}
+#endif
+
+static uint8_t *read_rom(const char *path, size_t *size)
+{
+    FILE *in = fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+
+    uint8_t *data = malloc(XOCHIP_MAX_ROM_SIZE_BYTES);
+    if (!data) {
+        fprintf(stderr, "Malloc failure\n");
+        exit(EXIT_FAILURE);
+    }
+    *size = fread(data, 1, XOCHIP_MAX_ROM_SIZE_BYTES, in);
+    if (ferror(in) || fgetc(in) != EOF) {
+        fprintf(stderr, "Failed to read or too big to load: %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    fclose(in);
+
+    return data;
+}
+
+int main(int argc, char *argv[])
+{
+    pchip_config config;
+    pchip_config_default(&config);
+    enum lockstep_granularity granularity = LOCKSTEP_INSTRUCTION;
+    long frames = DEFAULT_FRAMES;
+    long random_count = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "f:FxT:Q:Cs:z:")) != -1) {
+        char *end = NULL;
+        switch (opt) {
+        case 'f':
+            frames = strtol(optarg, &end, 10);
+            if (*end || frames <= 0)
+                usage(argv[0]);
+            break;
+        case 'F':
+            granularity = LOCKSTEP_FRAME;
+            break;
+        case 'x':
+            config.settings.mode = CHIP8_MODE_XOCHIP;
+            break;
+        case 'T':
+            if (strcmp(optarg, "vip") == 0)
+                config.settings.timing = CHIP8_TIMING_VIP;
+            else if (strcmp(optarg, "fixed") == 0)
+                config.settings.timing = CHIP8_TIMING_FIXED;
+            else
+                usage(argv[0]);
+            break;
+        case 'Q':{
+            long quirks = strtol(optarg, &end, 0);
+            if (*end || quirks < 0 || quirks > CHIP8_QUIRK_MASK)
+                usage(argv[0]);
+            config.settings.quirks = quirks;
+            break;
+        }
+        case 'C':
+            config.is_checked = true;
+            break;
+        case 's':
+            config.seed = strtoul(optarg, &end, 0);
+            if (*end)
+                usage(argv[0]);
+            break;
+        case 'z':
+            random_count = strtol(optarg, &end, 10);
+            if (*end || random_count <= 0)
+                usage(argv[0]);
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (argc - optind != (random_count ? 0 : 1))
+        usage(argv[0]);
+
+    lockstep_engine candidate = { .name = "interpreter" };
+    uint8_t *rom = NULL;
+    size_t rom_size = 0;
+    if (!random_count)
+        rom = read_rom(argv[optind], &rom_size);
+
+#ifdef PCHIP_AOT
+    aot *rt = NULL;
+    if (rom && aot_matches(&aot_rom, rom, rom_size)) {
+        if (aot_new(&aot_rom, &rt) != AOT_SUCCESS) {
+            fprintf(stderr, "Failed to init recompiled code\n");
+            exit(EXIT_FAILURE);
+        }
+        candidate = (lockstep_engine){ .name = "recompiled", .run_frame = run_recompiled, .ctx = rt };
+    }
+#endif
+
+    lockstep *ls = NULL;
+    if (lockstep_new(&config, &candidate, granularity, &ls) != LOCKSTEP_SUCCESS) {
+        fprintf(stderr, "Failed to init lockstep\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int exit_code = EXIT_SUCCESS;
+    lockstep_divergence div;
+    for (long i = 0; i < (random_count ? random_count : 1); i++) {
+        uint32_t seed = config.seed + i;
+        int rc = random_count ? lockstep_load_random(ls, seed, RANDOM_ROM_SIZE) : lockstep_load(ls, rom, rom_size);
+        if (rc == LOCKSTEP_SUCCESS)
+            rc = lockstep_run(ls, frames, &div);
+
+        if (rc == LOCKSTEP_DIVERGED) {
+            if (random_count)
+                fprintf(stderr, "Random program, seed %u\n", seed);
+            lockstep_report(ls, &div, stderr);
+            exit_code = EXIT_FAILURE;
+            break;
+        }
+        if (rc == LOCKSTEP_FAIL) {
+            fprintf(stderr, "Failed to run\n");
+            exit_code = EXIT_FAILURE;
+            break;
+        }
+    }
+
+    if (exit_code == EXIT_SUCCESS)
+        printf("No divergence, %ld program(s), %ld frames each\n", random_count ? random_count : 1, frames);
+
+    lockstep_free(ls);
+#ifdef PCHIP_AOT
+    aot_free(rt);
+#endif
+    free(rom);
+    return exit_code;
+}
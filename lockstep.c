@@ -0,0 +1,330 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "lockstep.h"
+#include "disasm.h"
+
+struct lockstep {
+    pchip_config config;
+    lockstep_engine candidate;
+    enum lockstep_granularity granularity;
+
+    keyboard *key;
+    fb_console *ref_display;
+    fb_console *cand_display;
+    chip8 ref;
+    chip8 cand;
+
+    uint64_t frame;
+    uint64_t instructions;
+};
+
+static const char *reg_names[16] = {
+    "V0", "V1", "V2", "V3", "V4", "V5", "V6", "V7",
+    "V8", "V9", "VA", "VB", "VC", "VD", "VE", "VF",
+};
+
+int lockstep_new(const pchip_config *config, const lockstep_engine *candidate,
+                 enum lockstep_granularity granularity, lockstep **ls)
+{
+    *ls = calloc(1, sizeof(**ls));
+    if (!*ls) {
+        fprintf(stderr, "Calloc failure\n");
+        return LOCKSTEP_FAIL;
+    }
+
+    lockstep *l = *ls;
+    l->config = *config;
+    l->granularity = granularity;
+    if (candidate)
+        l->candidate = *candidate;
+    if (!l->candidate.name)
+        l->candidate.name = "interpreter";
+
+    /* Whole frames can only be compared whole */
+    if (l->candidate.run_frame)
+        l->granularity = LOCKSTEP_FRAME;
+
+    if (keyboard_new_virtual(&l->key) != KEYBOARD_SUCCESS ||
+        fb_new_headless(&l->ref_display) != FB_CONSOLE_SUCCESS ||
+        fb_new_headless(&l->cand_display) != FB_CONSOLE_SUCCESS ||
+        lockstep_load(l, NULL, 0) != LOCKSTEP_SUCCESS) {
+        lockstep_free(l);
+        *ls = NULL;
+        return LOCKSTEP_FAIL;
+    }
+
+    return LOCKSTEP_SUCCESS;
+}
+
+void lockstep_free(lockstep *ls)
+{
+    if (!ls)
+        return;
+    fb_free(ls->cand_display);
+    fb_free(ls->ref_display);
+    keyboard_free(ls->key);
+    free(ls);
+}
+
+static int reset(lockstep *ls, chip8 *vm, fb_console *display)
+{
+    if (chip8_reset(vm, ls->key, display) != CHIP8_SUCCESS)
+        return LOCKSTEP_FAIL;
+
+    romdb_settings_apply(&ls->config.settings, vm);
+    chip8_set_checked(vm, ls->config.is_checked);
+    chip8_set_seed(vm, ls->config.seed);
+    return LOCKSTEP_SUCCESS;
+}
+
+int lockstep_load(lockstep *ls, const uint8_t *rom, size_t rom_size)
+{
+    size_t max_rom_size = ls->config.settings.mode == CHIP8_MODE_XOCHIP ?
+        XOCHIP_MAX_ROM_SIZE_BYTES : MAX_ROM_SIZE_BYTES;
+    if (rom_size > max_rom_size)
+        return LOCKSTEP_FAIL;
+
+    if (reset(ls, &ls->ref, ls->ref_display) != LOCKSTEP_SUCCESS ||
+        reset(ls, &ls->cand, ls->cand_display) != LOCKSTEP_SUCCESS)
+        return LOCKSTEP_FAIL;
+
+    ls->ref.exec = chip8_exec_generic;
+    if (ls->candidate.exec)
+        ls->cand.exec = ls->candidate.exec;
+
+    if (rom_size) {
+        memcpy(ls->ref.ram + PROGRAM_START_BYTES, rom, rom_size);
+        memcpy(ls->cand.ram + PROGRAM_START_BYTES, rom, rom_size);
+    }
+    for (int key = 0; key < CHIP8_KEY_COUNT; key++)
+        keyboard_set_key(ls->key, key, false);
+
+    ls->frame = 0;
+    ls->instructions = 0;
+    return LOCKSTEP_SUCCESS;
+}
+
+void lockstep_set_key(lockstep *ls, int key, bool is_pressed)
+{
+    keyboard_set_key(ls->key, key, is_pressed);
+}
+
+static bool differs(lockstep_divergence *div, const char *what, uint32_t index,
+                    uint64_t reference, uint64_t candidate)
+{
+    if (reference == candidate)
+        return false;
+    div->what = what;
+    div->index = index;
+    div->reference = reference;
+    div->candidate = candidate;
+    return true;
+}
+
+bool lockstep_compare(const chip8 *ref, const chip8 *cand, lockstep_divergence *div)
+{
+    for (uint32_t i = 0; i < 16; i++)
+        if (differs(div, reg_names[i], i, ref->regs[i], cand->regs[i]))
+            return true;
+    if (differs(div, "I", 0, ref->I, cand->I) ||
+        differs(div, "PC", 0, ref->PC, cand->PC) ||
+        differs(div, "SP", 0, ref->SP, cand->SP))
+        return true;
+    for (uint32_t i = 0; i < MAX_STACK_DEPTH; i++)
+        if (differs(div, "stack", i, ref->stack[i], cand->stack[i]))
+            return true;
+    if (differs(div, "DT", 0, ref->DT, cand->DT) ||
+        differs(div, "ST", 0, ref->ST, cand->ST) ||
+        differs(div, "fault", 0, ref->fault.kind, cand->fault.kind) ||
+        differs(div, "fault address", 0, ref->fault.address, cand->fault.address) ||
+        differs(div, "RND state", 0, ref->rng_state, cand->rng_state) ||
+        differs(div, "pitch", 0, ref->pitch, cand->pitch) ||
+        differs(div, "tone", 0, ref->is_tone_on, cand->is_tone_on))
+        return true;
+
+    for (uint32_t i = 0; i < AUDIO_PATTERN_BYTES; i++)
+        if (differs(div, "audio pattern", i, ref->audio_pattern[i], cand->audio_pattern[i]))
+            return true;
+
+    uint32_t ram_bytes = ref->mode == CHIP8_MODE_XOCHIP ? XOCHIP_MEMORY_SIZE_BYTES : MEMORY_SIZE_BYTES;
+    if (memcmp(ref->ram, cand->ram, ram_bytes) != 0) {
+        for (uint32_t addr = 0; addr < ram_bytes; addr++)
+            if (differs(div, "RAM", addr, ref->ram[addr], cand->ram[addr]))
+                return true;
+    }
+
+    const fb_console *ref_fb = ref->display, *cand_fb = cand->display;
+    if (differs(div, "fb height", 0, ref_fb->height, cand_fb->height))
+        return true;
+    for (uint32_t plane = 0; plane < FRAMEBUF_PLANES; plane++)
+        for (uint32_t y = 0; y < FRAMEBUF_MAX_HEIGHT; y++)
+            if (differs(div, "fb", plane * FRAMEBUF_MAX_HEIGHT + y, ref_fb->fb[plane][y], cand_fb->fb[plane][y]))
+                return true;
+    if (differs(div, "planes", 0, ref_fb->planes, cand_fb->planes))
+        return true;
+
+    /* The frame scheduler's clock */
+    return differs(div, "cycles left", 0, (uint32_t)ref->cycles_left, (uint32_t)cand->cycles_left) ||
+        differs(div, "usec to CPU tick", 0, ref->usec_to_cpu_tick, cand->usec_to_cpu_tick) ||
+        differs(div, "usec to timer tick", 0, ref->usec_to_timer_tick, cand->usec_to_timer_tick) ||
+        differs(div, "usec elapsed", 0, ref->usec_elapsed, cand->usec_elapsed);
+}
+
+static uint16_t instruction_at(const chip8 *vm)
+{
+    return vm->ram[vm->PC] << 8 | vm->ram[(uint16_t)(vm->PC + 1)];
+}
+
+static int compare_status(lockstep *ls, int ref_rc, int cand_rc, lockstep_divergence *div)
+{
+    if (differs(div, "status", 0, ref_rc, cand_rc) || lockstep_compare(&ls->ref, &ls->cand, div))
+        return LOCKSTEP_DIVERGED;
+    if (ref_rc == CHIP8_FAULT)
+        return LOCKSTEP_FAULT;
+    return LOCKSTEP_SUCCESS;
+}
+
+static int frame_by_instruction(lockstep *ls, lockstep_divergence *div)
+{
+    int ref_rc = chip8_frame_begin(&ls->ref);
+    int cand_rc = chip8_frame_begin(&ls->cand);
+    if (ref_rc != CHIP8_SUCCESS || cand_rc != CHIP8_SUCCESS)
+        return LOCKSTEP_FAIL;
+
+    while (ls->ref.cycles_left > 0 || ls->cand.cycles_left > 0) {
+        div->pc = ls->ref.PC;
+        div->instruction = instruction_at(&ls->ref);
+        div->instructions = ++ls->instructions;
+
+        ref_rc = ls->ref.cycles_left > 0 ? chip8_frame_step(&ls->ref) : CHIP8_SUCCESS;
+        cand_rc = ls->cand.cycles_left > 0 ? chip8_frame_step(&ls->cand) : CHIP8_SUCCESS;
+
+        int rc = compare_status(ls, ref_rc, cand_rc, div);
+        if (rc != LOCKSTEP_SUCCESS)
+            return rc;
+    }
+
+    chip8_frame_end(&ls->ref);
+    chip8_frame_end(&ls->cand);
+    return lockstep_compare(&ls->ref, &ls->cand, div) ? LOCKSTEP_DIVERGED : LOCKSTEP_SUCCESS;
+}
+
+static int whole_frame(lockstep *ls, lockstep_divergence *div)
+{
+    div->pc = ls->ref.PC;
+    div->instruction = instruction_at(&ls->ref);
+    div->instructions = ls->instructions;
+
+    int ref_rc = chip8_run_frame(&ls->ref);
+    int cand_rc = ls->candidate.run_frame ?
+        ls->candidate.run_frame(&ls->cand, ls->candidate.ctx) : chip8_run_frame(&ls->cand);
+    if (ref_rc == CHIP8_FAIL || cand_rc == CHIP8_FAIL)
+        return LOCKSTEP_FAIL;
+
+    return compare_status(ls, ref_rc, cand_rc, div);
+}
+
+int lockstep_frame(lockstep *ls, lockstep_divergence *div)
+{
+    div->frame = ls->frame++;
+    if (ls->granularity == LOCKSTEP_INSTRUCTION)
+        return frame_by_instruction(ls, div);
+    return whole_frame(ls, div);
+}
+
+int lockstep_run(lockstep *ls, uint64_t frames, lockstep_divergence *div)
+{
+    for (uint64_t frame = 0; frame < frames; frame++) {
+        int rc = lockstep_frame(ls, div);
+        if (rc != LOCKSTEP_SUCCESS)
+            return rc;
+    }
+    return LOCKSTEP_SUCCESS;
+}
+
+int lockstep_load_random(lockstep *ls, uint32_t seed, size_t rom_size)
+{
+    enum chip8_mode mode = ls->config.settings.mode;
+    uint8_t *rom = malloc(rom_size + 1);
+    if (!rom) {
+        fprintf(stderr, "Malloc failure\n");
+        return LOCKSTEP_FAIL;
+    }
+
+    /* xorshift32, same as RND */
+    uint32_t s = seed ? seed : 0x9e3779b9;
+    for (size_t i = 0; i < rom_size; i += 2) {
+        uint16_t instruction;
+        do {
+            s ^= s << 13;
+            s ^= s >> 17;
+            s ^= s << 5;
+            instruction = s >> 16;
+        } while (disasm_class(instruction, mode) == DISASM_UNKNOWN);
+        rom[i] = instruction >> 8;
+        rom[i + 1] = instruction & 0xff;
+    }
+
+    int rc = lockstep_load(ls, rom, rom_size);
+    free(rom);
+    return rc;
+}
+
+int lockstep_fuzz(lockstep *ls, const uint8_t *data, size_t size, uint64_t frames,
+                  lockstep_divergence *div)
+{
+    size_t max_rom_size = ls->config.settings.mode == CHIP8_MODE_XOCHIP ?
+        XOCHIP_MAX_ROM_SIZE_BYTES : MAX_ROM_SIZE_BYTES;
+    if (lockstep_load(ls, data, size < max_rom_size ? size : max_rom_size) != LOCKSTEP_SUCCESS)
+        return LOCKSTEP_FAIL;
+
+    /* Some keys held, from the program itself */
+    for (int key = 0; key < CHIP8_KEY_COUNT; key++)
+        lockstep_set_key(ls, key, size && (data[key % size] >> (key % 8)) & 0x1);
+
+    return lockstep_run(ls, frames, div);
+}
+
+const chip8 *lockstep_reference(const lockstep *ls)
+{
+    return &ls->ref;
+}
+
+const chip8 *lockstep_candidate(const lockstep *ls)
+{
+    return &ls->cand;
+}
+
+static void report_registers(const char *title, const chip8 *vm, FILE *out)
+{
+    fprintf(out, "%-10s", title);
+    for (int i = 0; i < 16; i++)
+        fprintf(out, " %.2X", vm->regs[i]);
+    fprintf(out, "  I %.4X PC %.4X SP %.2X DT %.2X ST %.2X\n", vm->I, vm->PC, vm->SP, vm->DT, vm->ST);
+}
+
+void lockstep_report(const lockstep *ls, const lockstep_divergence *div, FILE *out)
+{
+    char text[DISASM_MAX_SIZE];
+    disasm_format(div->instruction, ls->ref.mode, text, sizeof(text));
+
+    fprintf(out, "Divergence, reference vs %s, frame %llu, instruction %llu\n", ls->candidate.name,
+            (unsigned long long)div->frame, (unsigned long long)div->instructions);
+    fprintf(out, "%s at %.4X: %.4X %s\n", ls->granularity == LOCKSTEP_INSTRUCTION ? "After" : "Frame from",
+            div->pc, div->instruction, text);
+    if (strcmp(div->what, "RAM") == 0 || strcmp(div->what, "stack") == 0 ||
+        strcmp(div->what, "fb") == 0 || strcmp(div->what, "audio pattern") == 0)
+        fprintf(out, "%s[%u]", div->what, div->index);
+    else
+        fprintf(out, "%s", div->what);
+    fprintf(out, ": reference %llX, candidate %llX\n",
+            (unsigned long long)div->reference, (unsigned long long)div->candidate);
+
+    fprintf(out, "%-10s", "");
+    for (int i = 0; i < 16; i++)
+        fprintf(out, " V%X", i);
+    fputc('\n', out);
+    report_registers("reference", &ls->ref, out);
+    report_registers("candidate", &ls->cand, out);
+}
@@ -0,0 +1,102 @@
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "chip8.h"
+#include "pchip.h"
+
+/*
+ * Lockstep differential execution
+ *
+ * A reference machine, running chip8_exec_generic(), and a candidate machine
+ * running the engine under test get the same program, settings, RND seed and
+ * keys. Architectural state - registers, I, PC, SP, the stack, timers, RAM,
+ * the framebuffer, faults - and the frame scheduler's clock are compared
+ * after every instruction or every frame, the first difference is reported.
+ *
+ * An engine is either an interpreter core, stepped by the frame scheduler
+ * like the stock one, or something that only runs whole frames, e.g.
+ * aot_run_frame(). Without either the candidate is the stock interpreter
+ * instance specialized for the settings.
+ */
+
+enum lockstep_status {
+    LOCKSTEP_SUCCESS,
+    /* Machines differ, see the divergence */
+    LOCKSTEP_DIVERGED,
+    /* Both faulted the same way, nothing more to run */
+    LOCKSTEP_FAULT,
+    LOCKSTEP_FAIL,
+};
+
+enum lockstep_granularity {
+    LOCKSTEP_INSTRUCTION,
+    LOCKSTEP_FRAME,
+};
+
+typedef struct lockstep_engine {
+    const char *name;
+    chip8_exec_fn exec;
+    int (*run_frame)(chip8 *vm, void *ctx);
+    void *ctx;
+} lockstep_engine;
+
+typedef struct lockstep_divergence {
+    uint64_t frame;
+    /* Reference instructions, the diverging one included */
+    uint64_t instructions;
+    /* Reference PC and instruction before the step, frame granularity: the
+     * PC the frame started at */
+    uint16_t pc;
+    uint16_t instruction;
+
+    /* What differs first: "V3", "I", "RAM", "fb", ... */
+    const char *what;
+    /* Register, stack slot or RAM address, plane * FRAMEBUF_MAX_HEIGHT + row */
+    uint32_t index;
+    uint64_t reference;
+    uint64_t candidate;
+} lockstep_divergence;
+
+typedef struct lockstep lockstep;
+
+int lockstep_new(const pchip_config *config, const lockstep_engine *candidate,
+                 enum lockstep_granularity granularity, lockstep **ls);
+
+void lockstep_free(lockstep *ls);
+
+/* Reset both machines and load the program */
+int lockstep_load(lockstep *ls, const uint8_t *rom, size_t rom_size);
+
+/* Keys seen by both machines */
+void lockstep_set_key(lockstep *ls, int key, bool is_pressed);
+
+/* Run a frame on both machines, enum lockstep_status */
+int lockstep_frame(lockstep *ls, lockstep_divergence *div);
+
+/* Run up to frames, stop at a divergence or a fault */
+int lockstep_run(lockstep *ls, uint64_t frames, lockstep_divergence *div);
+
+/* Load a random program of valid instructions for the mode from seed */
+int lockstep_load_random(lockstep *ls, uint32_t seed, size_t rom_size);
+
+/* Fuzz target: data is the program, up to frames are run. LOCKSTEP_FAULT is
+ * as good as LOCKSTEP_SUCCESS here. */
+int lockstep_fuzz(lockstep *ls, const uint8_t *data, size_t size, uint64_t frames,
+                  lockstep_divergence *div);
+
+/* First difference between two machines, false if there is none */
+bool lockstep_compare(const chip8 *ref, const chip8 *cand, lockstep_divergence *div);
+
+const chip8 *lockstep_reference(const lockstep *ls);
+
+const chip8 *lockstep_candidate(const lockstep *ls);
+
+/* Where it happened, what differs and both machines' registers */
+void lockstep_report(const lockstep *ls, const lockstep_divergence *div, FILE *out);
+
+#endif /* LOCKSTEP_H */
@@ -7,38 +7,317 @@
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <signal.h>
+#include <time.h>
 
 #include "chip8.h"
+#include "profile.h"
+#include "romdb.h"
+#include "stream.h"
+#include "shm-export.h"
+#include "debugger.h"
+#include "history.h"
+#include "fast-forward.h"
+#include "run-ahead.h"
+#include "latency.h"
+#include "telemetry.h"
+#ifdef PCHIP_AOT
+#include "aot.h"
+#endif
 
+static volatile sig_atomic_t is_running = 1;
+static volatile sig_atomic_t is_report_requested = 0;
 
-int main(int argc, char *argv[])
+static void stop(int signum)
 {
-    if (argc != 3){
-        fprintf(stderr, "Usage: %s <path/to/rom> <path/to/keyboard/dev>\n", argv[0]);
-        exit(EXIT_FAILURE);
+    (void)signum;
+    is_running = 0;
+}
+
+static void request_reports(int signum)
+{
+    (void)signum;
+    is_report_requested = 1;
+}
+
+static void dump_profile(chip8 *vm, const char *path)
+{
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        perror("fopen");
+        return;
     }
-    const char *rom_path = argv[1];
-    const char *keyboard_path = argv[2];
+    profile_report(vm->prof, vm->ram, vm->mode, out);
+    fclose(out);
+}
 
-    struct stat sb;
-    if (stat(rom_path, &sb) == -1) {
-        perror("lstat");
-        exit(EXIT_FAILURE);
+static void dump_latency(latency *lat, const char *path)
+{
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        perror("fopen");
+        return;
     }
+    latency_report(lat, out);
+    fclose(out);
+}
 
-    if ((sb.st_mode & S_IFMT) != S_IFREG) {
-        fprintf(stderr, "ROM file expected: %s\n", rom_path);
-        exit(EXIT_FAILURE);
+static void dump_telemetry(telemetry *tel, const fb_console *display, const char *path)
+{
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        perror("fopen");
+        return;
     }
+    telemetry_report(tel, out);
 
-    if (sb.st_size > MAX_ROM_SIZE_BYTES) {
-        fprintf(stderr, "Too big to load:  %s\n", rom_path);
-        exit(EXIT_FAILURE);
+    fb_output_counters counters;
+    fb_get_output_counters(display, &counters);
+    fprintf(out, "Terminal: %llu frames written, %llu dropped, %llu writes blocked\n",
+            (unsigned long long)counters.frames_written, (unsigned long long)counters.frames_dropped,
+            (unsigned long long)counters.writes_blocked);
+    fclose(out);
+}
+
+static bool is_host_key_pressed(keyboard *key, enum keyboard_host_key host_key)
+{
+    bool is_pressed = false;
+    if (keyboard_flush(key) == KEYBOARD_SUCCESS)
+        keyboard_is_host_key_pressed(key, host_key, &is_pressed);
+    return is_pressed;
+}
+
+static uint64_t usec_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * USECONDS_PER_SECOND + now.tv_nsec / 1000;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [-x] [-w out.wav] [-p player-cmd] [-P report] [-T fixed|vip] [-Q quirks] [-C] [-D roms.db] [-S socket] [-M shm-name] [-G port] [-R seconds] [-F speed|max] [-L frames] [-I report] [-H report] <path/to/rom> <path/to/keyboard/dev>\n", prog);
+    fprintf(stderr, "       %s [options] -A roms.pack <rom-hash> <path/to/keyboard/dev>\n", prog);
+    fprintf(stderr, "  -x  XO-CHIP mode\n");
+    fprintf(stderr, "  -w  write sound to a WAV file\n");
+    fprintf(stderr, "  -p  pipe sound into a player, e.g. \"aplay -q -f S16_LE -r %d -c 1\"\n",
+            AUDIO_SAMPLE_RATE);
+    fprintf(stderr, "  -P  profile the ROM, write a report on exit and on SIGUSR1\n");
+    fprintf(stderr, "  -T  instruction timing: fixed %dHz (default) or COSMAC VIP cycles\n",
+            FREQUENCY_CPU);
+    fprintf(stderr, "  -Q  enum chip8_quirk mask: 0x1 shift Vy, 0x2 FX55/FX65 increment I,\n"
+            "      0x4 VF reset, 0x8 clip sprites, 0x10 BXNN\n");
+    fprintf(stderr, "  -C  checked mode, stop on guest faults instead of masking them\n");
+    fprintf(stderr, "  -D  ROM settings database, see pchip-romdb\n");
+    fprintf(stderr, "  -A  run a ROM from a pack, settings included\n");
+    fprintf(stderr, "  -S  stream frames to subscribers on a Unix socket, see pchip-watch\n");
+    fprintf(stderr, "  -M  export frames and keys to POSIX shared memory, e.g. /pchip\n");
+    fprintf(stderr, "  -G  serve GDB on a localhost port, the machine stops when it attaches\n");
+    fprintf(stderr, "  -R  keep seconds of history, hold Backspace to rewind\n");
+    fprintf(stderr, "  -F  start fast-forwarding at up to %dx or max speed, Tab toggles it\n",
+            FAST_FORWARD_MAX_SPEED);
+    fprintf(stderr, "  -L  show frames up to %d ahead to hide input latency\n", RUN_AHEAD_MAX_FRAMES);
+    fprintf(stderr, "  -I  measure input to display latency, write a report on exit and on SIGUSR1\n");
+    fprintf(stderr, "  -H  measure host scheduling, write a report on exit and on SIGUSR1\n");
+    fprintf(stderr, "  -x, -T and -Q override ROM settings\n");
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[])
+{
+    /* Negative unless forced on the command line */
+    int mode = -1;
+    int timing = -1;
+    long quirks = -1;
+    const char *wav_path = NULL;
+    const char *player_command = NULL;
+    const char *profile_path = NULL;
+    const char *latency_path = NULL;
+    const char *telemetry_path = NULL;
+    const char *db_path = NULL;
+    const char *pack_path = NULL;
+    const char *stream_path = NULL;
+    const char *shm_name = NULL;
+    long gdb_port = -1;
+    long rewind_seconds = 0;
+    long fast_forward_speed = FAST_FORWARD_UNLIMITED;
+    bool is_fast_forward = false;
+    long run_ahead_frames = 0;
+    bool is_checked = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "xw:p:P:T:Q:CD:A:S:M:G:R:F:L:I:H:")) != -1) {
+        switch (opt) {
+        case 'x':
+            mode = CHIP8_MODE_XOCHIP;
+            break;
+        case 'w':
+            wav_path = optarg;
+            break;
+        case 'p':
+            player_command = optarg;
+            break;
+        case 'P':
+            profile_path = optarg;
+            break;
+        case 'I':
+            latency_path = optarg;
+            break;
+        case 'H':
+            telemetry_path = optarg;
+            break;
+        case 'T':
+            if (strcmp(optarg, "vip") == 0)
+                timing = CHIP8_TIMING_VIP;
+            else if (strcmp(optarg, "fixed") == 0)
+                timing = CHIP8_TIMING_FIXED;
+            else
+                usage(argv[0]);
+            break;
+        case 'Q':{
+            char *end = NULL;
+            quirks = strtol(optarg, &end, 0);
+            if (*end || quirks < 0 || quirks > CHIP8_QUIRK_MASK)
+                usage(argv[0]);
+            break;
+        }
+        case 'C':
+            is_checked = true;
+            break;
+        case 'D':
+            db_path = optarg;
+            break;
+        case 'A':
+            pack_path = optarg;
+            break;
+        case 'S':
+            stream_path = optarg;
+            break;
+        case 'M':
+            shm_name = optarg;
+            break;
+        case 'G':{
+            char *end = NULL;
+            gdb_port = strtol(optarg, &end, 10);
+            if (*end || gdb_port < 0 || gdb_port > UINT16_MAX)
+                usage(argv[0]);
+            break;
+        }
+        case 'R':{
+            char *end = NULL;
+            rewind_seconds = strtol(optarg, &end, 10);
+            if (*end || rewind_seconds <= 0 || rewind_seconds > 3600)
+                usage(argv[0]);
+            break;
+        }
+        case 'F':{
+            char *end = NULL;
+            is_fast_forward = true;
+            if (strcmp(optarg, "max") == 0)
+                break;
+            fast_forward_speed = strtol(optarg, &end, 10);
+            if (*end || fast_forward_speed < 2 || fast_forward_speed > FAST_FORWARD_MAX_SPEED)
+                usage(argv[0]);
+            break;
+        }
+        case 'L':{
+            char *end = NULL;
+            run_ahead_frames = strtol(optarg, &end, 10);
+            if (*end || run_ahead_frames <= 0 || run_ahead_frames > RUN_AHEAD_MAX_FRAMES)
+                usage(argv[0]);
+            break;
+        }
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if (argc - optind != 2)
+        usage(argv[0]);
+    const char *rom_path = argv[optind];
+    const char *keyboard_path = argv[optind + 1];
+
+    /* ROM either straight from a pack mapping or read from a file */
+    romdb_pack *pack = NULL;
+    const uint8_t *rom = NULL;
+    size_t rom_size = 0;
+    uint8_t *rom_file = NULL;
+    romdb_settings settings;
+    romdb_settings_default(&settings);
+
+    if (pack_path) {
+        if (romdb_pack_open(pack_path, &pack) != ROMDB_SUCCESS)
+            exit(EXIT_FAILURE);
+
+        char *end = NULL;
+        uint64_t hash = strtoull(rom_path, &end, 16);
+        const romdb_pack_entry *entry = NULL;
+        if (strlen(rom_path) == ROMDB_HASH_CHARS && !*end)
+            entry = romdb_pack_find(pack, hash);
+        if (!entry) {
+            fprintf(stderr, "No such ROM in %s: %s\n", pack_path, rom_path);
+            exit(EXIT_FAILURE);
+        }
+        rom = romdb_pack_rom(pack, entry);
+        rom_size = entry->size;
+        settings = entry->settings;
+    } else {
+        struct stat sb;
+        if (stat(rom_path, &sb) == -1) {
+            perror("lstat");
+            exit(EXIT_FAILURE);
+        }
+
+        if ((sb.st_mode & S_IFMT) != S_IFREG) {
+            fprintf(stderr, "ROM file expected: %s\n", rom_path);
+            exit(EXIT_FAILURE);
+        }
+
+        if (sb.st_size > XOCHIP_MAX_ROM_SIZE_BYTES) {
+            fprintf(stderr, "Too big to load:  %s\n", rom_path);
+            exit(EXIT_FAILURE);
+        }
+
+        int rom_fd = open(rom_path, O_RDONLY);
+        if (rom_fd == -1) {
+            perror("open");
+            exit(EXIT_FAILURE);
+        }
+
+        rom_file = malloc(sb.st_size + 1);
+        if (!rom_file) {
+            fprintf(stderr, "Malloc failure\n");
+            exit(EXIT_FAILURE);
+        }
+        ssize_t bytes_read = read(rom_fd, rom_file, (size_t)sb.st_size);
+        if (bytes_read != sb.st_size) {
+            perror("read");
+            exit(EXIT_FAILURE);
+        }
+        close(rom_fd);
+
+        rom = rom_file;
+        rom_size = (size_t)bytes_read;
     }
 
-    int rom_fd = open(rom_path, O_RDONLY);
-    if (rom_fd == -1) {
-        perror("open");
+    romdb *db = NULL;
+    if (db_path) {
+        if (romdb_load(db_path, &db) != ROMDB_SUCCESS)
+            exit(EXIT_FAILURE);
+        romdb_lookup(db, romdb_hash(rom, rom_size), &settings);
+        romdb_free(db);
+    }
+
+    if (mode >= 0)
+        settings.mode = mode;
+    if (timing >= 0)
+        settings.timing = timing;
+    if (quirks >= 0)
+        settings.quirks = quirks;
+
+    size_t max_rom_size = settings.mode == CHIP8_MODE_XOCHIP ? XOCHIP_MAX_ROM_SIZE_BYTES : MAX_ROM_SIZE_BYTES;
+    if (rom_size > max_rom_size) {
+        fprintf(stderr, "Too big to load:  %s\n", rom_path);
         exit(EXIT_FAILURE);
     }
 
@@ -56,29 +335,262 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    audio *sound = NULL;
+    if (wav_path || player_command) {
+        audio_sink *sink = NULL;
+        if (wav_path)
+            rc = audio_sink_wav_new(wav_path, &sink);
+        else
+            rc = audio_sink_pipe_new(player_command, &sink);
+        if (rc == AUDIO_SUCCESS)
+            rc = audio_new(sink, &sound);
+        if (rc != AUDIO_SUCCESS) {
+            fprintf(stderr, "Failed to init audio\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    profile *prof = NULL;
+    if (profile_path && profile_new(&prof) != PROFILE_SUCCESS) {
+        fprintf(stderr, "Failed to init profiler\n");
+        exit(EXIT_FAILURE);
+    }
+
+    latency *lat = NULL;
+    if (latency_path && latency_new(&lat) != LATENCY_SUCCESS) {
+        fprintf(stderr, "Failed to init latency measurement\n");
+        exit(EXIT_FAILURE);
+    }
+
+    telemetry *tel = NULL;
+    if (telemetry_path && telemetry_new(usec_now(), &tel) != TELEMETRY_SUCCESS) {
+        fprintf(stderr, "Failed to init scheduling telemetry\n");
+        exit(EXIT_FAILURE);
+    }
+
+    stream *srv = NULL;
+    if (stream_path && stream_new(stream_path, &srv) != STREAM_SUCCESS) {
+        fprintf(stderr, "Failed to init frame stream: %s\n", stream_path);
+        exit(EXIT_FAILURE);
+    }
+
+    shm_export *ex = NULL;
+    if (shm_name && shm_export_new(shm_name, &ex) != SHM_EXPORT_SUCCESS) {
+        fprintf(stderr, "Failed to init shared memory export: %s\n", shm_name);
+        exit(EXIT_FAILURE);
+    }
+
+    debugger *dbg = NULL;
+    if (gdb_port >= 0) {
+        if (debugger_new(gdb_port, &dbg) != DEBUGGER_SUCCESS) {
+            fprintf(stderr, "Failed to init debugger\n");
+            exit(EXIT_FAILURE);
+        }
+        fprintf(stderr, "GDB stub listening on localhost:%u\n", debugger_port(dbg));
+    }
+
+    history *hist = NULL;
+    if (rewind_seconds && history_new(HISTORY_DEFAULT_BUDGET_BYTES, rewind_seconds * FREQUENCY_TIMER,
+                                      HISTORY_DEFAULT_KEYFRAME_INTERVAL, &hist) != HISTORY_SUCCESS) {
+        fprintf(stderr, "Failed to init rewind history\n");
+        exit(EXIT_FAILURE);
+    }
+
+    run_ahead *ra = NULL;
+    if (run_ahead_frames && run_ahead_new(run_ahead_frames, &ra) != RUN_AHEAD_SUCCESS) {
+        fprintf(stderr, "Failed to init run-ahead\n");
+        exit(EXIT_FAILURE);
+    }
+
     chip8 vm;
-    chip8_reset(&vm, key, display);
+    if (chip8_reset(&vm, key, display) != CHIP8_SUCCESS) {
+        fprintf(stderr, "keyboard failure\n");
+        exit(EXIT_FAILURE);
+    }
+    romdb_settings_apply(&settings, &vm);
+    chip8_set_checked(&vm, is_checked);
+    chip8_set_audio(&vm, sound);
+    chip8_set_profile(&vm, prof);
+    chip8_set_latency(&vm, lat);
+
+    memcpy(vm.ram + PROGRAM_START_BYTES, rom, rom_size);
+    free(rom_file);
+    romdb_pack_close(pack);
 
-    ssize_t bytes_read = read(rom_fd, vm.ram + PROGRAM_START_BYTES, (size_t)sb.st_size);
-    if (bytes_read != sb.st_size) {
-        perror("read");
+#ifdef PCHIP_AOT
+    aot *rt = NULL;
+    if (!aot_matches(&aot_rom, vm.ram + PROGRAM_START_BYTES, rom_size)) {
+        fprintf(stderr, "Not the recompiled ROM, interpreting: %s\n", rom_path);
+    } else if (aot_new(&aot_rom, &rt) != AOT_SUCCESS) {
+        fprintf(stderr, "Failed to init recompiled code\n");
         exit(EXIT_FAILURE);
     }
+#endif
 
     /*
      * main loop
      * */
 
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+    signal(SIGUSR1, request_reports);
+
     chip8_redraw(&vm);
 
-    for (;;) {
-        chip8_cpu_tick(&vm);
-        chip8_timers_tick(&vm);
-        chip8_redraw(&vm);
+    /* One frame of work per wakeup, deadlines are absolute so that time
+     * spent emulating and rendering doesn't accumulate as drift */
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    fast_forward ff;
+    fast_forward_init(&ff, fast_forward_speed, usec_now());
+    ff.is_on = is_fast_forward;
+    bool was_fast_forward_pressed = false;
+
+    int exit_code = EXIT_SUCCESS;
+    while (is_running) {
+        telemetry_enter(tel, TELEMETRY_INPUT, usec_now());
+
+        /* Tab toggles on press */
+        bool is_fast_forward_pressed = is_host_key_pressed(vm.key, KEYBOARD_HOST_FAST_FORWARD);
+        if (is_fast_forward_pressed && !was_fast_forward_pressed)
+            ff.is_on = !ff.is_on;
+        was_fast_forward_pressed = is_fast_forward_pressed;
+
+        int frame_rc = CHIP8_SUCCESS;
+        uint32_t frames_run = 0;
+        bool is_rewinding = hist && is_host_key_pressed(vm.key, KEYBOARD_HOST_REWIND);
+        telemetry_enter(tel, TELEMETRY_EXECUTE, usec_now());
+        fast_forward_begin_tick(&ff, usec_now());
+        if (is_rewinding) {
+            /* Held Backspace goes back a frame per tick */
+            history_step_back(hist, &vm);
+            frames_run = 1;
+        } else {
+            do {
+                if (dbg)
+                    frame_rc = debugger_run_frame(dbg, &vm);
+                else
+#ifdef PCHIP_AOT
+                if (rt)
+                    frame_rc = aot_run_frame(&vm, rt);
+                else
+#endif
+                frame_rc = chip8_run_frame(&vm);
+                frames_run++;
+
+                /* Only whole frames go into the history */
+                bool is_frame_done = !dbg || (!debugger_is_stopped(dbg) && !debugger_is_in_frame(dbg));
+                if (hist && frame_rc != CHIP8_FAULT && frame_rc != CHIP8_FAIL && is_frame_done)
+                    history_capture(hist, &vm);
+            } while (frame_rc != CHIP8_FAULT && frame_rc != CHIP8_FAIL && is_running &&
+                     !(dbg && debugger_is_stopped(dbg)) &&
+                     fast_forward_is_frame_due(&ff, frames_run, usec_now()));
+        }
 
-        uint32_t usec_to_next = chip8_tick(&vm);
-        usleep(usec_to_next);
+        if (frame_rc == CHIP8_FAIL) {
+            fprintf(stderr, "keyboard failure\n");
+            exit_code = EXIT_FAILURE;
+            break;
+        }
+
+        /* A fault is always shown, otherwise only what the output keeps up with */
+        if (fast_forward_end_tick(&ff, frames_run, usec_now()) || frame_rc == CHIP8_FAULT) {
+            /* Neither a fault nor a stopped machine is shown in the future */
+            bool is_running_ahead = ra && !is_rewinding && frame_rc != CHIP8_FAULT &&
+                !(dbg && debugger_is_stopped(dbg));
+            if (is_running_ahead && run_ahead_begin(ra, &vm) == CHIP8_FAIL) {
+                fprintf(stderr, "keyboard failure\n");
+                exit_code = EXIT_FAILURE;
+                break;
+            }
+
+            uint64_t usec_present_start = usec_now();
+            telemetry_enter(tel, TELEMETRY_RENDER, usec_present_start);
+            bool is_dirty = vm.display->is_dirty;
+            char status[32] = "";
+            if (ff.is_on)
+                snprintf(status, sizeof(status), "fast-forward %.1fx", ff.effective_speed);
+            fb_set_status(vm.display, status);
+            if (chip8_redraw(&vm) == CHIP8_FAIL) {
+                fprintf(stderr, "keyboard failure\n");
+                exit_code = EXIT_FAILURE;
+                break;
+            }
+            if (srv)
+                stream_publish(srv, vm.display);
+            if (ex) {
+                bool keys[CHIP8_KEY_COUNT] = {0};
+                keyboard_get_key_state(vm.key, keys);
+                shm_export_publish(ex, vm.display, keys);
+            }
+            if (is_dirty)
+                fast_forward_presented(&ff, usec_present_start, usec_now());
+            if (is_running_ahead)
+                run_ahead_end(ra, &vm);
+        }
+
+        if (frame_rc == CHIP8_FAULT) {
+            fprintf(stderr, "Guest fault: %s at PC 0x%.4X, instruction 0x%.4X, address 0x%.4X\n",
+                    chip8_fault_name(vm.fault.kind), vm.fault.pc, vm.fault.instruction,
+                    vm.fault.address);
+            exit_code = EXIT_FAILURE;
+            break;
+        }
+
+        if (is_report_requested) {
+            is_report_requested = 0;
+            if (prof)
+                dump_profile(&vm, profile_path);
+            if (lat)
+                dump_latency(lat, latency_path);
+            if (tel)
+                dump_telemetry(tel, display, telemetry_path);
+        }
+
+        deadline.tv_nsec += USECONDS_PER_STEP_TIMER * 1000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_nsec -= 1000000000;
+            deadline.tv_sec++;
+        }
+        uint64_t usec_deadline = (uint64_t)deadline.tv_sec * USECONDS_PER_SECOND + deadline.tv_nsec / 1000;
+        telemetry_tick_done(tel, usec_deadline, usec_now());
+        telemetry_enter(tel, TELEMETRY_SLEEP, usec_now());
+
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+        uint64_t usec_woken = usec_now();
+        telemetry_wakeup(tel, usec_deadline, usec_woken);
+
+        /* A tick that overran by more than a tick is not caught up with */
+        if (usec_woken > usec_deadline + USECONDS_PER_STEP_TIMER) {
+            telemetry_dropped(tel, usec_woken - usec_deadline);
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+        }
+    }
+
+    if (prof) {
+        dump_profile(&vm, profile_path);
+        profile_free(prof);
+    }
+    if (lat) {
+        dump_latency(lat, latency_path);
+        latency_free(lat);
+    }
+    if (tel) {
+        dump_telemetry(tel, display, telemetry_path);
+        telemetry_free(tel);
     }
+#ifdef PCHIP_AOT
+    aot_free(rt);
+#endif
+    run_ahead_free(ra);
+    history_free(hist);
+    debugger_free(dbg);
+    shm_export_free(ex);
+    stream_free(srv);
+    audio_free(sound);
+    fb_free(display);
+    keyboard_free(key);
 
-    return 0;
+    return exit_code;
 }
@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pchip.h"
+#include "arena.h"
+
+#define PCHIP_DEFAULT_SEED 1
+
+#define ALIGN_UP(bytes) (((bytes) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+struct pchip {
+    pchip_config config;
+    keyboard *key;
+    fb_console *display;
+    chip8 *vm;
+    /* Memory image shared by pooled instances, NULL for pchip_new() ones */
+    const uint8_t *image;
+};
+
+/* Instances one after another, each being its machine, the pchip, the
+ * framebuffer and the keyboard */
+struct pchip_pool {
+    arena *mem;
+    uint8_t *image;
+    uint8_t *instances;
+    size_t stride;
+    size_t count;
+};
+
+void pchip_config_default(pchip_config *config)
+{
+    *config = (pchip_config){ .is_checked = false, .seed = PCHIP_DEFAULT_SEED };
+    romdb_settings_default(&config->settings);
+}
+
+static int reset(pchip *inst)
+{
+    int rc = inst->image ?
+        chip8_reset_shared(inst->vm, inst->key, inst->display, inst->image, inst->config.settings.mode) :
+        chip8_reset(inst->vm, inst->key, inst->display);
+    if (rc != CHIP8_SUCCESS)
+        return PCHIP_FAIL;
+
+    romdb_settings_apply(&inst->config.settings, inst->vm);
+    chip8_set_checked(inst->vm, inst->config.is_checked);
+    chip8_set_seed(inst->vm, inst->config.seed);
+
+    return PCHIP_SUCCESS;
+}
+
+int pchip_new(const pchip_config *config, pchip **inst)
+{
+    *inst = calloc(1, sizeof(**inst));
+    if (!*inst) {
+        fprintf(stderr, "Calloc failure\n");
+        return PCHIP_FAIL;
+    }
+
+    (*inst)->config = *config;
+
+    (*inst)->vm = calloc(1, sizeof(chip8));
+    if (!(*inst)->vm) {
+        fprintf(stderr, "Calloc failure\n");
+        goto err;
+    }
+    if (keyboard_new_virtual(&(*inst)->key) != KEYBOARD_SUCCESS)
+        goto err;
+    if (fb_new_headless(&(*inst)->display) != FB_CONSOLE_SUCCESS)
+        goto err;
+    if (reset(*inst) != PCHIP_SUCCESS)
+        goto err;
+
+    return PCHIP_SUCCESS;
+
+err:
+    pchip_free(*inst);
+    *inst = NULL;
+    return PCHIP_FAIL;
+}
+
+void pchip_free(pchip *inst)
+{
+    /* Pooled instances go with their pool */
+    if (!inst || inst->image)
+        return;
+    fb_free(inst->display);
+    keyboard_free(inst->key);
+    free(inst->vm);
+    free(inst);
+}
+
+int pchip_pool_new(const pchip_config *config, const uint8_t *rom, size_t rom_size,
+                   size_t count, pchip_pool **pool)
+{
+    enum chip8_mode mode = config->settings.mode;
+    size_t max_rom_size = mode == CHIP8_MODE_XOCHIP ? XOCHIP_MAX_ROM_SIZE_BYTES : MAX_ROM_SIZE_BYTES;
+    if (rom_size > max_rom_size)
+        return PCHIP_FAIL;
+
+    *pool = calloc(1, sizeof(**pool));
+    if (!*pool) {
+        fprintf(stderr, "Calloc failure\n");
+        return PCHIP_FAIL;
+    }
+
+    pchip_pool *p = *pool;
+    size_t vm_bytes = ALIGN_UP(CHIP8_COMPACT_BYTES);
+    size_t inst_bytes = ALIGN_UP(sizeof(pchip));
+    size_t fb_bytes = ALIGN_UP(sizeof(fb_console));
+    p->stride = vm_bytes + inst_bytes + fb_bytes + ALIGN_UP(keyboard_virtual_size());
+    p->count = count;
+
+    size_t image_bytes = ALIGN_UP(CHIP8_IMAGE_BYTES(mode));
+    if (count > (SIZE_MAX - image_bytes) / p->stride)
+        goto err;
+    if (arena_new(image_bytes + count * p->stride, &p->mem) != ARENA_SUCCESS)
+        goto err;
+    p->image = arena_alloc(p->mem, image_bytes);
+    p->instances = arena_alloc(p->mem, count * p->stride);
+    chip8_init_image(p->image, mode, rom, rom_size);
+
+    for (size_t i = 0; i < count; i++) {
+        uint8_t *base = p->instances + i * p->stride;
+        pchip *inst = (pchip *)(base + vm_bytes);
+
+        inst->config = *config;
+        /* Independent RND streams */
+        inst->config.seed = config->seed + i;
+        inst->vm = (chip8 *)base;
+        inst->display = (fb_console *)(base + vm_bytes + inst_bytes);
+        inst->key = (keyboard *)(base + vm_bytes + inst_bytes + fb_bytes);
+        inst->image = p->image;
+
+        fb_init_headless(inst->display);
+        keyboard_init_virtual(inst->key);
+        if (reset(inst) != PCHIP_SUCCESS)
+            goto err;
+    }
+
+    return PCHIP_SUCCESS;
+
+err:
+    pchip_pool_free(p);
+    *pool = NULL;
+    return PCHIP_FAIL;
+}
+
+void pchip_pool_free(pchip_pool *pool)
+{
+    if (!pool)
+        return;
+    /* Instances past a failed reset are still zeroed, nothing to release */
+    for (size_t i = 0; pool->instances && i < pool->count; i++)
+        chip8_release_ram(pchip_pool_get(pool, i)->vm);
+    arena_free(pool->mem);
+    free(pool);
+}
+
+size_t pchip_pool_count(const pchip_pool *pool)
+{
+    return pool->count;
+}
+
+pchip *pchip_pool_get(pchip_pool *pool, size_t i)
+{
+    return (pchip *)(pool->instances + i * pool->stride + ALIGN_UP(CHIP8_COMPACT_BYTES));
+}
+
+size_t pchip_pool_bytes(const pchip_pool *pool)
+{
+    size_t bytes = arena_used(pool->mem);
+
+    for (size_t i = 0; i < pool->count; i++) {
+        const chip8 *vm = pchip_pool_get((pchip_pool *)pool, i)->vm;
+        if (!chip8_is_ram_shared(vm))
+            bytes += CHIP8_IMAGE_BYTES(vm->mode);
+    }
+
+    return bytes;
+}
+
+int pchip_load(pchip *inst, const uint8_t *rom, size_t rom_size)
+{
+    size_t max_rom_size = inst->config.settings.mode == CHIP8_MODE_XOCHIP ?
+        XOCHIP_MAX_ROM_SIZE_BYTES : MAX_ROM_SIZE_BYTES;
+    if (rom_size > max_rom_size)
+        return PCHIP_FAIL;
+
+    if (reset(inst) != PCHIP_SUCCESS)
+        return PCHIP_FAIL;
+
+    if (!inst->image) {
+        memcpy(inst->vm->ram + PROGRAM_START_BYTES, rom, rom_size);
+        return PCHIP_SUCCESS;
+    }
+
+    /* Pooled instances take a private copy of the image, rebuilt for the ROM
+     * so that nothing of the pool's one is left */
+    if (chip8_unshare_ram(inst->vm) != CHIP8_SUCCESS)
+        return PCHIP_FAIL;
+    chip8_init_image(inst->vm->ram, inst->vm->mode, rom, rom_size);
+    return PCHIP_SUCCESS;
+}
+
+int pchip_step(pchip *inst)
+{
+    return chip8_exec(inst->vm, chip8_fetch(inst->vm));
+}
+
+int pchip_run_frame(pchip *inst)
+{
+    return chip8_run_frame(inst->vm);
+}
+
+int pchip_run(pchip *inst, uint32_t frames)
+{
+    int rc = CHIP8_SUCCESS;
+
+    for (uint32_t i = 0; i < frames; i++) {
+        rc = chip8_run_frame(inst->vm);
+        if (rc == CHIP8_FAULT || rc == CHIP8_FAIL)
+            break;
+    }
+
+    return rc;
+}
+
+void pchip_set_key(pchip *inst, int key, bool is_pressed)
+{
+    keyboard_set_key(inst->key, key, is_pressed);
+}
+
+void pchip_set_keys(pchip *inst, uint16_t keys)
+{
+    for (int key = 0; key < CHIP8_KEY_COUNT; key++)
+        keyboard_set_key(inst->key, key, keys & (1u << key));
+}
+
+chip8 *pchip_machine(pchip *inst)
+{
+    return inst->vm;
+}
+
+const fb_console *pchip_display(const pchip *inst)
+{
+    return inst->display;
+}
@@ -0,0 +1,84 @@
+#ifndef PCHIP_H
+#define PCHIP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "chip8.h"
+#include "romdb.h"
+
+/*
+ * Embedding API, built into libpchip.a and libpchip.so
+ *
+ * Every instance owns its machine, a virtual keyboard and a headless
+ * framebuffer, there is no mutable state shared between instances so that
+ * they can be run from different threads. Nothing here exits: stepping functions
+ * return enum chip8_status and leave the details in the machine.
+ */
+
+enum pchip_status {
+    PCHIP_SUCCESS,
+    PCHIP_FAIL,
+};
+
+typedef struct pchip_config {
+    romdb_settings settings;
+    bool is_checked;
+    /* RND seed, machines with the same seed and input run the same */
+    uint32_t seed;
+} pchip_config;
+
+typedef struct pchip pchip;
+
+typedef struct pchip_pool pchip_pool;
+
+/* Plain CHIP-8 with default settings, fast mode, a fixed seed */
+void pchip_config_default(pchip_config *config);
+
+int pchip_new(const pchip_config *config, pchip **inst);
+
+/* Nothing for pooled instances, they go with their pool */
+void pchip_free(pchip *inst);
+
+/* Count instances running the same ROM, packed together on huge pages when
+ * available. Instances share the memory image read-only, each one copies it
+ * on its first write to memory. Instance N is seeded with config seed + N. */
+int pchip_pool_new(const pchip_config *config, const uint8_t *rom, size_t rom_size,
+                   size_t count, pchip_pool **pool);
+
+void pchip_pool_free(pchip_pool *pool);
+
+size_t pchip_pool_count(const pchip_pool *pool);
+
+/* Instance N, usable with everything below. Instances are independent of each
+ * other and can be run from different threads. */
+pchip *pchip_pool_get(pchip_pool *pool, size_t i);
+
+/* Memory taken by the pool: instances, the image and private copies */
+size_t pchip_pool_bytes(const pchip_pool *pool);
+
+/* Reset the machine and load a ROM, PCHIP_FAIL if it doesn't fit. Pooled
+ * instances load into a private copy of the image, in the pool's mode. */
+int pchip_load(pchip *inst, const uint8_t *rom, size_t rom_size);
+
+/* A single instruction, timers are only ticked by frames */
+int pchip_step(pchip *inst);
+
+/* chip8_run_frame() on the instance */
+int pchip_run_frame(pchip *inst);
+
+/* Run frames until one of them faults or fails, the status of the last one
+ * run. A halted program keeps going, its timers still tick. */
+int pchip_run(pchip *inst, uint32_t frames);
+
+void pchip_set_key(pchip *inst, int key, bool is_pressed);
+
+/* Bit N for CHIP-8 key N */
+void pchip_set_keys(pchip *inst, uint16_t keys);
+
+chip8 *pchip_machine(pchip *inst);
+
+const fb_console *pchip_display(const pchip *inst);
+
+#endif /* PCHIP_H */
@@ -0,0 +1,156 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "profile.h"
+
+#define HEATMAP_BLOCK_BYTES 64
+#define HEATMAP_ROW_BLOCKS 64   /* 4K per heatmap row */
+
+int profile_new(profile **prof)
+{
+    *prof = calloc(1, sizeof(**prof));
+    if (!*prof) {
+        fprintf(stderr, "Calloc failure\n");
+        return PROFILE_FAIL;
+    }
+    return PROFILE_SUCCESS;
+}
+
+void profile_free(profile *prof)
+{
+    free(prof);
+}
+
+void profile_reset(profile *prof)
+{
+    memset(prof, 0, sizeof(*prof));
+}
+
+void profile_count_instruction(profile *prof, uint16_t pc, uint16_t instruction, enum chip8_mode mode)
+{
+    prof->instructions++;
+    prof->pc_hits[pc]++;
+    prof->class_hits[disasm_class(instruction, mode)]++;
+}
+
+static double percent(uint64_t part, uint64_t total)
+{
+    return total ? 100.0 * part / total : 0.0;
+}
+
+static void report_classes(profile *prof, FILE *out)
+{
+    int order[DISASM_CLASS_COUNT];
+    for (int i = 0; i < DISASM_CLASS_COUNT; i++)
+        order[i] = i;
+
+    /* Insertion sort, the histogram is tiny */
+    for (int i = 1; i < DISASM_CLASS_COUNT; i++) {
+        int cls = order[i];
+        int j = i - 1;
+        for (; j >= 0 && prof->class_hits[order[j]] < prof->class_hits[cls]; j--)
+            order[j + 1] = order[j];
+        order[j + 1] = cls;
+    }
+
+    fprintf(out, "\nOpcode classes:\n");
+    for (int i = 0; i < DISASM_CLASS_COUNT; i++) {
+        uint64_t hits = prof->class_hits[order[i]];
+        if (!hits)
+            break;
+        fprintf(out, "  %-20s %12llu %6.2f%%\n", disasm_class_name(order[i]),
+                (unsigned long long)hits, percent(hits, prof->instructions));
+    }
+}
+
+/* Collect the addresses with the highest counters, sorted hottest first */
+static size_t top_addresses(const uint64_t *counters, uint32_t hot[PROFILE_HOT_PCS])
+{
+    size_t hot_count = 0;
+
+    for (uint32_t addr = 0; addr < PROFILE_ADDRESSES; addr++) {
+        uint64_t hits = counters[addr];
+        if (!hits)
+            continue;
+        if (hot_count == PROFILE_HOT_PCS && counters[hot[hot_count - 1]] >= hits)
+            continue;
+
+        size_t i = hot_count < PROFILE_HOT_PCS ? hot_count++ : hot_count - 1;
+        for (; i > 0 && counters[hot[i - 1]] < hits; i--)
+            hot[i] = hot[i - 1];
+        hot[i] = addr;
+    }
+
+    return hot_count;
+}
+
+static void report_hot_pcs(profile *prof, const uint8_t *ram, enum chip8_mode mode, FILE *out)
+{
+    uint32_t hot[PROFILE_HOT_PCS];
+    size_t hot_count = top_addresses(prof->pc_hits, hot);
+
+    fprintf(out, "\nHot addresses:\n");
+    for (size_t i = 0; i < hot_count; i++) {
+        uint16_t pc = hot[i];
+        uint16_t instruction = (ram[pc] << 8) | ram[(uint16_t)(pc + 1)];
+        char text[DISASM_MAX_SIZE];
+        disasm_format(instruction, mode, text, sizeof(text));
+        fprintf(out, "  0x%.4X %12llu %6.2f%%  %.4X  %s\n", pc,
+                (unsigned long long)prof->pc_hits[pc],
+                percent(prof->pc_hits[pc], prof->instructions), instruction, text);
+    }
+}
+
+/* One character per block of RAM, ' ' for untouched and 1-9 for the order
+ * of magnitude of accesses */
+static void report_heatmap(const uint64_t *counters, const char *title, FILE *out)
+{
+    uint32_t last_used = 0;
+    for (uint32_t addr = 0; addr < PROFILE_ADDRESSES; addr++)
+        if (counters[addr])
+            last_used = addr;
+
+    fprintf(out, "\n%s heatmap (%d bytes per column):\n", title, HEATMAP_BLOCK_BYTES);
+    uint32_t row_bytes = HEATMAP_BLOCK_BYTES * HEATMAP_ROW_BLOCKS;
+    for (uint32_t row = 0; row <= last_used; row += row_bytes) {
+        fprintf(out, "  0x%.4X |", row);
+        for (uint32_t block = row; block < row + row_bytes; block += HEATMAP_BLOCK_BYTES) {
+            uint64_t sum = 0;
+            for (uint32_t addr = block; addr < block + HEATMAP_BLOCK_BYTES; addr++)
+                sum += counters[addr];
+
+            int magnitude = 0;
+            for (; sum; sum /= 10)
+                magnitude++;
+            fputc(magnitude ? '0' + (magnitude > 9 ? 9 : magnitude) : ' ', out);
+        }
+        fprintf(out, "|\n");
+    }
+}
+
+static void report_hot_data(const uint64_t *counters, const char *title, FILE *out)
+{
+    uint32_t hot[PROFILE_HOT_PCS];
+    size_t hot_count = top_addresses(counters, hot);
+
+    fprintf(out, "\nMost %s addresses:\n", title);
+    for (size_t i = 0; i < hot_count; i++)
+        fprintf(out, "  0x%.4X %12llu\n", hot[i], (unsigned long long)counters[hot[i]]);
+}
+
+void profile_report(profile *prof, const uint8_t *ram, enum chip8_mode mode, FILE *out)
+{
+    fprintf(out, "Instructions: %llu\n", (unsigned long long)prof->instructions);
+    fprintf(out, "DRW calls: %llu, bytes drawn: %llu (%.2f per call)\n",
+            (unsigned long long)prof->drw_calls, (unsigned long long)prof->drw_bytes,
+            prof->drw_calls ? (double)prof->drw_bytes / prof->drw_calls : 0.0);
+
+    report_classes(prof, out);
+    report_hot_pcs(prof, ram, mode, out);
+    report_hot_data(prof->ram_reads, "read", out);
+    report_hot_data(prof->ram_writes, "written", out);
+    report_heatmap(prof->ram_reads, "Read", out);
+    report_heatmap(prof->ram_writes, "Write", out);
+
+    fflush(out);
+}
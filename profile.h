@@ -0,0 +1,77 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "disasm.h"
+
+#define PROFILE_ADDRESSES (1 << 16)
+#define PROFILE_HOT_PCS 32      /* Hottest addresses listed in a report */
+
+enum profile_status {
+    PROFILE_SUCCESS,
+    PROFILE_FAIL,
+};
+
+typedef struct profile {
+    uint64_t instructions;
+    uint64_t class_hits[DISASM_CLASS_COUNT];
+
+    uint64_t drw_calls;
+    uint64_t drw_bytes;
+
+    /* Per address counters, data accesses only, fetches are in pc_hits */
+    uint64_t pc_hits[PROFILE_ADDRESSES];
+    uint64_t ram_reads[PROFILE_ADDRESSES];
+    uint64_t ram_writes[PROFILE_ADDRESSES];
+} profile;
+
+int profile_new(profile **prof);
+
+void profile_free(profile *prof);
+
+void profile_reset(profile *prof);
+
+/* Hotspots, opcode histogram, drawing and RAM heatmap with disassembly of
+ * hot addresses taken from ram */
+void profile_report(profile *prof, const uint8_t *ram, enum chip8_mode mode, FILE *out);
+
+/*
+ * Hooks called by the core, a NULL profile means profiling is off
+ * */
+
+void profile_count_instruction(profile *prof, uint16_t pc, uint16_t instruction, enum chip8_mode mode);
+
+static inline void profile_instruction(profile *prof, uint16_t pc, uint16_t instruction, enum chip8_mode mode)
+{
+    if (prof)
+        profile_count_instruction(prof, pc, instruction, mode);
+}
+
+static inline void profile_ram_read(profile *prof, uint16_t addr, uint16_t bytes)
+{
+    if (!prof)
+        return;
+    for (uint16_t i = 0; i < bytes; i++)
+        prof->ram_reads[(uint16_t)(addr + i)]++;
+}
+
+static inline void profile_ram_write(profile *prof, uint16_t addr, uint16_t bytes)
+{
+    if (!prof)
+        return;
+    for (uint16_t i = 0; i < bytes; i++)
+        prof->ram_writes[(uint16_t)(addr + i)]++;
+}
+
+static inline void profile_draw(profile *prof, uint16_t addr, uint16_t bytes)
+{
+    if (!prof)
+        return;
+    prof->drw_calls++;
+    prof->drw_bytes += bytes;
+    profile_ram_read(prof, addr, bytes);
+}
+
+#endif /* PROFILE_H */
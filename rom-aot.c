@@ -0,0 +1,3176 @@
+/* Generated by pchip-aot from roms/hires/Trip8 Hires Demo (2008) [Revival Studios].ch8, do not edit */
+
+#include <stdlib.h>
+
+#include "aot.h"
+
+static const uint8_t rom[] = {
+    0x12, 0x60, 0x01, 0x7A, 0x42, 0x70, 0x22, 0x78, 0x22, 0x52, 0xC4, 0x19,
+    0xF8, 0x00, 0xA0, 0x9B, 0xFA, 0x0E, 0xB0, 0xE2, 0xE2, 0x80, 0xE2, 0x20,
+    0xA0, 0xE2, 0x3C, 0x15, 0x80, 0xE2, 0x20, 0xA0, 0x34, 0x1C, 0x98, 0x32,
+    0x29, 0xAB, 0x2B, 0x8B, 0xB8, 0x88, 0x32, 0x03, 0x7B, 0x28, 0x30, 0x04,
+    0xF8, 0x02, 0xAE, 0x9B, 0xBF, 0xF8, 0x00, 0xAF, 0xF8, 0x00, 0x5F, 0x1F,
+    0x8F, 0x3A, 0x38, 0x2E, 0x8E, 0x3A, 0x38, 0xD4, 0x01, 0x9B, 0xFF, 0x01,
+    0xBB, 0xD4, 0x9B, 0x7C, 0x00, 0xBC, 0x30, 0x86, 0x9C, 0x7C, 0x00, 0xBC,
+    0xFB, 0x10, 0x30, 0xFC, 0x3A, 0xB3, 0x30, 0xD9, 0x02, 0x45, 0x02, 0x30,
+    0x60, 0x12, 0x61, 0xBE, 0xA2, 0x00, 0xF1, 0x55, 0xA2, 0x4A, 0xFD, 0x65,
+    0xA0, 0xE0, 0xFD, 0x55, 0xA2, 0x58, 0xF3, 0x65, 0xA0, 0xFC, 0xF3, 0x55,
+    0xA0, 0x7E, 0x60, 0x3F, 0xF0, 0x55, 0xA0, 0x84, 0x60, 0x30, 0x61, 0xE0,
+    0xF1, 0x55, 0xA0, 0xD7, 0x61, 0xE6, 0xF1, 0x55, 0xA2, 0x5A, 0xF3, 0x65,
+    0xA1, 0xFA, 0xF3, 0x55, 0x60, 0xFA, 0xA0, 0x18, 0xF0, 0x55, 0x60, 0x06,
+    0xA0, 0x0D, 0xF0, 0x55, 0x60, 0x02, 0xA0, 0x0A, 0xF0, 0x55, 0xA0, 0x03,
+    0xF0, 0x55, 0x02, 0xAC, 0xF8, 0x00, 0xB0, 0xA0, 0x9B, 0xB1, 0xD0, 0x52,
+    0x45, 0x56, 0x49, 0x56, 0x41, 0x4C, 0x32, 0x30, 0x31, 0x31, 0x02, 0x30,
+    0x12, 0xD4, 0x52, 0x45, 0x56, 0x49, 0x56, 0x41, 0x4C, 0x53, 0x54, 0x55,
+    0x44, 0x49, 0x4F, 0x53, 0x32, 0x30, 0x30, 0x38, 0x02, 0x30, 0x6D, 0x20,
+    0xFD, 0x15, 0x24, 0x86, 0x24, 0x8E, 0x6D, 0x40, 0xFD, 0x15, 0x24, 0x86,
+    0x24, 0x8E, 0x6D, 0x20, 0xFD, 0x15, 0x24, 0x86, 0xA5, 0x54, 0x24, 0xE6,
+    0x6D, 0x80, 0xFD, 0x15, 0x24, 0x86, 0xA5, 0x54, 0x24, 0xE6, 0x6D, 0x00,
+    0x6B, 0x00, 0x23, 0x82, 0x4B, 0x00, 0x23, 0xA0, 0x4B, 0x01, 0x24, 0x52,
+    0x4B, 0x02, 0x23, 0xA8, 0x4B, 0x03, 0x24, 0x52, 0x4B, 0x04, 0x23, 0xB0,
+    0x4B, 0x05, 0x24, 0x52, 0x60, 0x01, 0xF0, 0x15, 0x24, 0x86, 0x7D, 0x01,
+    0x60, 0x3F, 0x8C, 0xD0, 0x8C, 0x02, 0x4C, 0x00, 0x23, 0x2C, 0x13, 0x00,
+    0x4B, 0x00, 0x23, 0x4C, 0x4B, 0x01, 0x23, 0x88, 0x4B, 0x02, 0x23, 0x5E,
+    0x4B, 0x03, 0x23, 0x90, 0x4B, 0x04, 0x23, 0x70, 0x4B, 0x05, 0x23, 0x98,
+    0x7B, 0x01, 0x4B, 0x06, 0x6B, 0x00, 0x00, 0xEE, 0x23, 0xC4, 0xC9, 0x03,
+    0x89, 0x94, 0x89, 0x94, 0x89, 0x94, 0x89, 0x94, 0x89, 0x94, 0x24, 0x2E,
+    0x00, 0xEE, 0x23, 0xB8, 0xC9, 0x03, 0x89, 0x94, 0x89, 0x94, 0x89, 0x94,
+    0x89, 0x94, 0x89, 0x94, 0x24, 0x2E, 0x00, 0xEE, 0x23, 0xD4, 0xC9, 0x03,
+    0x89, 0x94, 0x89, 0x94, 0x89, 0x94, 0x89, 0x94, 0x89, 0x94, 0x24, 0x2E,
+    0x00, 0xEE, 0x6E, 0x00, 0x23, 0xC4, 0x00, 0xEE, 0x24, 0x2E, 0x6E, 0x00,
+    0x23, 0xB8, 0x00, 0xEE, 0x24, 0x2E, 0x6E, 0x00, 0x23, 0xD4, 0x00, 0xEE,
+    0x24, 0x2E, 0x6E, 0x00, 0x23, 0xC4, 0x00, 0xEE, 0x23, 0xC4, 0x7E, 0x03,
+    0x23, 0xC4, 0x00, 0xEE, 0x23, 0xB8, 0x7E, 0x02, 0x23, 0xB8, 0x00, 0xEE,
+    0x23, 0xD4, 0x7E, 0x02, 0x23, 0xD4, 0x00, 0xEE, 0x6C, 0x00, 0x23, 0xFA,
+    0x23, 0xFA, 0x23, 0xFA, 0x23, 0xFA, 0x00, 0xEE, 0x6C, 0x00, 0x23, 0xE0,
+    0x23, 0xE0, 0x23, 0xE0, 0x23, 0xE0, 0x23, 0xE0, 0x23, 0xE0, 0x00, 0xEE,
+    0x6C, 0x00, 0x24, 0x14, 0x24, 0x14, 0x24, 0x14, 0x24, 0x14, 0x00, 0xEE,
+    0xA6, 0x54, 0xFE, 0x1E, 0xFE, 0x1E, 0xFE, 0x1E, 0xFE, 0x1E, 0xFC, 0x1E,
+    0xF1, 0x65, 0x70, 0x0C, 0x81, 0x14, 0xA5, 0x48, 0xD0, 0x18, 0x7C, 0x02,
+    0x00, 0xEE, 0xA9, 0x54, 0xFE, 0x1E, 0xFE, 0x1E, 0xFE, 0x1E, 0xFE, 0x1E,
+    0xFC, 0x1E, 0xF1, 0x65, 0x70, 0x0C, 0x81, 0x14, 0xA5, 0x48, 0xD0, 0x18,
+    0x7C, 0x02, 0x00, 0xEE, 0xAB, 0x54, 0xFE, 0x1E, 0xFE, 0x1E, 0xFE, 0x1E,
+    0xFE, 0x1E, 0xFC, 0x1E, 0xF1, 0x65, 0x70, 0x0C, 0x81, 0x14, 0xA5, 0x48,
+    0xD0, 0x18, 0x7C, 0x02, 0x00, 0xEE, 0x6C, 0x00, 0x60, 0x1F, 0x8A, 0xD0,
+    0x8A, 0xC4, 0x8A, 0x02, 0x8A, 0x94, 0xAD, 0x54, 0xFA, 0x1E, 0xFA, 0x1E,
+    0xF1, 0x65, 0x80, 0x04, 0x81, 0x14, 0xA5, 0x50, 0xD0, 0x15, 0x7C, 0x01,
+    0x3C, 0x08, 0x14, 0x30, 0x00, 0xEE, 0x60, 0x1F, 0x8A, 0xD0, 0x8A, 0x02,
+    0x8A, 0x94, 0xAD, 0x54, 0xFA, 0x1E, 0xFA, 0x1E, 0xF1, 0x65, 0x80, 0x04,
+    0x81, 0x14, 0xA5, 0x50, 0xD0, 0x15, 0x60, 0x1F, 0x8A, 0xD0, 0x7A, 0x08,
+    0x8A, 0x02, 0x8A, 0x94, 0xAD, 0x54, 0xFA, 0x1E, 0xFA, 0x1E, 0xF1, 0x65,
+    0x80, 0x04, 0x81, 0x14, 0xA5, 0x50, 0xD0, 0x15, 0x00, 0xEE, 0xF0, 0x07,
+    0x30, 0x00, 0x14, 0x86, 0x00, 0xEE, 0x6D, 0x04, 0x61, 0x1D, 0x60, 0x1C,
+    0x62, 0x12, 0xA5, 0x1E, 0xF2, 0x1E, 0xD0, 0x16, 0xFD, 0x15, 0x24, 0x86,
+    0x60, 0x14, 0x62, 0x0C, 0xA5, 0x1E, 0xF2, 0x1E, 0xD0, 0x16, 0x60, 0x24,
+    0x62, 0x18, 0xA5, 0x1E, 0xF2, 0x1E, 0xD0, 0x16, 0xFD, 0x15, 0x24, 0x86,
+    0x60, 0x0C, 0x62, 0x06, 0xA5, 0x1E, 0xF2, 0x1E, 0xD0, 0x16, 0x60, 0x2C,
+    0x62, 0x1E, 0xA5, 0x1E, 0xF2, 0x1E, 0xD0, 0x16, 0xFD, 0x15, 0x24, 0x86,
+    0xA5, 0x1E, 0x60, 0x04, 0xD0, 0x16, 0x60, 0x34, 0x62, 0x24, 0xA5, 0x1E,
+    0xF2, 0x1E, 0xD0, 0x16, 0xFD, 0x15, 0x24, 0x86, 0x00, 0xEE, 0x64, 0x01,
+    0x65, 0x07, 0x62, 0x00, 0x63, 0x00, 0x60, 0x00, 0x81, 0x30, 0x71, 0x10,
+    0xD0, 0x11, 0x71, 0x08, 0xF4, 0x1E, 0xD0, 0x11, 0x71, 0x08, 0xF4, 0x1E,
+    0xD0, 0x11, 0x71, 0x08, 0xF4, 0x1E, 0xD0, 0x11, 0xF4, 0x1E, 0x70, 0x08,
+    0x30, 0x40, 0x14, 0xF0, 0x73, 0x03, 0x83, 0x52, 0x72, 0x01, 0x32, 0x08,
+    0x14, 0xEE, 0x00, 0xEE, 0xFF, 0xFF, 0x00, 0x00, 0x0C, 0x11, 0x11, 0x10,
+    0x00, 0x00, 0x95, 0x55, 0x95, 0xCD, 0x00, 0x00, 0x53, 0x55, 0x55, 0x33,
+    0x40, 0x40, 0x44, 0x42, 0x41, 0x46, 0x00, 0x40, 0x6A, 0x4A, 0x4A, 0x46,
+    0x00, 0x20, 0x69, 0xAA, 0xAA, 0x69, 0x00, 0x00, 0x20, 0x90, 0x88, 0x30,
+    0x38, 0x44, 0xB2, 0xA2, 0x82, 0x82, 0x44, 0x38, 0x20, 0xF8, 0x50, 0x88,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x39, 0x00, 0x00, 0x00, 0x6B, 0x00,
+    0x00, 0x00, 0x5B, 0x00, 0x00, 0x00, 0x1B, 0x00, 0x00, 0x00, 0x1A, 0x00,
+    0x00, 0x00, 0xD9, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x01, 0x00,
+    0x00, 0x7F, 0x7D, 0x00, 0x00, 0xFF, 0xEF, 0x00, 0x00, 0xFD, 0x7B, 0x00,
+    0x00, 0x7F, 0x1B, 0x00, 0x00, 0xF6, 0x1B, 0x00, 0x00, 0x9F, 0xDF, 0x00,
+    0x00, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE1, 0x00, 0x00,
+    0x00, 0x6F, 0x0C, 0x00, 0x00, 0x7B, 0x00, 0x00, 0x00, 0xDB, 0x00, 0x00,
+    0x00, 0xDB, 0x03, 0x00, 0x00, 0xDF, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1D, 0x00, 0x00, 0x00, 0x6B, 0x00,
+    0x00, 0x00, 0x73, 0x00, 0x00, 0x18, 0x1B, 0x00, 0x00, 0x00, 0x1A, 0x00,
+    0x00, 0x00, 0xD9, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x02, 0x00,
+    0x00, 0xE0, 0xF8, 0x00, 0x00, 0x00, 0xEE, 0x00, 0x00, 0x00, 0x3B, 0x00,
+    0x00, 0x18, 0x1B, 0x00, 0x00, 0x00, 0x1B, 0x00, 0x00, 0x19, 0x8F, 0x00,
+    0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x71, 0x00, 0x00,
+    0x00, 0x6B, 0x00, 0x00, 0x00, 0x5B, 0x00, 0x00, 0x00, 0x1B, 0x00, 0x00,
+    0x00, 0x1A, 0x00, 0x00, 0x00, 0xCF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x0D, 0x00, 0x00, 0xFF, 0x6B, 0x00,
+    0x00, 0xFE, 0x63, 0x00, 0x00, 0xBF, 0x1B, 0x00, 0x00, 0xFB, 0x1A, 0x00,
+    0x00, 0x4F, 0xD9, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0xC1, 0x00, 0x00, 0x00, 0x6E, 0x0C, 0x00, 0x00, 0x31, 0x00, 0x00,
+    0x00, 0xD9, 0x00, 0x00, 0x00, 0xDB, 0x03, 0x00, 0x00, 0x99, 0x00, 0x00,
+    0x00, 0x80, 0x00, 0x00, 0x04, 0x05, 0x1B, 0x05, 0x1B, 0x17, 0x04, 0x17,
+    0x07, 0x08, 0x17, 0x08, 0x1C, 0x08, 0x15, 0x1A, 0x06, 0x03, 0x00, 0x14,
+    0x1B, 0x0A, 0x16, 0x16, 0x1A, 0x0A, 0x0E, 0x1A, 0x08, 0x02, 0x00, 0x10,
+    0x1E, 0x0C, 0x15, 0x17, 0x18, 0x0B, 0x08, 0x19, 0x0B, 0x01, 0x00, 0x0D,
+    0x20, 0x0F, 0x13, 0x19, 0x15, 0x0A, 0x03, 0x15, 0x20, 0x12, 0x0E, 0x01,
+    0x10, 0x1A, 0x01, 0x0B, 0x14, 0x08, 0x00, 0x11, 0x1F, 0x14, 0x0D, 0x1B,
+    0x12, 0x01, 0x04, 0x09, 0x15, 0x06, 0x00, 0x0D, 0x1D, 0x16, 0x0A, 0x1B,
+    0x15, 0x03, 0x06, 0x08, 0x18, 0x05, 0x01, 0x09, 0x1C, 0x16, 0x06, 0x19,
+    0x17, 0x05, 0x07, 0x08, 0x1B, 0x05, 0x04, 0x05, 0x1B, 0x17, 0x04, 0x17,
+    0x17, 0x08, 0x08, 0x08, 0x04, 0x14, 0x09, 0x02, 0x1A, 0x18, 0x1E, 0x07,
+    0x05, 0x13, 0x08, 0x07, 0x05, 0x12, 0x0E, 0x01, 0x19, 0x19, 0x1F, 0x0A,
+    0x02, 0x12, 0x08, 0x06, 0x08, 0x12, 0x14, 0x02, 0x18, 0x1A, 0x20, 0x0C,
+    0x00, 0x10, 0x09, 0x05, 0x0A, 0x12, 0x19, 0x04, 0x15, 0x1B, 0x00, 0x0E,
+    0x1F, 0x0E, 0x0B, 0x03, 0x0C, 0x14, 0x1D, 0x08, 0x00, 0x0B, 0x0E, 0x01,
+    0x11, 0x1B, 0x1D, 0x11, 0x0B, 0x17, 0x1F, 0x0D, 0x00, 0x08, 0x12, 0x01,
+    0x0D, 0x1A, 0x1B, 0x12, 0x08, 0x18, 0x1E, 0x12, 0x02, 0x07, 0x17, 0x02,
+    0x0A, 0x17, 0x19, 0x13, 0x1B, 0x17, 0x1B, 0x05, 0x04, 0x17, 0x04, 0x05,
+    0x17, 0x08, 0x17, 0x14, 0x1D, 0x0A, 0x06, 0x04, 0x15, 0x1A, 0x01, 0x15,
+    0x1B, 0x09, 0x0B, 0x05, 0x1B, 0x0E, 0x08, 0x03, 0x0E, 0x1B, 0x00, 0x11,
+    0x1E, 0x0C, 0x10, 0x04, 0x17, 0x12, 0x0A, 0x02, 0x08, 0x1A, 0x1F, 0x0F,
+    0x00, 0x0D, 0x16, 0x04, 0x10, 0x14, 0x0D, 0x02, 0x1E, 0x14, 0x03, 0x16,
+    0x1B, 0x06, 0x02, 0x09, 0x09, 0x13, 0x10, 0x01, 0x1A, 0x18, 0x1F, 0x0A,
+    0x01, 0x12, 0x07, 0x06, 0x04, 0x0F, 0x14, 0x02, 0x13, 0x1B, 0x20, 0x0E,
+    0x01, 0x0E, 0x0D, 0x05, 0x02, 0x0A, 0x18, 0x03, 0x0B, 0x1B, 0x1F, 0x13,
+    0x04, 0x0A, 0x12, 0x05, 0x04, 0x17, 0x04, 0x05, 0x1B, 0x17, 0x1B, 0x05,
+    0x08, 0x14, 0x08, 0x08, 0x15, 0x19, 0x1E, 0x08, 0x00, 0x11, 0x09, 0x02,
+    0x14, 0x17, 0x1B, 0x0C, 0x0E, 0x17, 0x1F, 0x0B, 0x00, 0x0B, 0x0F, 0x01,
+    0x10, 0x1A, 0x1C, 0x10, 0x09, 0x13, 0x1F, 0x0E, 0x02, 0x06, 0x15, 0x02,
+    0x0A, 0x1A, 0x1A, 0x15, 0x08, 0x0E, 0x1F, 0x0F, 0x08, 0x02, 0x05, 0x18,
+    0x1A, 0x05, 0x17, 0x19, 0x0A, 0x09, 0x1E, 0x12, 0x00, 0x14, 0x0E, 0x01,
+    0x11, 0x1B, 0x1C, 0x09, 0x0F, 0x05, 0x1D, 0x14, 0x00, 0x0E, 0x0C, 0x1B,
+    0x13, 0x02, 0x1D, 0x0E, 0x15, 0x04, 0x1C, 0x15, 0x00, 0x0A, 0x07, 0x1A,
+    0x16, 0x05, 0x1B, 0x11, 0x1B, 0x05, 0x04, 0x05, 0x04, 0x17, 0x1B, 0x17,
+    0x18, 0x08, 0x08, 0x08, 0x03, 0x14, 0x0A, 0x02, 0x19, 0x19, 0x1F, 0x08,
+    0x04, 0x12, 0x09, 0x06, 0x05, 0x12, 0x11, 0x02, 0x17, 0x1A, 0x20, 0x0C,
+    0x01, 0x10, 0x0A, 0x05, 0x07, 0x11, 0x17, 0x03, 0x14, 0x1B, 0x00, 0x0D,
+    0x20, 0x0F, 0x0C, 0x03, 0x0A, 0x12, 0x1C, 0x07, 0x00, 0x0A, 0x11, 0x1B,
+    0x0F, 0x02, 0x1E, 0x11, 0x0B, 0x14, 0x1F, 0x0B, 0x00, 0x08, 0x12, 0x01,
+    0x0D, 0x1B, 0x1B, 0x13, 0x0A, 0x16, 0x1F, 0x0F, 0x02, 0x06, 0x15, 0x01,
+    0x0A, 0x19, 0x19, 0x14, 0x07, 0x17, 0x1E, 0x13, 0x03, 0x06, 0x19, 0x03,
+    0x08, 0x17, 0x18, 0x14, 0x1B, 0x05, 0x04, 0x05, 0x1B, 0x17, 0x04, 0x17,
+    0x17, 0x08, 0x08, 0x08, 0x1B, 0x08, 0x16, 0x1A, 0x05, 0x04, 0x01, 0x15,
+    0x1A, 0x09, 0x17, 0x15, 0x1A, 0x0A, 0x11, 0x1B, 0x06, 0x03, 0x00, 0x12,
+    0x1D, 0x0A, 0x17, 0x16, 0x17, 0x0A, 0x0B, 0x1A, 0x07, 0x02, 0x00, 0x10,
+    0x1F, 0x0C, 0x16, 0x17, 0x15, 0x0A, 0x06, 0x18, 0x0A, 0x01, 0x20, 0x0E,
+    0x00, 0x0E, 0x14, 0x19, 0x13, 0x08, 0x02, 0x14, 0x20, 0x11, 0x0E, 0x01,
+    0x11, 0x1B, 0x02, 0x0B, 0x14, 0x05, 0x00, 0x0F, 0x1F, 0x14, 0x0D, 0x1B,
+    0x12, 0x02, 0x04, 0x0A, 0x17, 0x04, 0x01, 0x0A, 0x1D, 0x15, 0x08, 0x1A,
+    0x15, 0x05, 0x06, 0x09, 0x1B, 0x17, 0x1B, 0x05, 0x04, 0x17, 0x04, 0x05,
+    0x18, 0x08, 0x18, 0x14, 0x02, 0x12, 0x19, 0x18, 0x0A, 0x02, 0x1E, 0x07,
+    0x04, 0x13, 0x14, 0x17, 0x04, 0x0E, 0x17, 0x19, 0x11, 0x01, 0x20, 0x0B,
+    0x01, 0x10, 0x0F, 0x18, 0x08, 0x0A, 0x15, 0x1A, 0x17, 0x02, 0x20, 0x0F,
+    0x00, 0x0D, 0x09, 0x18, 0x0F, 0x08, 0x12, 0x1A, 0x01, 0x08, 0x1C, 0x06,
+    0x04, 0x16, 0x1D, 0x13, 0x16, 0x09, 0x0F, 0x1B, 0x05, 0x04, 0x00, 0x12,
+    0x1E, 0x0A, 0x18, 0x16, 0x1B, 0x0D, 0x0B, 0x1A, 0x0C, 0x01, 0x00, 0x0E,
+    0x1E, 0x0E, 0x12, 0x17, 0x1D, 0x12, 0x07, 0x19, 0x14, 0x01, 0x00, 0x09,
+    0x1B, 0x12, 0x0D, 0x17, 0x04, 0x17, 0x04, 0x05, 0x1B, 0x17, 0x1B, 0x05,
+    0x08, 0x14, 0x08, 0x08, 0x0A, 0x03, 0x01, 0x14, 0x1F, 0x0B, 0x16, 0x1A,
+    0x0B, 0x05, 0x04, 0x10, 0x11, 0x05, 0x00, 0x11, 0x20, 0x11, 0x10, 0x1B,
+    0x0F, 0x02, 0x03, 0x0C, 0x16, 0x09, 0x00, 0x0E, 0x1D, 0x16, 0x0A, 0x1A,
+    0x15, 0x02, 0x05, 0x07, 0x17, 0x0E, 0x00, 0x0D, 0x17, 0x1A, 0x1A, 0x04,
+    0x05, 0x17, 0x08, 0x03, 0x15, 0x13, 0x01, 0x0A, 0x1F, 0x08, 0x0E, 0x01,
+    0x11, 0x1B, 0x03, 0x13, 0x10, 0x17, 0x02, 0x08, 0x20, 0x0E, 0x13, 0x01,
+    0x0C, 0x1A, 0x02, 0x0E, 0x0A, 0x18, 0x03, 0x07, 0x1F, 0x12, 0x18, 0x02,
+    0x09, 0x17, 0x04, 0x0B, 0x04, 0x05, 0x1B, 0x05, 0x1B, 0x17, 0x04, 0x17,
+    0x1C, 0x08, 0x15, 0x1A, 0x06, 0x03, 0x00, 0x14, 0x1A, 0x0A, 0x0E, 0x1A,
+    0x08, 0x02, 0x00, 0x10, 0x18, 0x0B, 0x08, 0x19, 0x0B, 0x01, 0x00, 0x0D,
+    0x15, 0x0A, 0x03, 0x15, 0x0E, 0x01, 0x01, 0x0B, 0x14, 0x08, 0x00, 0x11,
+    0x12, 0x01, 0x14, 0x12, 0x15, 0x06, 0x00, 0x0D, 0x13, 0x14, 0x15, 0x03,
+    0x18, 0x05, 0x01, 0x09, 0x11, 0x15, 0x17, 0x05, 0x1B, 0x05, 0x04, 0x05,
+    0x10, 0x15, 0x17, 0x08, 0x09, 0x02, 0x1E, 0x07, 0x0E, 0x15, 0x08, 0x07,
+    0x0E, 0x01, 0x1F, 0x0A, 0x0C, 0x15, 0x08, 0x06, 0x14, 0x02, 0x0B, 0x14,
+    0x20, 0x0C, 0x09, 0x05, 0x19, 0x04, 0x0A, 0x14, 0x1F, 0x0E, 0x0B, 0x03,
+    0x1D, 0x08, 0x08, 0x13, 0x0E, 0x01, 0x1D, 0x11, 0x1F, 0x0D, 0x12, 0x01,
+    0x07, 0x11, 0x1B, 0x12, 0x1E, 0x12, 0x17, 0x02, 0x06, 0x10, 0x19, 0x13,
+    0x1B, 0x17, 0x1B, 0x05, 0x06, 0x0E, 0x17, 0x08, 0x1D, 0x0A, 0x15, 0x1A,
+    0x07, 0x0C, 0x1B, 0x09, 0x1B, 0x0E, 0x0E, 0x1B, 0x08, 0x0A, 0x1E, 0x0C,
+    0x17, 0x12, 0x08, 0x1A, 0x1F, 0x0F, 0x0B, 0x08, 0x10, 0x14, 0x1E, 0x14,
+    0x03, 0x16, 0x0F, 0x07, 0x09, 0x13, 0x1A, 0x18, 0x01, 0x12, 0x12, 0x08,
+    0x04, 0x0F, 0x13, 0x1B, 0x15, 0x09, 0x01, 0x0E, 0x02, 0x0A, 0x0B, 0x1B,
+    0x18, 0x0B, 0x04, 0x0A, 0x04, 0x17, 0x04, 0x05, 0x19, 0x0E, 0x08, 0x14,
+    0x00, 0x11, 0x09, 0x02, 0x18, 0x10, 0x06, 0x12, 0x00, 0x0B, 0x0F, 0x01,
+    0x16, 0x13, 0x05, 0x10, 0x02, 0x06, 0x14, 0x14, 0x15, 0x02, 0x05, 0x0E,
+    0x11, 0x14, 0x08, 0x02, 0x1A, 0x05, 0x05, 0x0D, 0x0E, 0x13, 0x0E, 0x01,
+    0x1C, 0x09, 0x06, 0x0C, 0x0D, 0x11, 0x13, 0x02, 0x1D, 0x0E, 0x06, 0x0A,
+    0x0E, 0x0F, 0x16, 0x05, 0x1B, 0x11, 0x07, 0x09, 0x10, 0x0E, 0x18, 0x08,
+    0x08, 0x08, 0x08, 0x14, 0x12, 0x0E, 0x04, 0x12, 0x09, 0x06, 0x13, 0x16,
+    0x14, 0x0E, 0x01, 0x10, 0x0A, 0x05, 0x0F, 0x16, 0x16, 0x10, 0x00, 0x0D,
+    0x0C, 0x03, 0x0A, 0x15, 0x16, 0x12, 0x00, 0x0A, 0x0F, 0x02, 0x07, 0x13,
+    0x00, 0x08, 0x15, 0x13, 0x12, 0x01, 0x05, 0x10, 0x02, 0x06, 0x15, 0x01,
+    0x13, 0x15, 0x05, 0x0E, 0x03, 0x06, 0x19, 0x03, 0x11, 0x15, 0x05, 0x0B,
+    0x1B, 0x05, 0x04, 0x05, 0x0F, 0x15, 0x17, 0x08, 0x1B, 0x08, 0x05, 0x04,
+    0x0E, 0x15, 0x1A, 0x09, 0x1A, 0x0A, 0x06, 0x03, 0x0C, 0x14, 0x1D, 0x0A,
+    0x17, 0x0A, 0x07, 0x02, 0x1F, 0x0C, 0x0B, 0x14, 0x15, 0x0A, 0x0A, 0x01,
+    0x20, 0x0E, 0x0A, 0x13, 0x13, 0x08, 0x20, 0x11, 0x0E, 0x01, 0x09, 0x12,
+    0x14, 0x05, 0x1F, 0x14, 0x08, 0x11, 0x12, 0x02, 0x17, 0x04, 0x1D, 0x15,
+    0x07, 0x10, 0x15, 0x05, 0x1B, 0x17, 0x1B, 0x05, 0x06, 0x0E, 0x18, 0x08,
+    0x19, 0x18, 0x1E, 0x07, 0x07, 0x0C, 0x14, 0x17, 0x17, 0x19, 0x20, 0x0B,
+    0x08, 0x0A, 0x0F, 0x18, 0x15, 0x1A, 0x0B, 0x08, 0x20, 0x0F, 0x09, 0x18,
+    0x12, 0x1A, 0x0E, 0x07, 0x04, 0x16, 0x1D, 0x13, 0x0F, 0x1B, 0x12, 0x07,
+    0x00, 0x12, 0x18, 0x16, 0x0B, 0x1A, 0x00, 0x0E, 0x16, 0x09, 0x12, 0x17,
+    0x07, 0x19, 0x00, 0x09, 0x18, 0x0B, 0x0D, 0x17, 0x04, 0x17, 0x04, 0x05,
+    0x19, 0x0E, 0x08, 0x14, 0x0A, 0x03, 0x01, 0x14, 0x18, 0x10, 0x0B, 0x05,
+    0x11, 0x05, 0x00, 0x11, 0x16, 0x12, 0x0F, 0x02, 0x16, 0x09, 0x00, 0x0E,
+    0x15, 0x02, 0x13, 0x13, 0x17, 0x0E, 0x00, 0x0D, 0x1A, 0x04, 0x08, 0x03,
+    0x15, 0x13, 0x01, 0x0A, 0x1F, 0x08, 0x0E, 0x01, 0x10, 0x17, 0x02, 0x08,
+    0x20, 0x0E, 0x13, 0x01, 0x0A, 0x18, 0x03, 0x07, 0x1F, 0x12, 0x18, 0x02,
+    0x10, 0x0E, 0x06, 0x07, 0x19, 0x07, 0x19, 0x15, 0x0D, 0x0E, 0x1B, 0x09,
+    0x16, 0x17, 0x09, 0x05, 0x0B, 0x0E, 0x1C, 0x0C, 0x12, 0x18, 0x0D, 0x04,
+    0x1C, 0x0E, 0x09, 0x0C, 0x0E, 0x19, 0x11, 0x04, 0x1B, 0x0E, 0x09, 0x0A,
+    0x0B, 0x18, 0x14, 0x05, 0x1A, 0x0E, 0x07, 0x16, 0x0A, 0x09, 0x14, 0x12,
+    0x1A, 0x0E, 0x05, 0x14, 0x0C, 0x07, 0x13, 0x14, 0x1A, 0x0E, 0x04, 0x11,
+    0x0E, 0x07, 0x11, 0x15, 0x1B, 0x0E, 0x04, 0x0E, 0x10, 0x15, 0x10, 0x07,
+    0x06, 0x0C, 0x1C, 0x0F, 0x0E, 0x15, 0x11, 0x07, 0x0A, 0x0A, 0x1D, 0x10,
+    0x0C, 0x15, 0x13, 0x08, 0x0E, 0x0A, 0x1C, 0x12, 0x0B, 0x14, 0x14, 0x08,
+    0x12, 0x0B, 0x0A, 0x14, 0x1A, 0x14, 0x05, 0x08, 0x15, 0x0E, 0x07, 0x06,
+    0x08, 0x13, 0x17, 0x16, 0x15, 0x11, 0x0A, 0x04, 0x07, 0x11, 0x17, 0x0B,
+    0x13, 0x15, 0x0D, 0x04, 0x06, 0x10, 0x18, 0x0C, 0x10, 0x17, 0x10, 0x05,
+    0x06, 0x0E, 0x19, 0x0E, 0x11, 0x07, 0x0B, 0x17, 0x18, 0x10, 0x07, 0x0C,
+    0x11, 0x09, 0x06, 0x16, 0x17, 0x12, 0x08, 0x0A, 0x10, 0x0A, 0x03, 0x13,
+    0x14, 0x14, 0x1A, 0x0A, 0x0E, 0x0B, 0x11, 0x15, 0x1D, 0x0D, 0x03, 0x0F,
+    0x0D, 0x0A, 0x1D, 0x10, 0x0D, 0x15, 0x12, 0x08, 0x0C, 0x08, 0x1A, 0x14,
+    0x09, 0x13, 0x15, 0x09, 0x0D, 0x06, 0x15, 0x17, 0x07, 0x11, 0x18, 0x0B,
+    0x10, 0x17, 0x10, 0x05, 0x19, 0x0E, 0x06, 0x0E, 0x0A, 0x15, 0x13, 0x05,
+    0x18, 0x10, 0x07, 0x0C, 0x06, 0x10, 0x17, 0x05, 0x16, 0x13, 0x09, 0x0A,
+    0x05, 0x0C, 0x1A, 0x07, 0x14, 0x14, 0x0C, 0x09, 0x08, 0x07, 0x11, 0x14,
+    0x1C, 0x0A, 0x05, 0x11, 0x0C, 0x04, 0x0E, 0x13, 0x1D, 0x0D, 0x04, 0x0F,
+    0x0D, 0x11, 0x11, 0x03, 0x1D, 0x10, 0x03, 0x0D, 0x0E, 0x0F, 0x16, 0x04,
+    0x1B, 0x13, 0x04, 0x09, 0x10, 0x0E, 0x19, 0x07, 0x06, 0x07, 0x06, 0x15,
+    0x12, 0x0E, 0x04, 0x13, 0x09, 0x05, 0x16, 0x17, 0x14, 0x0E, 0x03, 0x10,
+    0x0D, 0x04, 0x12, 0x18, 0x03, 0x0E, 0x16, 0x10, 0x11, 0x03, 0x0E, 0x18,
+    0x04, 0x0E, 0x16, 0x12, 0x14, 0x04, 0x0B, 0x17, 0x05, 0x0E, 0x18, 0x06,
+    0x15, 0x13, 0x0B, 0x0A, 0x05, 0x0E, 0x1A, 0x08, 0x13, 0x15, 0x0C, 0x08,
+    0x05, 0x0E, 0x1B, 0x0B, 0x11, 0x15, 0x0E, 0x07, 0x1B, 0x0E, 0x04, 0x0E,
+    0x0F, 0x15, 0x0F, 0x07, 0x19, 0x10, 0x03, 0x0D, 0x11, 0x07, 0x0E, 0x15,
+    0x15, 0x12, 0x02, 0x0C, 0x13, 0x07, 0x0C, 0x14, 0x11, 0x12, 0x03, 0x0A,
+    0x14, 0x08, 0x0B, 0x14, 0x0D, 0x11, 0x15, 0x08, 0x05, 0x08, 0x1A, 0x14,
+    0x0A, 0x0E, 0x18, 0x16, 0x17, 0x09, 0x08, 0x06, 0x0A, 0x0B, 0x15, 0x18,
+    0x18, 0x0B, 0x08, 0x11, 0x0C, 0x07, 0x12, 0x18, 0x19, 0x0C, 0x07, 0x10,
+    0x10, 0x17, 0x10, 0x05, 0x06, 0x0E, 0x19, 0x0E, 0x0E, 0x15, 0x14, 0x05,
+    0x07, 0x0C, 0x18, 0x10, 0x0E, 0x13, 0x19, 0x06, 0x08, 0x0A, 0x17, 0x12,
+    0x0F, 0x12, 0x1C, 0x09, 0x0B, 0x08, 0x05, 0x12, 0x11, 0x11, 0x0E, 0x07,
+    0x02, 0x0F, 0x1C, 0x0D, 0x12, 0x12, 0x02, 0x0C, 0x12, 0x07, 0x0D, 0x14,
+    0x13, 0x14, 0x05, 0x08, 0x16, 0x09, 0x0A, 0x13, 0x12, 0x16, 0x0A, 0x05,
+    0x18, 0x0B, 0x07, 0x11, 0x0F, 0x17, 0x10, 0x05, 0x19, 0x0E, 0x06, 0x0E,
+    0x15, 0x07, 0x0C, 0x17, 0x07, 0x0C, 0x18, 0x10, 0x19, 0x0C, 0x08, 0x17,
+    0x09, 0x09, 0x16, 0x12, 0x1A, 0x10, 0x05, 0x15, 0x0B, 0x08, 0x13, 0x13,
+    0x17, 0x15, 0x0E, 0x08, 0x03, 0x12, 0x1A, 0x0B, 0x13, 0x18, 0x11, 0x09,
+    0x02, 0x0F, 0x1B, 0x0D, 0x12, 0x0B, 0x0E, 0x19, 0x02, 0x0C, 0x1C, 0x0F,
+    0x11, 0x0D, 0x09, 0x18, 0x04, 0x09, 0x1B, 0x13, 0x10, 0x10, 0x0C, 0x14,
+    0x07, 0x17, 0x04, 0x1A, 0x03, 0x1C, 0x03, 0x1D, 0x05, 0x1D, 0x08, 0x1B,
+    0x0C, 0x19, 0x10, 0x16, 0x14, 0x13, 0x17, 0x10, 0x1A, 0x0D, 0x1B, 0x0A,
+    0x1B, 0x08, 0x19, 0x06, 0x17, 0x05, 0x13, 0x06, 0x10, 0x07, 0x0D, 0x08,
+    0x0A, 0x0B, 0x07, 0x0E, 0x06, 0x10, 0x06, 0x12, 0x08, 0x15, 0x0A, 0x17,
+    0x0D, 0x18, 0x10, 0x19, 0x13, 0x19, 0x16, 0x18, 0x18, 0x17, 0x19, 0x14,
+    0x10, 0x19, 0x0F, 0x17, 0x0D, 0x17, 0x0A, 0x19, 0x06, 0x1A, 0x06, 0x16,
+    0x09, 0x13, 0x09, 0x11, 0x07, 0x10, 0x03, 0x0E, 0x03, 0x0B, 0x08, 0x0B,
+    0x0B, 0x0B, 0x0C, 0x0A, 0x0C, 0x06, 0x0E, 0x02, 0x10, 0x04, 0x11, 0x08,
+    0x12, 0x0A, 0x14, 0x09, 0x19, 0x07, 0x1B, 0x09, 0x19, 0x0D, 0x17, 0x0F,
+    0x17, 0x10, 0x1A, 0x12, 0x1D, 0x15, 0x1A, 0x16, 0x15, 0x15, 0x14, 0x16,
+    0x13, 0x18, 0x12, 0x1D, 0x10, 0x19, 0x0E, 0x17, 0x0D, 0x17, 0x0B, 0x17,
+    0x08, 0x17, 0x05, 0x19, 0x02, 0x19, 0x03, 0x17, 0x08, 0x14, 0x0B, 0x12,
+    0x0E, 0x11, 0x10, 0x10, 0x11, 0x10, 0x14, 0x0E, 0x19, 0x0B, 0x1C, 0x09,
+    0x1C, 0x09, 0x19, 0x09, 0x17, 0x0A, 0x16, 0x0A, 0x14, 0x09, 0x13, 0x07,
+    0x11, 0x04, 0x0F, 0x02, 0x0B, 0x03, 0x09, 0x06, 0x09, 0x09, 0x09, 0x0A,
+    0x09, 0x0B, 0x08, 0x0B, 0x07, 0x0B, 0x07, 0x0B, 0x10, 0x19, 0x13, 0x18,
+    0x15, 0x17, 0x16, 0x16, 0x18, 0x15, 0x18, 0x15, 0x18, 0x14, 0x15, 0x12,
+    0x10, 0x10, 0x0B, 0x0E, 0x09, 0x0C, 0x08, 0x0C, 0x09, 0x0B, 0x0A, 0x0A,
+    0x0B, 0x09, 0x0D, 0x08, 0x10, 0x06, 0x14, 0x04, 0x1A, 0x03, 0x1D, 0x04,
+    0x1C, 0x08, 0x19, 0x0B, 0x15, 0x0D, 0x12, 0x0F, 0x10, 0x10, 0x0D, 0x11,
+    0x0A, 0x13, 0x06, 0x16, 0x03, 0x19, 0x03, 0x1C, 0x07, 0x1C, 0x0C, 0x1A,
+};
+
+static void block_200(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x200: JP 0x260 */
+    vm->PC = 0x200;
+    aot_step(vm, rt, 0x202);
+    return;
+}
+
+static void block_2C0(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x2C0: JP 0x2D4 */
+    vm->PC = 0x2D4;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_2D4(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x2D4: SYS 0x230 */
+    vm->PC = 0x2D4;
+    if (!aot_step(vm, rt, 0x2D6))
+        return;
+
+    /* 0x2D6: LD VD, 0x20 */
+    vm->regs[0xD] = 0x20;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x2D8;
+        return;
+    }
+
+    /* 0x2D8: LD DT, VD */
+    vm->DT = vm->regs[0xD];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x2DA;
+        return;
+    }
+
+    /* 0x2DA: CALL 0x486 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x2DC;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x486;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_2DC(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x2DC: CALL 0x48E */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x2DE;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x48E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_2DE(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x2DE: LD VD, 0x40 */
+    vm->regs[0xD] = 0x40;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x2E0;
+        return;
+    }
+
+    /* 0x2E0: LD DT, VD */
+    vm->DT = vm->regs[0xD];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x2E2;
+        return;
+    }
+
+    /* 0x2E2: CALL 0x486 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x2E4;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x486;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_2E4(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x2E4: CALL 0x48E */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x2E6;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x48E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_2E6(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x2E6: LD VD, 0x20 */
+    vm->regs[0xD] = 0x20;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x2E8;
+        return;
+    }
+
+    /* 0x2E8: LD DT, VD */
+    vm->DT = vm->regs[0xD];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x2EA;
+        return;
+    }
+
+    /* 0x2EA: CALL 0x486 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x2EC;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x486;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_2EC(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x2EC: LD I, 0x554 */
+    vm->I = 0x554;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x2EE;
+        return;
+    }
+
+    /* 0x2EE: CALL 0x4E6 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x2F0;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x4E6;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_2F0(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x2F0: LD VD, 0x80 */
+    vm->regs[0xD] = 0x80;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x2F2;
+        return;
+    }
+
+    /* 0x2F2: LD DT, VD */
+    vm->DT = vm->regs[0xD];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x2F4;
+        return;
+    }
+
+    /* 0x2F4: CALL 0x486 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x2F6;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x486;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_2F6(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x2F6: LD I, 0x554 */
+    vm->I = 0x554;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x2F8;
+        return;
+    }
+
+    /* 0x2F8: CALL 0x4E6 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x2FA;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x4E6;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_2FA(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x2FA: LD VD, 0x00 */
+    vm->regs[0xD] = 0x00;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x2FC;
+        return;
+    }
+
+    /* 0x2FC: LD VB, 0x00 */
+    vm->regs[0xB] = 0x00;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x2FE;
+        return;
+    }
+
+    /* 0x2FE: CALL 0x382 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x300;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x382;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_300(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x300: SNE VB, 0x00 */
+    vm->PC = vm->regs[0xB] != 0x00 ? 0x304 : 0x302;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_302(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x302: CALL 0x3A0 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x304;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3A0;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_304(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x304: SNE VB, 0x01 */
+    vm->PC = vm->regs[0xB] != 0x01 ? 0x308 : 0x306;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_306(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x306: CALL 0x452 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x308;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x452;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_308(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x308: SNE VB, 0x02 */
+    vm->PC = vm->regs[0xB] != 0x02 ? 0x30C : 0x30A;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_30A(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x30A: CALL 0x3A8 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x30C;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3A8;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_30C(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x30C: SNE VB, 0x03 */
+    vm->PC = vm->regs[0xB] != 0x03 ? 0x310 : 0x30E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_30E(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x30E: CALL 0x452 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x310;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x452;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_310(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x310: SNE VB, 0x04 */
+    vm->PC = vm->regs[0xB] != 0x04 ? 0x314 : 0x312;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_312(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x312: CALL 0x3B0 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x314;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3B0;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_314(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x314: SNE VB, 0x05 */
+    vm->PC = vm->regs[0xB] != 0x05 ? 0x318 : 0x316;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_316(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x316: CALL 0x452 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x318;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x452;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_318(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x318: LD V0, 0x01 */
+    vm->regs[0x0] = 0x01;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x31A;
+        return;
+    }
+
+    /* 0x31A: LD DT, V0 */
+    vm->DT = vm->regs[0x0];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x31C;
+        return;
+    }
+
+    /* 0x31C: CALL 0x486 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x31E;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x486;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_31E(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x31E: ADD VD, 0x01 */
+    vm->regs[0xD] += 0x01;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x320;
+        return;
+    }
+
+    /* 0x320: LD V0, 0x3F */
+    vm->regs[0x0] = 0x3F;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x322;
+        return;
+    }
+
+    /* 0x322: LD VC, VD */
+    vm->regs[0xC] = vm->regs[0xD];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x324;
+        return;
+    }
+
+    /* 0x324: AND VC, V0 */
+    vm->regs[0xC] &= vm->regs[0x0];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x326;
+        return;
+    }
+
+    /* 0x326: SNE VC, 0x00 */
+    vm->PC = vm->regs[0xC] != 0x00 ? 0x32A : 0x328;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_328(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x328: CALL 0x32C */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x32A;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x32C;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_32A(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x32A: JP 0x300 */
+    vm->PC = 0x300;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_32C(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x32C: SNE VB, 0x00 */
+    vm->PC = vm->regs[0xB] != 0x00 ? 0x330 : 0x32E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_32E(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x32E: CALL 0x34C */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x330;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x34C;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_330(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x330: SNE VB, 0x01 */
+    vm->PC = vm->regs[0xB] != 0x01 ? 0x334 : 0x332;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_332(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x332: CALL 0x388 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x334;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x388;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_334(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x334: SNE VB, 0x02 */
+    vm->PC = vm->regs[0xB] != 0x02 ? 0x338 : 0x336;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_336(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x336: CALL 0x35E */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x338;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x35E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_338(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x338: SNE VB, 0x03 */
+    vm->PC = vm->regs[0xB] != 0x03 ? 0x33C : 0x33A;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_33A(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x33A: CALL 0x390 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x33C;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x390;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_33C(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x33C: SNE VB, 0x04 */
+    vm->PC = vm->regs[0xB] != 0x04 ? 0x340 : 0x33E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_33E(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x33E: CALL 0x370 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x340;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x370;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_340(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x340: SNE VB, 0x05 */
+    vm->PC = vm->regs[0xB] != 0x05 ? 0x344 : 0x342;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_342(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x342: CALL 0x398 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x344;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x398;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_344(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x344: ADD VB, 0x01 */
+    vm->regs[0xB] += 0x01;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x346;
+        return;
+    }
+
+    /* 0x346: SNE VB, 0x06 */
+    vm->PC = vm->regs[0xB] != 0x06 ? 0x34A : 0x348;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_348(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x348: LD VB, 0x00 */
+    vm->regs[0xB] = 0x00;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    vm->PC = 0x34A;
+    return;
+}
+
+static void block_34A(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x34A: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_34C(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x34C: CALL 0x3C4 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x34E;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3C4;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_34E(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x34E: RND V9, 0x03 */
+    vm->regs[0x9] = chip8_random(vm) & 0x03;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x350;
+        return;
+    }
+
+    /* 0x350: ADD V9, V9 */
+    {
+        uint16_t acc = vm->regs[0x9] + vm->regs[0x9];
+        vm->regs[0x9] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x352;
+        return;
+    }
+
+    /* 0x352: ADD V9, V9 */
+    {
+        uint16_t acc = vm->regs[0x9] + vm->regs[0x9];
+        vm->regs[0x9] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x354;
+        return;
+    }
+
+    /* 0x354: ADD V9, V9 */
+    {
+        uint16_t acc = vm->regs[0x9] + vm->regs[0x9];
+        vm->regs[0x9] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x356;
+        return;
+    }
+
+    /* 0x356: ADD V9, V9 */
+    {
+        uint16_t acc = vm->regs[0x9] + vm->regs[0x9];
+        vm->regs[0x9] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x358;
+        return;
+    }
+
+    /* 0x358: ADD V9, V9 */
+    {
+        uint16_t acc = vm->regs[0x9] + vm->regs[0x9];
+        vm->regs[0x9] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x35A;
+        return;
+    }
+
+    /* 0x35A: CALL 0x42E */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x35C;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x42E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_35C(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x35C: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_35E(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x35E: CALL 0x3B8 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x360;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3B8;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_360(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x360: RND V9, 0x03 */
+    vm->regs[0x9] = chip8_random(vm) & 0x03;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x362;
+        return;
+    }
+
+    /* 0x362: ADD V9, V9 */
+    {
+        uint16_t acc = vm->regs[0x9] + vm->regs[0x9];
+        vm->regs[0x9] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x364;
+        return;
+    }
+
+    /* 0x364: ADD V9, V9 */
+    {
+        uint16_t acc = vm->regs[0x9] + vm->regs[0x9];
+        vm->regs[0x9] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x366;
+        return;
+    }
+
+    /* 0x366: ADD V9, V9 */
+    {
+        uint16_t acc = vm->regs[0x9] + vm->regs[0x9];
+        vm->regs[0x9] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x368;
+        return;
+    }
+
+    /* 0x368: ADD V9, V9 */
+    {
+        uint16_t acc = vm->regs[0x9] + vm->regs[0x9];
+        vm->regs[0x9] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x36A;
+        return;
+    }
+
+    /* 0x36A: ADD V9, V9 */
+    {
+        uint16_t acc = vm->regs[0x9] + vm->regs[0x9];
+        vm->regs[0x9] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x36C;
+        return;
+    }
+
+    /* 0x36C: CALL 0x42E */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x36E;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x42E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_36E(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x36E: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_370(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x370: CALL 0x3D4 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x372;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3D4;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_372(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x372: RND V9, 0x03 */
+    vm->regs[0x9] = chip8_random(vm) & 0x03;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x374;
+        return;
+    }
+
+    /* 0x374: ADD V9, V9 */
+    {
+        uint16_t acc = vm->regs[0x9] + vm->regs[0x9];
+        vm->regs[0x9] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x376;
+        return;
+    }
+
+    /* 0x376: ADD V9, V9 */
+    {
+        uint16_t acc = vm->regs[0x9] + vm->regs[0x9];
+        vm->regs[0x9] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x378;
+        return;
+    }
+
+    /* 0x378: ADD V9, V9 */
+    {
+        uint16_t acc = vm->regs[0x9] + vm->regs[0x9];
+        vm->regs[0x9] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x37A;
+        return;
+    }
+
+    /* 0x37A: ADD V9, V9 */
+    {
+        uint16_t acc = vm->regs[0x9] + vm->regs[0x9];
+        vm->regs[0x9] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x37C;
+        return;
+    }
+
+    /* 0x37C: ADD V9, V9 */
+    {
+        uint16_t acc = vm->regs[0x9] + vm->regs[0x9];
+        vm->regs[0x9] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x37E;
+        return;
+    }
+
+    /* 0x37E: CALL 0x42E */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x380;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x42E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_380(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x380: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_382(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x382: LD VE, 0x00 */
+    vm->regs[0xE] = 0x00;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x384;
+        return;
+    }
+
+    /* 0x384: CALL 0x3C4 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x386;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3C4;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_386(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x386: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_388(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x388: CALL 0x42E */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x38A;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x42E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_38A(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x38A: LD VE, 0x00 */
+    vm->regs[0xE] = 0x00;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x38C;
+        return;
+    }
+
+    /* 0x38C: CALL 0x3B8 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x38E;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3B8;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_38E(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x38E: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_390(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x390: CALL 0x42E */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x392;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x42E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_392(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x392: LD VE, 0x00 */
+    vm->regs[0xE] = 0x00;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x394;
+        return;
+    }
+
+    /* 0x394: CALL 0x3D4 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x396;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3D4;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_396(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x396: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_398(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x398: CALL 0x42E */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x39A;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x42E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_39A(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x39A: LD VE, 0x00 */
+    vm->regs[0xE] = 0x00;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x39C;
+        return;
+    }
+
+    /* 0x39C: CALL 0x3C4 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x39E;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3C4;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_39E(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x39E: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3A0(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3A0: CALL 0x3C4 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3A2;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3C4;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3A2(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3A2: ADD VE, 0x03 */
+    vm->regs[0xE] += 0x03;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3A4;
+        return;
+    }
+
+    /* 0x3A4: CALL 0x3C4 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3A6;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3C4;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3A6(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3A6: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3A8(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3A8: CALL 0x3B8 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3AA;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3B8;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3AA(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3AA: ADD VE, 0x02 */
+    vm->regs[0xE] += 0x02;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3AC;
+        return;
+    }
+
+    /* 0x3AC: CALL 0x3B8 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3AE;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3B8;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3AE(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3AE: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3B0(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3B0: CALL 0x3D4 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3B2;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3D4;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3B2(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3B2: ADD VE, 0x02 */
+    vm->regs[0xE] += 0x02;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3B4;
+        return;
+    }
+
+    /* 0x3B4: CALL 0x3D4 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3B6;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3D4;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3B6(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3B6: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3B8(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3B8: LD VC, 0x00 */
+    vm->regs[0xC] = 0x00;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3BA;
+        return;
+    }
+
+    /* 0x3BA: CALL 0x3FA */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3BC;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3FA;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3BC(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3BC: CALL 0x3FA */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3BE;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3FA;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3BE(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3BE: CALL 0x3FA */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3C0;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3FA;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3C0(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3C0: CALL 0x3FA */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3C2;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3FA;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3C2(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3C2: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3C4(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3C4: LD VC, 0x00 */
+    vm->regs[0xC] = 0x00;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3C6;
+        return;
+    }
+
+    /* 0x3C6: CALL 0x3E0 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3C8;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3E0;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3C8(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3C8: CALL 0x3E0 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3CA;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3E0;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3CA(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3CA: CALL 0x3E0 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3CC;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3E0;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3CC(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3CC: CALL 0x3E0 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3CE;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3E0;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3CE(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3CE: CALL 0x3E0 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3D0;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3E0;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3D0(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3D0: CALL 0x3E0 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3D2;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x3E0;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3D2(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3D2: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3D4(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3D4: LD VC, 0x00 */
+    vm->regs[0xC] = 0x00;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3D6;
+        return;
+    }
+
+    /* 0x3D6: CALL 0x414 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3D8;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x414;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3D8(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3D8: CALL 0x414 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3DA;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x414;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3DA(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3DA: CALL 0x414 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3DC;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x414;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3DC(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3DC: CALL 0x414 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x3DE;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x414;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3DE(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3DE: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3E0(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3E0: LD I, 0x654 */
+    vm->I = 0x654;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3E2;
+        return;
+    }
+
+    /* 0x3E2: ADD I, VE */
+    vm->I += vm->regs[0xE];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3E4;
+        return;
+    }
+
+    /* 0x3E4: ADD I, VE */
+    vm->I += vm->regs[0xE];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3E6;
+        return;
+    }
+
+    /* 0x3E6: ADD I, VE */
+    vm->I += vm->regs[0xE];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3E8;
+        return;
+    }
+
+    /* 0x3E8: ADD I, VE */
+    vm->I += vm->regs[0xE];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3EA;
+        return;
+    }
+
+    /* 0x3EA: ADD I, VC */
+    vm->I += vm->regs[0xC];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3EC;
+        return;
+    }
+
+    /* 0x3EC: LD V1, [I] */
+    vm->regs[0x0] = vm->ram[vm->I + 0];
+    vm->regs[0x1] = vm->ram[vm->I + 1];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3EE;
+        return;
+    }
+
+    /* 0x3EE: ADD V0, 0x0C */
+    vm->regs[0x0] += 0x0C;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3F0;
+        return;
+    }
+
+    /* 0x3F0: ADD V1, V1 */
+    {
+        uint16_t acc = vm->regs[0x1] + vm->regs[0x1];
+        vm->regs[0x1] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3F2;
+        return;
+    }
+
+    /* 0x3F2: LD I, 0x548 */
+    vm->I = 0x548;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3F4;
+        return;
+    }
+
+    /* 0x3F4: DRW V0, V1, 8 */
+    vm->PC = 0x3F4;
+    if (!aot_step(vm, rt, 0x3F6))
+        return;
+
+    /* 0x3F6: ADD VC, 0x02 */
+    vm->regs[0xC] += 0x02;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3F8;
+        return;
+    }
+
+    /* 0x3F8: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_3FA(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x3FA: LD I, 0x954 */
+    vm->I = 0x954;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3FC;
+        return;
+    }
+
+    /* 0x3FC: ADD I, VE */
+    vm->I += vm->regs[0xE];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x3FE;
+        return;
+    }
+
+    /* 0x3FE: ADD I, VE */
+    vm->I += vm->regs[0xE];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x400;
+        return;
+    }
+
+    /* 0x400: ADD I, VE */
+    vm->I += vm->regs[0xE];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x402;
+        return;
+    }
+
+    /* 0x402: ADD I, VE */
+    vm->I += vm->regs[0xE];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x404;
+        return;
+    }
+
+    /* 0x404: ADD I, VC */
+    vm->I += vm->regs[0xC];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x406;
+        return;
+    }
+
+    /* 0x406: LD V1, [I] */
+    vm->regs[0x0] = vm->ram[vm->I + 0];
+    vm->regs[0x1] = vm->ram[vm->I + 1];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x408;
+        return;
+    }
+
+    /* 0x408: ADD V0, 0x0C */
+    vm->regs[0x0] += 0x0C;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x40A;
+        return;
+    }
+
+    /* 0x40A: ADD V1, V1 */
+    {
+        uint16_t acc = vm->regs[0x1] + vm->regs[0x1];
+        vm->regs[0x1] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x40C;
+        return;
+    }
+
+    /* 0x40C: LD I, 0x548 */
+    vm->I = 0x548;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x40E;
+        return;
+    }
+
+    /* 0x40E: DRW V0, V1, 8 */
+    vm->PC = 0x40E;
+    if (!aot_step(vm, rt, 0x410))
+        return;
+
+    /* 0x410: ADD VC, 0x02 */
+    vm->regs[0xC] += 0x02;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x412;
+        return;
+    }
+
+    /* 0x412: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_414(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x414: LD I, 0xB54 */
+    vm->I = 0xB54;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x416;
+        return;
+    }
+
+    /* 0x416: ADD I, VE */
+    vm->I += vm->regs[0xE];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x418;
+        return;
+    }
+
+    /* 0x418: ADD I, VE */
+    vm->I += vm->regs[0xE];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x41A;
+        return;
+    }
+
+    /* 0x41A: ADD I, VE */
+    vm->I += vm->regs[0xE];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x41C;
+        return;
+    }
+
+    /* 0x41C: ADD I, VE */
+    vm->I += vm->regs[0xE];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x41E;
+        return;
+    }
+
+    /* 0x41E: ADD I, VC */
+    vm->I += vm->regs[0xC];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x420;
+        return;
+    }
+
+    /* 0x420: LD V1, [I] */
+    vm->regs[0x0] = vm->ram[vm->I + 0];
+    vm->regs[0x1] = vm->ram[vm->I + 1];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x422;
+        return;
+    }
+
+    /* 0x422: ADD V0, 0x0C */
+    vm->regs[0x0] += 0x0C;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x424;
+        return;
+    }
+
+    /* 0x424: ADD V1, V1 */
+    {
+        uint16_t acc = vm->regs[0x1] + vm->regs[0x1];
+        vm->regs[0x1] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x426;
+        return;
+    }
+
+    /* 0x426: LD I, 0x548 */
+    vm->I = 0x548;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x428;
+        return;
+    }
+
+    /* 0x428: DRW V0, V1, 8 */
+    vm->PC = 0x428;
+    if (!aot_step(vm, rt, 0x42A))
+        return;
+
+    /* 0x42A: ADD VC, 0x02 */
+    vm->regs[0xC] += 0x02;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x42C;
+        return;
+    }
+
+    /* 0x42C: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_42E(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x42E: LD VC, 0x00 */
+    vm->regs[0xC] = 0x00;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    vm->PC = 0x430;
+    return;
+}
+
+static void block_430(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x430: LD V0, 0x1F */
+    vm->regs[0x0] = 0x1F;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x432;
+        return;
+    }
+
+    /* 0x432: LD VA, VD */
+    vm->regs[0xA] = vm->regs[0xD];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x434;
+        return;
+    }
+
+    /* 0x434: ADD VA, VC */
+    {
+        uint16_t acc = vm->regs[0xA] + vm->regs[0xC];
+        vm->regs[0xA] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x436;
+        return;
+    }
+
+    /* 0x436: AND VA, V0 */
+    vm->regs[0xA] &= vm->regs[0x0];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x438;
+        return;
+    }
+
+    /* 0x438: ADD VA, V9 */
+    {
+        uint16_t acc = vm->regs[0xA] + vm->regs[0x9];
+        vm->regs[0xA] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x43A;
+        return;
+    }
+
+    /* 0x43A: LD I, 0xD54 */
+    vm->I = 0xD54;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x43C;
+        return;
+    }
+
+    /* 0x43C: ADD I, VA */
+    vm->I += vm->regs[0xA];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x43E;
+        return;
+    }
+
+    /* 0x43E: ADD I, VA */
+    vm->I += vm->regs[0xA];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x440;
+        return;
+    }
+
+    /* 0x440: LD V1, [I] */
+    vm->regs[0x0] = vm->ram[vm->I + 0];
+    vm->regs[0x1] = vm->ram[vm->I + 1];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x442;
+        return;
+    }
+
+    /* 0x442: ADD V0, V0 */
+    {
+        uint16_t acc = vm->regs[0x0] + vm->regs[0x0];
+        vm->regs[0x0] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x444;
+        return;
+    }
+
+    /* 0x444: ADD V1, V1 */
+    {
+        uint16_t acc = vm->regs[0x1] + vm->regs[0x1];
+        vm->regs[0x1] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x446;
+        return;
+    }
+
+    /* 0x446: LD I, 0x550 */
+    vm->I = 0x550;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x448;
+        return;
+    }
+
+    /* 0x448: DRW V0, V1, 5 */
+    vm->PC = 0x448;
+    if (!aot_step(vm, rt, 0x44A))
+        return;
+
+    /* 0x44A: ADD VC, 0x01 */
+    vm->regs[0xC] += 0x01;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x44C;
+        return;
+    }
+
+    /* 0x44C: SE VC, 0x08 */
+    vm->PC = vm->regs[0xC] == 0x08 ? 0x450 : 0x44E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_44E(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x44E: JP 0x430 */
+    vm->PC = 0x430;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_450(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x450: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_452(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x452: LD V0, 0x1F */
+    vm->regs[0x0] = 0x1F;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x454;
+        return;
+    }
+
+    /* 0x454: LD VA, VD */
+    vm->regs[0xA] = vm->regs[0xD];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x456;
+        return;
+    }
+
+    /* 0x456: AND VA, V0 */
+    vm->regs[0xA] &= vm->regs[0x0];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x458;
+        return;
+    }
+
+    /* 0x458: ADD VA, V9 */
+    {
+        uint16_t acc = vm->regs[0xA] + vm->regs[0x9];
+        vm->regs[0xA] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x45A;
+        return;
+    }
+
+    /* 0x45A: LD I, 0xD54 */
+    vm->I = 0xD54;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x45C;
+        return;
+    }
+
+    /* 0x45C: ADD I, VA */
+    vm->I += vm->regs[0xA];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x45E;
+        return;
+    }
+
+    /* 0x45E: ADD I, VA */
+    vm->I += vm->regs[0xA];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x460;
+        return;
+    }
+
+    /* 0x460: LD V1, [I] */
+    vm->regs[0x0] = vm->ram[vm->I + 0];
+    vm->regs[0x1] = vm->ram[vm->I + 1];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x462;
+        return;
+    }
+
+    /* 0x462: ADD V0, V0 */
+    {
+        uint16_t acc = vm->regs[0x0] + vm->regs[0x0];
+        vm->regs[0x0] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x464;
+        return;
+    }
+
+    /* 0x464: ADD V1, V1 */
+    {
+        uint16_t acc = vm->regs[0x1] + vm->regs[0x1];
+        vm->regs[0x1] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x466;
+        return;
+    }
+
+    /* 0x466: LD I, 0x550 */
+    vm->I = 0x550;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x468;
+        return;
+    }
+
+    /* 0x468: DRW V0, V1, 5 */
+    vm->PC = 0x468;
+    if (!aot_step(vm, rt, 0x46A))
+        return;
+
+    /* 0x46A: LD V0, 0x1F */
+    vm->regs[0x0] = 0x1F;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x46C;
+        return;
+    }
+
+    /* 0x46C: LD VA, VD */
+    vm->regs[0xA] = vm->regs[0xD];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x46E;
+        return;
+    }
+
+    /* 0x46E: ADD VA, 0x08 */
+    vm->regs[0xA] += 0x08;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x470;
+        return;
+    }
+
+    /* 0x470: AND VA, V0 */
+    vm->regs[0xA] &= vm->regs[0x0];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x472;
+        return;
+    }
+
+    /* 0x472: ADD VA, V9 */
+    {
+        uint16_t acc = vm->regs[0xA] + vm->regs[0x9];
+        vm->regs[0xA] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x474;
+        return;
+    }
+
+    /* 0x474: LD I, 0xD54 */
+    vm->I = 0xD54;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x476;
+        return;
+    }
+
+    /* 0x476: ADD I, VA */
+    vm->I += vm->regs[0xA];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x478;
+        return;
+    }
+
+    /* 0x478: ADD I, VA */
+    vm->I += vm->regs[0xA];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x47A;
+        return;
+    }
+
+    /* 0x47A: LD V1, [I] */
+    vm->regs[0x0] = vm->ram[vm->I + 0];
+    vm->regs[0x1] = vm->ram[vm->I + 1];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x47C;
+        return;
+    }
+
+    /* 0x47C: ADD V0, V0 */
+    {
+        uint16_t acc = vm->regs[0x0] + vm->regs[0x0];
+        vm->regs[0x0] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x47E;
+        return;
+    }
+
+    /* 0x47E: ADD V1, V1 */
+    {
+        uint16_t acc = vm->regs[0x1] + vm->regs[0x1];
+        vm->regs[0x1] = acc & 0xff;
+        vm->regs[Vf] = (acc & 0xf00) >> 8;
+    }
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x480;
+        return;
+    }
+
+    /* 0x480: LD I, 0x550 */
+    vm->I = 0x550;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x482;
+        return;
+    }
+
+    /* 0x482: DRW V0, V1, 5 */
+    vm->PC = 0x482;
+    if (!aot_step(vm, rt, 0x484))
+        return;
+
+    /* 0x484: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_486(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x486: LD V0, DT */
+    vm->regs[0x0] = vm->DT;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x488;
+        return;
+    }
+
+    /* 0x488: SE V0, 0x00 */
+    vm->PC = vm->regs[0x0] == 0x00 ? 0x48C : 0x48A;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_48A(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x48A: JP 0x486 */
+    vm->PC = 0x486;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_48C(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x48C: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_48E(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x48E: LD VD, 0x04 */
+    vm->regs[0xD] = 0x04;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x490;
+        return;
+    }
+
+    /* 0x490: LD V1, 0x1D */
+    vm->regs[0x1] = 0x1D;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x492;
+        return;
+    }
+
+    /* 0x492: LD V0, 0x1C */
+    vm->regs[0x0] = 0x1C;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x494;
+        return;
+    }
+
+    /* 0x494: LD V2, 0x12 */
+    vm->regs[0x2] = 0x12;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x496;
+        return;
+    }
+
+    /* 0x496: LD I, 0x51E */
+    vm->I = 0x51E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x498;
+        return;
+    }
+
+    /* 0x498: ADD I, V2 */
+    vm->I += vm->regs[0x2];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x49A;
+        return;
+    }
+
+    /* 0x49A: DRW V0, V1, 6 */
+    vm->PC = 0x49A;
+    if (!aot_step(vm, rt, 0x49C))
+        return;
+
+    /* 0x49C: LD DT, VD */
+    vm->DT = vm->regs[0xD];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x49E;
+        return;
+    }
+
+    /* 0x49E: CALL 0x486 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x4A0;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x486;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_4A0(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x4A0: LD V0, 0x14 */
+    vm->regs[0x0] = 0x14;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4A2;
+        return;
+    }
+
+    /* 0x4A2: LD V2, 0x0C */
+    vm->regs[0x2] = 0x0C;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4A4;
+        return;
+    }
+
+    /* 0x4A4: LD I, 0x51E */
+    vm->I = 0x51E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4A6;
+        return;
+    }
+
+    /* 0x4A6: ADD I, V2 */
+    vm->I += vm->regs[0x2];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4A8;
+        return;
+    }
+
+    /* 0x4A8: DRW V0, V1, 6 */
+    vm->PC = 0x4A8;
+    if (!aot_step(vm, rt, 0x4AA))
+        return;
+
+    /* 0x4AA: LD V0, 0x24 */
+    vm->regs[0x0] = 0x24;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4AC;
+        return;
+    }
+
+    /* 0x4AC: LD V2, 0x18 */
+    vm->regs[0x2] = 0x18;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4AE;
+        return;
+    }
+
+    /* 0x4AE: LD I, 0x51E */
+    vm->I = 0x51E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4B0;
+        return;
+    }
+
+    /* 0x4B0: ADD I, V2 */
+    vm->I += vm->regs[0x2];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4B2;
+        return;
+    }
+
+    /* 0x4B2: DRW V0, V1, 6 */
+    vm->PC = 0x4B2;
+    if (!aot_step(vm, rt, 0x4B4))
+        return;
+
+    /* 0x4B4: LD DT, VD */
+    vm->DT = vm->regs[0xD];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4B6;
+        return;
+    }
+
+    /* 0x4B6: CALL 0x486 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x4B8;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x486;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_4B8(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x4B8: LD V0, 0x0C */
+    vm->regs[0x0] = 0x0C;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4BA;
+        return;
+    }
+
+    /* 0x4BA: LD V2, 0x06 */
+    vm->regs[0x2] = 0x06;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4BC;
+        return;
+    }
+
+    /* 0x4BC: LD I, 0x51E */
+    vm->I = 0x51E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4BE;
+        return;
+    }
+
+    /* 0x4BE: ADD I, V2 */
+    vm->I += vm->regs[0x2];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4C0;
+        return;
+    }
+
+    /* 0x4C0: DRW V0, V1, 6 */
+    vm->PC = 0x4C0;
+    if (!aot_step(vm, rt, 0x4C2))
+        return;
+
+    /* 0x4C2: LD V0, 0x2C */
+    vm->regs[0x0] = 0x2C;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4C4;
+        return;
+    }
+
+    /* 0x4C4: LD V2, 0x1E */
+    vm->regs[0x2] = 0x1E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4C6;
+        return;
+    }
+
+    /* 0x4C6: LD I, 0x51E */
+    vm->I = 0x51E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4C8;
+        return;
+    }
+
+    /* 0x4C8: ADD I, V2 */
+    vm->I += vm->regs[0x2];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4CA;
+        return;
+    }
+
+    /* 0x4CA: DRW V0, V1, 6 */
+    vm->PC = 0x4CA;
+    if (!aot_step(vm, rt, 0x4CC))
+        return;
+
+    /* 0x4CC: LD DT, VD */
+    vm->DT = vm->regs[0xD];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4CE;
+        return;
+    }
+
+    /* 0x4CE: CALL 0x486 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x4D0;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x486;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_4D0(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x4D0: LD I, 0x51E */
+    vm->I = 0x51E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4D2;
+        return;
+    }
+
+    /* 0x4D2: LD V0, 0x04 */
+    vm->regs[0x0] = 0x04;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4D4;
+        return;
+    }
+
+    /* 0x4D4: DRW V0, V1, 6 */
+    vm->PC = 0x4D4;
+    if (!aot_step(vm, rt, 0x4D6))
+        return;
+
+    /* 0x4D6: LD V0, 0x34 */
+    vm->regs[0x0] = 0x34;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4D8;
+        return;
+    }
+
+    /* 0x4D8: LD V2, 0x24 */
+    vm->regs[0x2] = 0x24;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4DA;
+        return;
+    }
+
+    /* 0x4DA: LD I, 0x51E */
+    vm->I = 0x51E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4DC;
+        return;
+    }
+
+    /* 0x4DC: ADD I, V2 */
+    vm->I += vm->regs[0x2];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4DE;
+        return;
+    }
+
+    /* 0x4DE: DRW V0, V1, 6 */
+    vm->PC = 0x4DE;
+    if (!aot_step(vm, rt, 0x4E0))
+        return;
+
+    /* 0x4E0: LD DT, VD */
+    vm->DT = vm->regs[0xD];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4E2;
+        return;
+    }
+
+    /* 0x4E2: CALL 0x486 */
+    vm->stack[vm->SP & STACK_INDEX_MASK] = 0x4E4;
+    vm->SP = (vm->SP + 1) & STACK_INDEX_MASK;
+    vm->PC = 0x486;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_4E4(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x4E4: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_4E6(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x4E6: LD V4, 0x01 */
+    vm->regs[0x4] = 0x01;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4E8;
+        return;
+    }
+
+    /* 0x4E8: LD V5, 0x07 */
+    vm->regs[0x5] = 0x07;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4EA;
+        return;
+    }
+
+    /* 0x4EA: LD V2, 0x00 */
+    vm->regs[0x2] = 0x00;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4EC;
+        return;
+    }
+
+    /* 0x4EC: LD V3, 0x00 */
+    vm->regs[0x3] = 0x00;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    vm->PC = 0x4EE;
+    return;
+}
+
+static void block_4EE(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x4EE: LD V0, 0x00 */
+    vm->regs[0x0] = 0x00;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    vm->PC = 0x4F0;
+    return;
+}
+
+static void block_4F0(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x4F0: LD V1, V3 */
+    vm->regs[0x1] = vm->regs[0x3];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4F2;
+        return;
+    }
+
+    /* 0x4F2: ADD V1, 0x10 */
+    vm->regs[0x1] += 0x10;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4F4;
+        return;
+    }
+
+    /* 0x4F4: DRW V0, V1, 1 */
+    vm->PC = 0x4F4;
+    if (!aot_step(vm, rt, 0x4F6))
+        return;
+
+    /* 0x4F6: ADD V1, 0x08 */
+    vm->regs[0x1] += 0x08;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4F8;
+        return;
+    }
+
+    /* 0x4F8: ADD I, V4 */
+    vm->I += vm->regs[0x4];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4FA;
+        return;
+    }
+
+    /* 0x4FA: DRW V0, V1, 1 */
+    vm->PC = 0x4FA;
+    if (!aot_step(vm, rt, 0x4FC))
+        return;
+
+    /* 0x4FC: ADD V1, 0x08 */
+    vm->regs[0x1] += 0x08;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x4FE;
+        return;
+    }
+
+    /* 0x4FE: ADD I, V4 */
+    vm->I += vm->regs[0x4];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x500;
+        return;
+    }
+
+    /* 0x500: DRW V0, V1, 1 */
+    vm->PC = 0x500;
+    if (!aot_step(vm, rt, 0x502))
+        return;
+
+    /* 0x502: ADD V1, 0x08 */
+    vm->regs[0x1] += 0x08;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x504;
+        return;
+    }
+
+    /* 0x504: ADD I, V4 */
+    vm->I += vm->regs[0x4];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x506;
+        return;
+    }
+
+    /* 0x506: DRW V0, V1, 1 */
+    vm->PC = 0x506;
+    if (!aot_step(vm, rt, 0x508))
+        return;
+
+    /* 0x508: ADD I, V4 */
+    vm->I += vm->regs[0x4];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x50A;
+        return;
+    }
+
+    /* 0x50A: ADD V0, 0x08 */
+    vm->regs[0x0] += 0x08;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x50C;
+        return;
+    }
+
+    /* 0x50C: SE V0, 0x40 */
+    vm->PC = vm->regs[0x0] == 0x40 ? 0x510 : 0x50E;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_50E(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x50E: JP 0x4F0 */
+    vm->PC = 0x4F0;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_510(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x510: ADD V3, 0x03 */
+    vm->regs[0x3] += 0x03;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x512;
+        return;
+    }
+
+    /* 0x512: AND V3, V5 */
+    vm->regs[0x3] &= vm->regs[0x5];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x514;
+        return;
+    }
+
+    /* 0x514: ADD V2, 0x01 */
+    vm->regs[0x2] += 0x01;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x516;
+        return;
+    }
+
+    /* 0x516: SE V2, 0x08 */
+    vm->PC = vm->regs[0x2] == 0x08 ? 0x51A : 0x518;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_518(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x518: JP 0x4EE */
+    vm->PC = 0x4EE;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static void block_51A(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    /* 0x51A: RET */
+    vm->SP = (vm->SP - 1) & STACK_INDEX_MASK;
+    vm->PC = vm->stack[vm->SP];
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static const aot_block blocks[] = {
+    {0x200, 0x202, block_200},
+    {0x2C0, 0x2C2, block_2C0},
+    {0x2D4, 0x2DC, block_2D4},
+    {0x2DC, 0x2DE, block_2DC},
+    {0x2DE, 0x2E4, block_2DE},
+    {0x2E4, 0x2E6, block_2E4},
+    {0x2E6, 0x2EC, block_2E6},
+    {0x2EC, 0x2F0, block_2EC},
+    {0x2F0, 0x2F6, block_2F0},
+    {0x2F6, 0x2FA, block_2F6},
+    {0x2FA, 0x300, block_2FA},
+    {0x300, 0x302, block_300},
+    {0x302, 0x304, block_302},
+    {0x304, 0x306, block_304},
+    {0x306, 0x308, block_306},
+    {0x308, 0x30A, block_308},
+    {0x30A, 0x30C, block_30A},
+    {0x30C, 0x30E, block_30C},
+    {0x30E, 0x310, block_30E},
+    {0x310, 0x312, block_310},
+    {0x312, 0x314, block_312},
+    {0x314, 0x316, block_314},
+    {0x316, 0x318, block_316},
+    {0x318, 0x31E, block_318},
+    {0x31E, 0x328, block_31E},
+    {0x328, 0x32A, block_328},
+    {0x32A, 0x32C, block_32A},
+    {0x32C, 0x32E, block_32C},
+    {0x32E, 0x330, block_32E},
+    {0x330, 0x332, block_330},
+    {0x332, 0x334, block_332},
+    {0x334, 0x336, block_334},
+    {0x336, 0x338, block_336},
+    {0x338, 0x33A, block_338},
+    {0x33A, 0x33C, block_33A},
+    {0x33C, 0x33E, block_33C},
+    {0x33E, 0x340, block_33E},
+    {0x340, 0x342, block_340},
+    {0x342, 0x344, block_342},
+    {0x344, 0x348, block_344},
+    {0x348, 0x34A, block_348},
+    {0x34A, 0x34C, block_34A},
+    {0x34C, 0x34E, block_34C},
+    {0x34E, 0x35C, block_34E},
+    {0x35C, 0x35E, block_35C},
+    {0x35E, 0x360, block_35E},
+    {0x360, 0x36E, block_360},
+    {0x36E, 0x370, block_36E},
+    {0x370, 0x372, block_370},
+    {0x372, 0x380, block_372},
+    {0x380, 0x382, block_380},
+    {0x382, 0x386, block_382},
+    {0x386, 0x388, block_386},
+    {0x388, 0x38A, block_388},
+    {0x38A, 0x38E, block_38A},
+    {0x38E, 0x390, block_38E},
+    {0x390, 0x392, block_390},
+    {0x392, 0x396, block_392},
+    {0x396, 0x398, block_396},
+    {0x398, 0x39A, block_398},
+    {0x39A, 0x39E, block_39A},
+    {0x39E, 0x3A0, block_39E},
+    {0x3A0, 0x3A2, block_3A0},
+    {0x3A2, 0x3A6, block_3A2},
+    {0x3A6, 0x3A8, block_3A6},
+    {0x3A8, 0x3AA, block_3A8},
+    {0x3AA, 0x3AE, block_3AA},
+    {0x3AE, 0x3B0, block_3AE},
+    {0x3B0, 0x3B2, block_3B0},
+    {0x3B2, 0x3B6, block_3B2},
+    {0x3B6, 0x3B8, block_3B6},
+    {0x3B8, 0x3BC, block_3B8},
+    {0x3BC, 0x3BE, block_3BC},
+    {0x3BE, 0x3C0, block_3BE},
+    {0x3C0, 0x3C2, block_3C0},
+    {0x3C2, 0x3C4, block_3C2},
+    {0x3C4, 0x3C8, block_3C4},
+    {0x3C8, 0x3CA, block_3C8},
+    {0x3CA, 0x3CC, block_3CA},
+    {0x3CC, 0x3CE, block_3CC},
+    {0x3CE, 0x3D0, block_3CE},
+    {0x3D0, 0x3D2, block_3D0},
+    {0x3D2, 0x3D4, block_3D2},
+    {0x3D4, 0x3D8, block_3D4},
+    {0x3D8, 0x3DA, block_3D8},
+    {0x3DA, 0x3DC, block_3DA},
+    {0x3DC, 0x3DE, block_3DC},
+    {0x3DE, 0x3E0, block_3DE},
+    {0x3E0, 0x3FA, block_3E0},
+    {0x3FA, 0x414, block_3FA},
+    {0x414, 0x42E, block_414},
+    {0x42E, 0x430, block_42E},
+    {0x430, 0x44E, block_430},
+    {0x44E, 0x450, block_44E},
+    {0x450, 0x452, block_450},
+    {0x452, 0x486, block_452},
+    {0x486, 0x48A, block_486},
+    {0x48A, 0x48C, block_48A},
+    {0x48C, 0x48E, block_48C},
+    {0x48E, 0x4A0, block_48E},
+    {0x4A0, 0x4B8, block_4A0},
+    {0x4B8, 0x4D0, block_4B8},
+    {0x4D0, 0x4E4, block_4D0},
+    {0x4E4, 0x4E6, block_4E4},
+    {0x4E6, 0x4EE, block_4E6},
+    {0x4EE, 0x4F0, block_4EE},
+    {0x4F0, 0x50E, block_4F0},
+    {0x50E, 0x510, block_50E},
+    {0x510, 0x518, block_510},
+    {0x518, 0x51A, block_518},
+    {0x51A, 0x51C, block_51A},
+};
+
+const aot_program aot_rom = {
+    .rom = rom,
+    .rom_size = sizeof(rom),
+    .blocks = blocks,
+    .block_count = 111,
+};
@@ -0,0 +1,166 @@
+/*
+ * pchip-romdb: ROM catalog maintenance
+ *
+ *   pchip-romdb hash [-d roms.db] <rom>...            database lines for ROMs
+ *   pchip-romdb pack [-d roms.db] -o out.pack <rom>... pack ROMs with settings
+ *   pchip-romdb list <pack>                           list a pack
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libgen.h>
+#include <unistd.h>
+
+#include "romdb.h"
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s hash [-d roms.db] <path/to/rom>...\n", prog);
+    fprintf(stderr, "       %s pack [-d roms.db] -o out.pack <path/to/rom>...\n", prog);
+    fprintf(stderr, "       %s list <path/to/pack>\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+static uint8_t *read_rom(const char *path, size_t *size)
+{
+    FILE *in = fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+
+    uint8_t *data = malloc(XOCHIP_MAX_ROM_SIZE_BYTES);
+    if (!data) {
+        fprintf(stderr, "Malloc failure\n");
+        exit(EXIT_FAILURE);
+    }
+    *size = fread(data, 1, XOCHIP_MAX_ROM_SIZE_BYTES, in);
+    if (ferror(in) || fgetc(in) != EOF) {
+        fprintf(stderr, "Failed to read or too big to load: %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    fclose(in);
+
+    return data;
+}
+
+/* File name without directories, points into path */
+static const char *rom_name(char *path)
+{
+    return basename(path);
+}
+
+static void settings_for(const romdb *db, uint64_t hash, romdb_settings *settings)
+{
+    if (!db || !romdb_lookup(db, hash, settings))
+        romdb_settings_default(settings);
+}
+
+static int cmd_hash(const romdb *db, int count, char *paths[])
+{
+    for (int i = 0; i < count; i++) {
+        size_t size = 0;
+        uint8_t *data = read_rom(paths[i], &size);
+
+        romdb_record record = { .hash = romdb_hash(data, size) };
+        settings_for(db, record.hash, &record.settings);
+
+        char line[128];
+        romdb_format_record(&record, line, sizeof(line));
+        printf("%s # %s\n", line, rom_name(paths[i]));
+        free(data);
+    }
+    return EXIT_SUCCESS;
+}
+
+static int cmd_pack(const romdb *db, const char *out_path, int count, char *paths[])
+{
+    romdb_pack_input *roms = calloc(count, sizeof(*roms));
+    if (!roms) {
+        fprintf(stderr, "Calloc failure\n");
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 0; i < count; i++) {
+        roms[i].data = read_rom(paths[i], &roms[i].size);
+        roms[i].name = rom_name(paths[i]);
+        settings_for(db, romdb_hash(roms[i].data, roms[i].size), &roms[i].settings);
+    }
+
+    int rc = romdb_pack_write(out_path, roms, count);
+
+    for (int i = 0; i < count; i++)
+        free((void *)roms[i].data);
+    free(roms);
+
+    return rc == ROMDB_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int cmd_list(const char *path)
+{
+    romdb_pack *pack = NULL;
+    if (romdb_pack_open(path, &pack) != ROMDB_SUCCESS)
+        return EXIT_FAILURE;
+
+    for (size_t i = 0; i < romdb_pack_count(pack); i++) {
+        const romdb_pack_entry *entry = romdb_pack_entry_at(pack, i);
+        romdb_record record = { .hash = entry->hash, .settings = entry->settings };
+
+        char line[128];
+        romdb_format_record(&record, line, sizeof(line));
+        printf("%s # %s, %u bytes\n", line, romdb_pack_name(pack, entry), entry->size);
+    }
+
+    romdb_pack_close(pack);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+        usage(argv[0]);
+    const char *cmd = argv[1];
+    const char *db_path = NULL;
+    const char *out_path = NULL;
+
+    /* Options follow the command */
+    optind = 2;
+    int opt;
+    while ((opt = getopt(argc, argv, "d:o:")) != -1) {
+        switch (opt) {
+        case 'd':
+            db_path = optarg;
+            break;
+        case 'o':
+            out_path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+
+    if (strcmp(cmd, "list") == 0) {
+        if (argc - optind != 1)
+            usage(argv[0]);
+        return cmd_list(argv[optind]);
+    }
+
+    romdb *db = NULL;
+    if (db_path && romdb_load(db_path, &db) != ROMDB_SUCCESS)
+        return EXIT_FAILURE;
+
+    int rc = EXIT_FAILURE;
+    if (strcmp(cmd, "hash") == 0) {
+        rc = cmd_hash(db, argc - optind, &argv[optind]);
+    } else if (strcmp(cmd, "pack") == 0) {
+        if (!out_path)
+            usage(argv[0]);
+        rc = cmd_pack(db, out_path, argc - optind, &argv[optind]);
+    } else {
+        usage(argv[0]);
+    }
+
+    romdb_free(db);
+    return rc;
+}
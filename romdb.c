@@ -0,0 +1,424 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "romdb.h"
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+#define LINE_MAX_SIZE 1024
+
+uint64_t romdb_hash(const uint8_t *rom, size_t size)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= rom[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+void romdb_settings_default(romdb_settings *settings)
+{
+    *settings = (romdb_settings) {
+        .mode = CHIP8_MODE_CHIP8,
+        .timing = CHIP8_TIMING_FIXED,
+        .speed = FREQUENCY_CPU,
+        .quirks = 0,
+    };
+}
+
+void romdb_settings_apply(const romdb_settings *settings, chip8 *vm)
+{
+    chip8_set_mode(vm, settings->mode);
+    chip8_set_timing(vm, settings->timing);
+    chip8_set_speed(vm, settings->speed);
+    chip8_set_quirks(vm, settings->quirks);
+}
+
+void romdb_format_record(const romdb_record *record, char *buf, size_t size)
+{
+    const romdb_settings *settings = &record->settings;
+    snprintf(buf, size, "%.16" PRIx64 " mode=%s timing=%s speed=%u quirks=0x%" PRIx32,
+             record->hash,
+             settings->mode == CHIP8_MODE_XOCHIP ? "xochip" : "chip8",
+             settings->timing == CHIP8_TIMING_VIP ? "vip" : "fixed",
+             settings->speed, settings->quirks);
+}
+
+/* The same limits parse_setting() puts on a text database */
+static bool is_settings_valid(const romdb_settings *settings)
+{
+    if (settings->mode != CHIP8_MODE_CHIP8 && settings->mode != CHIP8_MODE_XOCHIP)
+        return false;
+    if (settings->timing != CHIP8_TIMING_FIXED && settings->timing != CHIP8_TIMING_VIP)
+        return false;
+    if (settings->speed < FREQUENCY_TIMER)
+        return false;
+    return !(settings->quirks & ~CHIP8_QUIRK_MASK);
+}
+
+static int parse_setting(const char *token, romdb_settings *settings)
+{
+    const char *value = strchr(token, '=');
+    if (!value)
+        return ROMDB_FAIL;
+    size_t key_len = value - token;
+    value++;
+
+    char *end = NULL;
+    if (key_len == 4 && strncmp(token, "mode", key_len) == 0) {
+        if (strcmp(value, "chip8") == 0)
+            settings->mode = CHIP8_MODE_CHIP8;
+        else if (strcmp(value, "xochip") == 0)
+            settings->mode = CHIP8_MODE_XOCHIP;
+        else
+            return ROMDB_FAIL;
+    } else if (key_len == 6 && strncmp(token, "timing", key_len) == 0) {
+        if (strcmp(value, "fixed") == 0)
+            settings->timing = CHIP8_TIMING_FIXED;
+        else if (strcmp(value, "vip") == 0)
+            settings->timing = CHIP8_TIMING_VIP;
+        else
+            return ROMDB_FAIL;
+    } else if (key_len == 5 && strncmp(token, "speed", key_len) == 0) {
+        unsigned long speed = strtoul(value, &end, 10);
+        if (*end || speed < FREQUENCY_TIMER || speed > UINT16_MAX)
+            return ROMDB_FAIL;
+        settings->speed = speed;
+    } else if (key_len == 6 && strncmp(token, "quirks", key_len) == 0) {
+        unsigned long quirks = strtoul(value, &end, 0);
+        if (*end || quirks & ~CHIP8_QUIRK_MASK)
+            return ROMDB_FAIL;
+        settings->quirks = quirks;
+    } else {
+        return ROMDB_FAIL;
+    }
+
+    return ROMDB_SUCCESS;
+}
+
+/* Hash and settings from a line, false for blank and comment lines */
+static int parse_line(char *line, romdb_record *record, bool *is_record)
+{
+    char *comment = strchr(line, '#');
+    if (comment)
+        *comment = '\0';
+
+    char *save = NULL;
+    char *token = strtok_r(line, " \t\r\n", &save);
+    *is_record = token != NULL;
+    if (!token)
+        return ROMDB_SUCCESS;
+
+    char *end = NULL;
+    if (strlen(token) != ROMDB_HASH_CHARS)
+        return ROMDB_FAIL;
+    record->hash = strtoull(token, &end, 16);
+    if (*end)
+        return ROMDB_FAIL;
+
+    romdb_settings_default(&record->settings);
+    while ((token = strtok_r(NULL, " \t\r\n", &save)))
+        if (parse_setting(token, &record->settings) != ROMDB_SUCCESS)
+            return ROMDB_FAIL;
+
+    return ROMDB_SUCCESS;
+}
+
+static int compare_records(const void *a, const void *b)
+{
+    uint64_t ha = ((const romdb_record *)a)->hash;
+    uint64_t hb = ((const romdb_record *)b)->hash;
+    return ha < hb ? -1 : ha > hb;
+}
+
+int romdb_load(const char *path, romdb **db)
+{
+    FILE *in = fopen(path, "r");
+    if (!in) {
+        perror("fopen");
+        return ROMDB_FAIL;
+    }
+
+    *db = calloc(1, sizeof(**db));
+    if (!*db) {
+        fprintf(stderr, "Calloc failure\n");
+        fclose(in);
+        return ROMDB_FAIL;
+    }
+
+    size_t capacity = 0;
+    char line[LINE_MAX_SIZE];
+    for (size_t line_no = 1; fgets(line, sizeof(line), in); line_no++) {
+        romdb_record record;
+        bool is_record = false;
+        if (parse_line(line, &record, &is_record) != ROMDB_SUCCESS) {
+            fprintf(stderr, "%s:%zu: malformed ROM record\n", path, line_no);
+            goto fail;
+        }
+        if (!is_record)
+            continue;
+
+        if ((*db)->count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            romdb_record *records = realloc((*db)->records, capacity * sizeof(*records));
+            if (!records) {
+                fprintf(stderr, "Realloc failure\n");
+                goto fail;
+            }
+            (*db)->records = records;
+        }
+        (*db)->records[(*db)->count++] = record;
+    }
+
+    fclose(in);
+    qsort((*db)->records, (*db)->count, sizeof(romdb_record), compare_records);
+    return ROMDB_SUCCESS;
+
+fail:
+    fclose(in);
+    romdb_free(*db);
+    *db = NULL;
+    return ROMDB_FAIL;
+}
+
+void romdb_free(romdb *db)
+{
+    if (!db)
+        return;
+    free(db->records);
+    free(db);
+}
+
+bool romdb_lookup(const romdb *db, uint64_t hash, romdb_settings *settings)
+{
+    romdb_record key = { .hash = hash };
+    const romdb_record *record =
+        bsearch(&key, db->records, db->count, sizeof(romdb_record), compare_records);
+    if (!record)
+        return false;
+    *settings = record->settings;
+    return true;
+}
+
+/*
+ * Packs
+ * */
+
+typedef struct hashed_input {
+    uint64_t hash;
+    const romdb_pack_input *rom;
+} hashed_input;
+
+static int compare_hashed_inputs(const void *a, const void *b)
+{
+    uint64_t ha = ((const hashed_input *)a)->hash;
+    uint64_t hb = ((const hashed_input *)b)->hash;
+    return ha < hb ? -1 : ha > hb;
+}
+
+static size_t align_up(size_t offset)
+{
+    return (offset + ROMDB_PACK_ALIGN - 1) / ROMDB_PACK_ALIGN * ROMDB_PACK_ALIGN;
+}
+
+int romdb_pack_write(const char *path, const romdb_pack_input *roms, size_t count)
+{
+    hashed_input *sorted = calloc(count + 1, sizeof(*sorted));
+    romdb_pack_entry *entries = calloc(count + 1, sizeof(*entries));
+    if (!sorted || !entries) {
+        fprintf(stderr, "Calloc failure\n");
+        free(sorted);
+        free(entries);
+        return ROMDB_FAIL;
+    }
+
+    for (size_t i = 0; i < count; i++)
+        sorted[i] = (hashed_input) { romdb_hash(roms[i].data, roms[i].size), &roms[i] };
+    qsort(sorted, count, sizeof(*sorted), compare_hashed_inputs);
+
+    /* Identical ROMs are stored once, under the first name */
+    size_t unique = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (unique && sorted[unique - 1].hash == sorted[i].hash) {
+            fprintf(stderr, "Duplicate of %s: %s\n", sorted[unique - 1].rom->name, sorted[i].rom->name);
+            continue;
+        }
+        sorted[unique++] = sorted[i];
+    }
+
+    /* Header, index, names, then aligned ROM data */
+    size_t offset = sizeof(romdb_pack_header) + unique * sizeof(romdb_pack_entry);
+    for (size_t i = 0; i < unique; i++) {
+        entries[i].hash = sorted[i].hash;
+        entries[i].name_offset = offset;
+        entries[i].settings = sorted[i].rom->settings;
+        offset += strlen(sorted[i].rom->name) + 1;
+    }
+    for (size_t i = 0; i < unique; i++) {
+        offset = align_up(offset);
+        entries[i].offset = offset;
+        entries[i].size = sorted[i].rom->size;
+        offset += sorted[i].rom->size;
+    }
+
+    int rc = ROMDB_FAIL;
+    FILE *out = fopen(path, "wb");
+    if (!out) {
+        perror("fopen");
+        goto out;
+    }
+
+    romdb_pack_header header = { .count = unique };
+    memcpy(header.magic, ROMDB_PACK_MAGIC, sizeof(header.magic));
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(entries, sizeof(*entries), unique, out);
+    for (size_t i = 0; i < unique; i++)
+        fwrite(sorted[i].rom->name, strlen(sorted[i].rom->name) + 1, 1, out);
+    for (size_t i = 0; i < unique; i++) {
+        static const uint8_t padding[ROMDB_PACK_ALIGN];
+        fwrite(padding, 1, entries[i].offset - ftell(out), out);
+        fwrite(sorted[i].rom->data, 1, sorted[i].rom->size, out);
+    }
+
+    if (ferror(out)) {
+        perror("fwrite");
+        fclose(out);
+        goto out;
+    }
+    if (fclose(out) != 0) {
+        perror("fclose");
+        goto out;
+    }
+    rc = ROMDB_SUCCESS;
+
+out:
+    free(sorted);
+    free(entries);
+    return rc;
+}
+
+/* Everything the index points to has to be within the mapping */
+static bool is_pack_valid(const romdb_pack *pack)
+{
+    if (pack->map_size < sizeof(romdb_pack_header))
+        return false;
+    if (memcmp(pack->header->magic, ROMDB_PACK_MAGIC, sizeof(pack->header->magic)) != 0)
+        return false;
+
+    size_t count = pack->header->count;
+    if (count > (pack->map_size - sizeof(romdb_pack_header)) / sizeof(romdb_pack_entry))
+        return false;
+
+    for (size_t i = 0; i < count; i++) {
+        const romdb_pack_entry *entry = &pack->entries[i];
+        if (i && entry->hash <= pack->entries[i - 1].hash)
+            return false;
+        if (entry->offset > pack->map_size || entry->size > pack->map_size - entry->offset)
+            return false;
+        if (entry->size > XOCHIP_MAX_ROM_SIZE_BYTES)
+            return false;
+        if (entry->name_offset >= pack->map_size ||
+            !memchr(pack->map + entry->name_offset, '\0', pack->map_size - entry->name_offset))
+            return false;
+        if (!is_settings_valid(&entry->settings))
+            return false;
+    }
+
+    return true;
+}
+
+int romdb_pack_open(const char *path, romdb_pack **pack)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        perror("open");
+        return ROMDB_FAIL;
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) == -1 || sb.st_size == 0) {
+        fprintf(stderr, "Empty or unreadable pack: %s\n", path);
+        close(fd);
+        return ROMDB_FAIL;
+    }
+
+    void *map = mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        return ROMDB_FAIL;
+    }
+
+    *pack = calloc(1, sizeof(**pack));
+    if (!*pack) {
+        fprintf(stderr, "Calloc failure\n");
+        munmap(map, sb.st_size);
+        return ROMDB_FAIL;
+    }
+    (*pack)->map = map;
+    (*pack)->map_size = sb.st_size;
+    (*pack)->header = map;
+    (*pack)->entries = (const romdb_pack_entry *)((const uint8_t *)map + sizeof(romdb_pack_header));
+
+    if (!is_pack_valid(*pack)) {
+        fprintf(stderr, "Not a valid ROM pack: %s\n", path);
+        romdb_pack_close(*pack);
+        *pack = NULL;
+        return ROMDB_FAIL;
+    }
+
+    return ROMDB_SUCCESS;
+}
+
+void romdb_pack_close(romdb_pack *pack)
+{
+    if (!pack)
+        return;
+    munmap((void *)pack->map, pack->map_size);
+    free(pack);
+}
+
+size_t romdb_pack_count(const romdb_pack *pack)
+{
+    return pack->header->count;
+}
+
+const romdb_pack_entry *romdb_pack_entry_at(const romdb_pack *pack, size_t i)
+{
+    return i < pack->header->count ? &pack->entries[i] : NULL;
+}
+
+const romdb_pack_entry *romdb_pack_find(const romdb_pack *pack, uint64_t hash)
+{
+    size_t lo = 0;
+    size_t hi = pack->header->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        uint64_t mid_hash = pack->entries[mid].hash;
+        if (mid_hash == hash)
+            return &pack->entries[mid];
+        if (mid_hash < hash)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return NULL;
+}
+
+const uint8_t *romdb_pack_rom(const romdb_pack *pack, const romdb_pack_entry *entry)
+{
+    return pack->map + entry->offset;
+}
+
+const char *romdb_pack_name(const romdb_pack *pack, const romdb_pack_entry *entry)
+{
+    return (const char *)pack->map + entry->name_offset;
+}
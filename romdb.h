@@ -0,0 +1,117 @@
+#ifndef ROMDB_H
+#define ROMDB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+
+#include "chip8.h"
+
+/*
+ * ROM catalog
+ *
+ * ROMs are identified by a 64-bit FNV-1a hash of their contents. The settings
+ * database is a text file, one ROM per line:
+ *
+ *   <hash> [mode=chip8|xochip] [timing=fixed|vip] [speed=<Hz>] [quirks=<mask>] [# comment]
+ *
+ * A pack is a single file holding many ROMs along with their settings, an
+ * index sorted by hash up front. Packs are mmap'd read-only and ROMs are used
+ * right from the mapping.
+ */
+
+#define ROMDB_PACK_MAGIC "PCHIPPK1"
+#define ROMDB_PACK_ALIGN 256    /* ROM data alignment within a pack */
+#define ROMDB_HASH_CHARS 16
+
+enum romdb_status {
+    ROMDB_SUCCESS,
+    ROMDB_FAIL,
+};
+
+typedef struct romdb_settings {
+    uint8_t mode;               /* enum chip8_mode */
+    uint8_t timing;             /* enum chip8_timing */
+    uint16_t speed;             /* Instructions per second under fixed timing */
+    uint32_t quirks;            /* enum chip8_quirk bits */
+} romdb_settings;
+
+typedef struct romdb_record {
+    uint64_t hash;
+    romdb_settings settings;
+} romdb_record;
+
+typedef struct romdb {
+    romdb_record *records;      /* Sorted by hash */
+    size_t count;
+} romdb;
+
+/* On-disk pack layout, native endianness */
+typedef struct romdb_pack_header {
+    char magic[8];
+    uint32_t count;
+    uint32_t reserved;
+} romdb_pack_header;
+
+typedef struct romdb_pack_entry {
+    uint64_t hash;
+    uint32_t offset;            /* ROM data, from the start of the pack */
+    uint32_t size;
+    uint32_t name_offset;       /* NUL-terminated name */
+    uint32_t reserved;
+    romdb_settings settings;
+} romdb_pack_entry;
+
+static_assert(sizeof(romdb_pack_header) == 16, "Unexpected pack header layout");
+static_assert(sizeof(romdb_pack_entry) == 32, "Unexpected pack entry layout");
+
+typedef struct romdb_pack {
+    const uint8_t *map;
+    size_t map_size;
+    const romdb_pack_header *header;
+    const romdb_pack_entry *entries;
+} romdb_pack;
+
+/* ROM to be written into a pack */
+typedef struct romdb_pack_input {
+    const char *name;
+    const uint8_t *data;
+    size_t size;
+    romdb_settings settings;
+} romdb_pack_input;
+
+uint64_t romdb_hash(const uint8_t *rom, size_t size);
+
+void romdb_settings_default(romdb_settings *settings);
+
+/* Apply settings to a freshly reset VM */
+void romdb_settings_apply(const romdb_settings *settings, chip8 *vm);
+
+/* Database line for a ROM, without the trailing newline */
+void romdb_format_record(const romdb_record *record, char *buf, size_t size);
+
+int romdb_load(const char *path, romdb **db);
+
+void romdb_free(romdb *db);
+
+bool romdb_lookup(const romdb *db, uint64_t hash, romdb_settings *settings);
+
+int romdb_pack_write(const char *path, const romdb_pack_input *roms, size_t count);
+
+int romdb_pack_open(const char *path, romdb_pack **pack);
+
+void romdb_pack_close(romdb_pack *pack);
+
+size_t romdb_pack_count(const romdb_pack *pack);
+
+const romdb_pack_entry *romdb_pack_entry_at(const romdb_pack *pack, size_t i);
+
+/* NULL if there is no ROM with the hash */
+const romdb_pack_entry *romdb_pack_find(const romdb_pack *pack, uint64_t hash);
+
+const uint8_t *romdb_pack_rom(const romdb_pack *pack, const romdb_pack_entry *entry);
+
+const char *romdb_pack_name(const romdb_pack *pack, const romdb_pack_entry *entry);
+
+#endif /* ROMDB_H */
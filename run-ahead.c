@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "run-ahead.h"
+#include "keyboard.h"
+#include "fb-console.h"
+
+struct run_ahead {
+    uint32_t frames;
+
+    /* The real machine while running ahead */
+    uint8_t *state;
+    keyboard *key;
+    audio *sound;
+    profile *prof;
+    latency *lat;
+    uint64_t usec_elapsed;
+    uint64_t usec_frame_start;
+
+    /* Input snapshot for speculative frames */
+    keyboard *held_keys;
+
+    /* Last future frame presented */
+    uint64_t presented_hash;
+    bool is_presented;
+};
+
+int run_ahead_new(uint32_t frames, run_ahead **ra)
+{
+    *ra = calloc(1, sizeof(**ra));
+    if (!*ra) {
+        fprintf(stderr, "Calloc failure\n");
+        return RUN_AHEAD_FAIL;
+    }
+
+    run_ahead *r = *ra;
+    r->frames = frames;
+    r->state = malloc(CHIP8_MAX_STATE_BYTES);
+    if (!r->state) {
+        fprintf(stderr, "Malloc failure\n");
+        run_ahead_free(r);
+        *ra = NULL;
+        return RUN_AHEAD_FAIL;
+    }
+    if (keyboard_new_virtual(&r->held_keys) != KEYBOARD_SUCCESS) {
+        run_ahead_free(r);
+        *ra = NULL;
+        return RUN_AHEAD_FAIL;
+    }
+
+    return RUN_AHEAD_SUCCESS;
+}
+
+void run_ahead_free(run_ahead *ra)
+{
+    if (!ra)
+        return;
+    keyboard_free(ra->held_keys);
+    free(ra->state);
+    free(ra);
+}
+
+int run_ahead_begin(run_ahead *ra, chip8 *vm)
+{
+    bool keys[CHIP8_KEY_COUNT] = {0};
+    if (keyboard_get_key_state(vm->key, keys) != KEYBOARD_SUCCESS)
+        return CHIP8_FAIL;
+    for (int k = 0; k < CHIP8_KEY_COUNT; k++)
+        keyboard_set_key(ra->held_keys, k, keys[k]);
+
+    chip8_save_state(vm, ra->state);
+    ra->key = vm->key;
+    ra->sound = vm->sound;
+    ra->prof = vm->prof;
+    ra->lat = vm->lat;
+    ra->usec_elapsed = vm->usec_elapsed;
+    ra->usec_frame_start = vm->usec_frame_start;
+
+    vm->key = ra->held_keys;
+    chip8_set_audio(vm, NULL);
+    chip8_set_profile(vm, NULL);
+    chip8_set_latency(vm, NULL);
+
+    for (uint32_t frame = 0; frame < ra->frames; frame++)
+        if (chip8_run_frame(vm) == CHIP8_FAULT)
+            break;
+
+    /* Presenting is real, only the sound waits for the state */
+    chip8_set_profile(vm, ra->prof);
+    chip8_set_latency(vm, ra->lat);
+
+    vm->display->is_dirty = !ra->is_presented ||
+        ra->presented_hash != fb_frame_hash(vm->display);
+
+    return CHIP8_SUCCESS;
+}
+
+void run_ahead_end(run_ahead *ra, chip8 *vm)
+{
+    if (!vm->display->is_dirty) {
+        ra->presented_hash = fb_frame_hash(vm->display);
+        ra->is_presented = true;
+    }
+
+    /* Attachments first, loading doesn't touch them */
+    vm->key = ra->key;
+    chip8_load_state(vm, ra->state);
+    vm->usec_elapsed = ra->usec_elapsed;
+    vm->usec_frame_start = ra->usec_frame_start;
+    chip8_set_audio(vm, ra->sound);
+
+    /* The screen shows the future frame, not this one */
+    vm->display->is_dirty = false;
+}
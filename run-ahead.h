@@ -0,0 +1,43 @@
+#ifndef RUN_AHEAD_H
+#define RUN_AHEAD_H
+
+#include <stdint.h>
+
+#include "chip8.h"
+
+/*
+ * Run-ahead
+ *
+ * Games tend to show a key press a frame or two after SKP/SKNP sees it. To
+ * hide that, every presented frame comes from frames ahead of the machine:
+ * the state is saved, the machine runs that many frames with the input held
+ * as it is now, the display is presented and then everything is put back.
+ *
+ * Speculative frames are muted, unprofiled and don't count for latency, the
+ * emulated clock does not move and they read a snapshot of the keys so that
+ * FX0A never blocks or takes a key press from the real frames.
+ */
+
+#define RUN_AHEAD_MAX_FRAMES 8
+
+enum run_ahead_status {
+    RUN_AHEAD_SUCCESS,
+    RUN_AHEAD_FAIL,
+};
+
+typedef struct run_ahead run_ahead;
+
+int run_ahead_new(uint32_t frames, run_ahead **ra);
+
+void run_ahead_free(run_ahead *ra);
+
+/* Run frames ahead of the machine, the display is left with the future one
+ * and is dirty if that differs from the last one presented. CHIP8_FAIL if the
+ * keys couldn't be read, a speculative fault or halt is just where the frame
+ * ends. */
+int run_ahead_begin(run_ahead *ra, chip8 *vm);
+
+/* Restore the machine after presenting */
+void run_ahead_end(run_ahead *ra, chip8 *vm);
+
+#endif /* RUN_AHEAD_H */
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include "shm-export.h"
+
+/* Reader attempts before giving up on a writer busy all the time */
+#define SHM_EXPORT_READ_RETRIES 1000
+
+struct shm_export {
+    char *name;
+    shm_export_region *region;
+};
+
+int shm_export_new(const char *name, shm_export **ex)
+{
+    *ex = calloc(1, sizeof(**ex));
+    if (!*ex) {
+        fprintf(stderr, "Calloc failure\n");
+        return SHM_EXPORT_FAIL;
+    }
+
+    (*ex)->name = strdup(name);
+    if (!(*ex)->name) {
+        fprintf(stderr, "Strdup failure\n");
+        goto err;
+    }
+
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd == -1) {
+        perror("shm_open");
+        goto err;
+    }
+
+    if (ftruncate(fd, sizeof(shm_export_region)) == -1) {
+        perror("ftruncate");
+        close(fd);
+        goto err_unlink;
+    }
+
+    void *region = mmap(NULL, sizeof(shm_export_region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (region == MAP_FAILED) {
+        perror("mmap");
+        goto err_unlink;
+    }
+
+    shm_export_region *r = region;
+    memset(r, 0, sizeof(*r));
+    r->version = SHM_EXPORT_VERSION;
+    r->width = FRAMEBUF_WIDTH;
+    r->height = FRAMEBUF_MAX_HEIGHT;
+    r->planes = FRAMEBUF_PLANES;
+    atomic_init(&r->seq, 0);
+    /* Magic last, readers may be polling for it already */
+    atomic_thread_fence(memory_order_release);
+    r->magic = SHM_EXPORT_MAGIC;
+
+    (*ex)->region = r;
+    return SHM_EXPORT_SUCCESS;
+
+err_unlink:
+    shm_unlink(name);
+err:
+    free((*ex)->name);
+    free(*ex);
+    *ex = NULL;
+    return SHM_EXPORT_FAIL;
+}
+
+void shm_export_free(shm_export *ex)
+{
+    if (!ex)
+        return;
+
+    munmap(ex->region, sizeof(*ex->region));
+    shm_unlink(ex->name);
+    free(ex->name);
+    free(ex);
+}
+
+void shm_export_publish(shm_export *ex, const fb_console *fb, const bool keys[CHIP8_KEY_COUNT])
+{
+    shm_export_region *r = ex->region;
+
+    uint16_t key_bits = 0;
+    for (int key = 0; key < CHIP8_KEY_COUNT; key++)
+        key_bits |= (uint16_t)keys[key] << key;
+
+    /* Odd while writing */
+    unsigned seq = atomic_load_explicit(&r->seq, memory_order_relaxed);
+    atomic_store_explicit(&r->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    r->frame++;
+    r->keys = key_bits;
+    r->rows = fb->height;
+    memcpy(r->fb, fb->fb, sizeof(r->fb));
+
+    atomic_store_explicit(&r->seq, seq + 2, memory_order_release);
+}
+
+const shm_export_region *shm_export_map(const char *name)
+{
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd == -1)
+        return NULL;
+
+    void *region = mmap(NULL, sizeof(shm_export_region), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    return region == MAP_FAILED ? NULL : region;
+}
+
+void shm_export_unmap(const shm_export_region *region)
+{
+    munmap((void *)region, sizeof(*region));
+}
+
+bool shm_export_read(const shm_export_region *region, shm_export_frame *out)
+{
+    if (region->magic != SHM_EXPORT_MAGIC || region->version != SHM_EXPORT_VERSION)
+        return false;
+
+    /* Readers never write, seq is only loaded */
+    atomic_uint *seq = (atomic_uint *)&region->seq;
+
+    for (int i = 0; i < SHM_EXPORT_READ_RETRIES; i++) {
+        unsigned before = atomic_load_explicit(seq, memory_order_acquire);
+        if (before & 1)
+            continue;
+
+        out->frame = region->frame;
+        out->keys = region->keys;
+        out->rows = region->rows;
+        memcpy(out->fb, region->fb, sizeof(out->fb));
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(seq, memory_order_relaxed) == before)
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,74 @@
+#ifndef SHM_EXPORT_H
+#define SHM_EXPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "fb-console.h"
+
+/*
+ * Framebuffer export through POSIX shared memory
+ *
+ * The emulator keeps the current frame and key state in a shared memory
+ * object (/dev/shm/<name>) that viewers map read-only. Publishing a frame is
+ * a few stores and a copy, no syscalls.
+ *
+ * Consistency is a seqlock: seq is odd while the emulator is writing, a
+ * reader copies what it needs and retries if seq was odd or changed in the
+ * meantime, see shm_export_read().
+ */
+
+#define SHM_EXPORT_MAGIC 0x50434853 /* "PCHS" */
+#define SHM_EXPORT_VERSION 2
+
+enum shm_export_status {
+    SHM_EXPORT_SUCCESS,
+    SHM_EXPORT_FAIL,
+};
+
+/* Native endianness, both ends are on the same host */
+typedef struct shm_export_region {
+    uint32_t magic;
+    uint32_t version;
+    uint16_t width;
+    uint16_t height;            /* Rows per plane, FRAMEBUF_MAX_HEIGHT */
+    uint8_t planes;
+    uint8_t reserved[3];
+    atomic_uint seq;
+    /* Everything below is covered by seq */
+    uint64_t frame;             /* Published frames so far */
+    uint16_t keys;              /* Bit N for CHIP-8 key N pressed */
+    uint16_t rows;              /* Rows in use, the rest are blank */
+    /* Rows as in fb_console, MSB being the leftmost pixel */
+    fb_row fb[FRAMEBUF_PLANES][FRAMEBUF_MAX_HEIGHT];
+} shm_export_region;
+
+/* What a reader gets, a consistent copy */
+typedef struct shm_export_frame {
+    uint64_t frame;
+    uint16_t keys;
+    uint16_t rows;
+    fb_row fb[FRAMEBUF_PLANES][FRAMEBUF_MAX_HEIGHT];
+} shm_export_frame;
+
+typedef struct shm_export shm_export;
+
+/* Create (or take over) the shared memory object, name as in shm_open(3) */
+int shm_export_new(const char *name, shm_export **ex);
+
+/* Unmap and remove the object, mapped readers keep their view */
+void shm_export_free(shm_export *ex);
+
+void shm_export_publish(shm_export *ex, const fb_console *fb, const bool keys[CHIP8_KEY_COUNT]);
+
+/* Reader side: map an exported object read-only, NULL on failure */
+const shm_export_region *shm_export_map(const char *name);
+
+void shm_export_unmap(const shm_export_region *region);
+
+/* Reader side: a consistent copy of the last published frame, false if the
+ * region isn't an export or the writer kept getting in the way */
+bool shm_export_read(const shm_export_region *region, shm_export_frame *out);
+
+#endif /* SHM_EXPORT_H */
@@ -0,0 +1,116 @@
+/*
+ * pchip-watch: reference frame stream subscriber, renders to the terminal
+ *
+ *   pchip-watch <path/to/socket>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "stream.h"
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s <path/to/socket>\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+/* Read exactly bytes, false on EOF or an error */
+static bool read_full(int fd, void *buf, size_t bytes)
+{
+    uint8_t *p = buf;
+    while (bytes) {
+        ssize_t got = read(fd, p, bytes);
+        if (got <= 0)
+            return false;
+        p += got;
+        bytes -= got;
+    }
+    return true;
+}
+
+static void render(const uint8_t *frame, uint32_t frame_no, uint16_t height)
+{
+    /* Same characters as fb_redraw() */
+    static const char pixel_chars[1 << FRAMEBUF_PLANES] = { ' ', '0', '+', '#' };
+    static const size_t plane_bytes = FRAMEBUF_MAX_HEIGHT * STREAM_ROW_BYTES;
+    static uint16_t last_height;
+    char line[FRAMEBUF_WIDTH + 4];
+
+    /* Home instead of reset, no flicker, unless the resolution changed */
+    if (height != last_height)
+        fputs("\033[2J", stdout);
+    last_height = height;
+    fputs("\033[H", stdout);
+
+    memset(line, '-', sizeof(line));
+    line[0] = line[FRAMEBUF_WIDTH + 1] = '*';
+    fprintf(stdout, "%.*s\n", FRAMEBUF_WIDTH + 2, line);
+
+    for (size_t y = 0; y < height; y++) {
+        line[0] = '|';
+        for (size_t x = 0; x < FRAMEBUF_WIDTH; x++) {
+            size_t byte = y * STREAM_ROW_BYTES + x / 8;
+            unsigned pixel = 0;
+            for (size_t plane = 0; plane < FRAMEBUF_PLANES; plane++)
+                pixel |= ((frame[plane * plane_bytes + byte] >> (7 - x % 8)) & 0x1) << plane;
+            line[x + 1] = pixel_chars[pixel];
+        }
+        line[FRAMEBUF_WIDTH + 1] = '|';
+        fprintf(stdout, "%.*s\n", FRAMEBUF_WIDTH + 2, line);
+    }
+
+    memset(line, '-', sizeof(line));
+    line[0] = line[FRAMEBUF_WIDTH + 1] = '*';
+    fprintf(stdout, "%.*s\nframe %u\n", FRAMEBUF_WIDTH + 2, line, frame_no);
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+        usage(argv[0]);
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(argv[1]) >= sizeof(addr.sun_path))
+        usage(argv[0]);
+    strcpy(addr.sun_path, argv[1]);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        perror(argv[1]);
+        exit(EXIT_FAILURE);
+    }
+
+    uint8_t frame[STREAM_FRAME_BYTES] = {0};
+    uint8_t payload[STREAM_MAX_PAYLOAD];
+    stream_header header;
+
+    fputs("\033c", stdout);
+    while (read_full(fd, &header, sizeof(header))) {
+        if (header.magic != STREAM_MAGIC || header.width != FRAMEBUF_WIDTH ||
+            header.height > FRAMEBUF_MAX_HEIGHT || header.planes != FRAMEBUF_PLANES ||
+            header.payload_bytes > sizeof(payload)) {
+            fprintf(stderr, "Unsupported stream\n");
+            exit(EXIT_FAILURE);
+        }
+        if (!read_full(fd, payload, header.payload_bytes))
+            break;
+
+        if (header.type == STREAM_FRAME_KEY)
+            memset(frame, 0, sizeof(frame));
+        if (delta_apply(frame, sizeof(frame), payload, header.payload_bytes) != DELTA_SUCCESS) {
+            fprintf(stderr, "Corrupt frame %u\n", header.frame);
+            exit(EXIT_FAILURE);
+        }
+
+        render(frame, header.frame, header.height);
+    }
+
+    close(fd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,241 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "stream.h"
+
+typedef struct stream_client {
+    int fd;
+    /* Got the last published frame, the shared delta applies */
+    bool is_synced;
+    bool is_new;
+    /* What the subscriber has when it isn't synced */
+    uint8_t frame[STREAM_FRAME_BYTES];
+    uint8_t height;
+    /* Message in flight */
+    uint8_t out[STREAM_MAX_MESSAGE];
+    size_t out_bytes;
+    size_t out_sent;
+} stream_client;
+
+struct stream {
+    int fd;
+    struct sockaddr_un addr;
+    uint32_t frame;
+    uint64_t skipped_frames;
+    /* Last published frame */
+    uint8_t last[STREAM_FRAME_BYTES];
+    uint8_t height;
+    stream_client clients[STREAM_MAX_CLIENTS];
+    size_t client_count;
+};
+
+int stream_new(const char *path, stream **srv)
+{
+    if (strlen(path) >= sizeof((*srv)->addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return STREAM_FAIL;
+    }
+
+    *srv = calloc(1, sizeof(**srv));
+    if (!*srv) {
+        fprintf(stderr, "Calloc failure\n");
+        return STREAM_FAIL;
+    }
+
+    stream *s = *srv;
+    s->addr.sun_family = AF_UNIX;
+    strcpy(s->addr.sun_path, path);
+
+    s->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (s->fd == -1) {
+        perror("socket");
+        goto err;
+    }
+
+    unlink(path);
+    if (bind(s->fd, (struct sockaddr *)&s->addr, sizeof(s->addr)) == -1) {
+        perror("bind");
+        goto err;
+    }
+
+    if (listen(s->fd, STREAM_MAX_CLIENTS) == -1) {
+        perror("listen");
+        unlink(path);
+        goto err;
+    }
+
+    return STREAM_SUCCESS;
+
+err:
+    if (s->fd != -1)
+        close(s->fd);
+    free(s);
+    *srv = NULL;
+    return STREAM_FAIL;
+}
+
+static void drop_client(stream *srv, size_t i)
+{
+    close(srv->clients[i].fd);
+    srv->clients[i] = srv->clients[--srv->client_count];
+}
+
+void stream_free(stream *srv)
+{
+    if (!srv)
+        return;
+
+    while (srv->client_count)
+        drop_client(srv, 0);
+    close(srv->fd);
+    unlink(srv->addr.sun_path);
+    free(srv);
+}
+
+size_t stream_client_count(const stream *srv)
+{
+    return srv->client_count;
+}
+
+uint64_t stream_skipped_frames(const stream *srv)
+{
+    return srv->skipped_frames;
+}
+
+void stream_pack_frame(const fb_console *fb, uint8_t frame[STREAM_FRAME_BYTES])
+{
+    for (size_t plane = 0; plane < FRAMEBUF_PLANES; plane++) {
+        for (size_t y = 0; y < FRAMEBUF_MAX_HEIGHT; y++) {
+            fb_row row = fb->fb[plane][y];
+            for (size_t i = 0; i < STREAM_ROW_BYTES; i++)
+                *frame++ = row >> (FRAMEBUF_WIDTH - 8 * (i + 1));
+        }
+    }
+}
+
+static void accept_clients(stream *srv)
+{
+    for (;;) {
+        /* Sends are MSG_DONTWAIT, the socket itself can stay blocking */
+        int fd = accept(srv->fd, NULL, NULL);
+        if (fd == -1)
+            return;
+
+        if (srv->client_count == STREAM_MAX_CLIENTS) {
+            close(fd);
+            continue;
+        }
+
+        stream_client *client = &srv->clients[srv->client_count++];
+        client->fd = fd;
+        client->is_synced = false;
+        client->is_new = true;
+        client->out_bytes = client->out_sent = 0;
+        memset(client->frame, 0, sizeof(client->frame));
+    }
+}
+
+/* Send what's left of the message in flight, false if the client is gone */
+static bool flush_client(stream_client *client)
+{
+    while (client->out_sent < client->out_bytes) {
+        ssize_t sent = send(client->fd, client->out + client->out_sent,
+                            client->out_bytes - client->out_sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent == -1)
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        client->out_sent += sent;
+    }
+    return true;
+}
+
+static size_t write_message(stream *srv, uint8_t *out, enum stream_frame_type type, uint8_t height,
+                            const uint8_t *payload, size_t payload_bytes)
+{
+    stream_header header = {
+        .magic = STREAM_MAGIC,
+        .frame = srv->frame,
+        .width = FRAMEBUF_WIDTH,
+        .height = height,
+        .planes = FRAMEBUF_PLANES,
+        .type = type,
+        .payload_bytes = payload_bytes,
+    };
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), payload, payload_bytes);
+    return sizeof(header) + payload_bytes;
+}
+
+void stream_publish(stream *srv, const fb_console *fb)
+{
+    accept_clients(srv);
+
+    uint8_t cur[STREAM_FRAME_BYTES];
+    stream_pack_frame(fb, cur);
+
+    /* The delta every synced client gets, encoded once */
+    uint8_t shared[STREAM_MAX_MESSAGE];
+    size_t shared_bytes = 0;
+    bool is_shared_encoded = false;
+
+    for (size_t i = 0; i < srv->client_count;) {
+        stream_client *client = &srv->clients[i];
+
+        if (!flush_client(client)) {
+            drop_client(srv, i);
+            continue;
+        }
+
+        /* Still busy with an older frame, catch up later */
+        if (client->out_sent < client->out_bytes) {
+            if (client->is_synced) {
+                memcpy(client->frame, srv->last, sizeof(client->frame));
+                client->height = srv->height;
+            }
+            client->is_synced = false;
+            srv->skipped_frames++;
+            i++;
+            continue;
+        }
+
+        if (client->is_synced) {
+            if (!is_shared_encoded) {
+                uint8_t payload[STREAM_MAX_PAYLOAD];
+                size_t payload_bytes = delta_encode(srv->last, cur, sizeof(cur), payload);
+                /* A new resolution is news even with nothing on the screen */
+                if (payload_bytes || fb->height != srv->height)
+                    shared_bytes = write_message(srv, shared, STREAM_FRAME_DELTA, fb->height,
+                                                 payload, payload_bytes);
+                is_shared_encoded = true;
+            }
+            memcpy(client->out, shared, shared_bytes);
+            client->out_bytes = shared_bytes;
+        } else {
+            uint8_t payload[STREAM_MAX_PAYLOAD];
+            size_t payload_bytes = delta_encode(client->frame, cur, sizeof(cur), payload);
+            if (payload_bytes || client->is_new || fb->height != client->height)
+                client->out_bytes = write_message(srv, client->out,
+                                                  client->is_new ? STREAM_FRAME_KEY : STREAM_FRAME_DELTA,
+                                                  fb->height, payload, payload_bytes);
+            else
+                client->out_bytes = 0;
+            client->is_new = false;
+            client->is_synced = true;
+        }
+        client->out_sent = 0;
+
+        if (!flush_client(client)) {
+            drop_client(srv, i);
+            continue;
+        }
+        i++;
+    }
+
+    memcpy(srv->last, cur, sizeof(cur));
+    srv->height = fb->height;
+    srv->frame++;
+}
@@ -0,0 +1,79 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "fb-console.h"
+#include "delta.h"
+
+/*
+ * Frame streaming over a Unix domain socket
+ *
+ * Every presented frame is sent to every subscriber as a message: a header
+ * followed by the XOR of the frame against the previous one the subscriber
+ * got, run-length encoded. The first message is a keyframe, i.e. a delta
+ * against a blank screen.
+ *
+ * Frames are the planes one after another, rows top to bottom, row bytes left
+ * to right with the MSB being the leftmost pixel. Planes always have
+ * FRAMEBUF_MAX_HEIGHT rows, the ones past the header height are blank.
+ *
+ * Payloads are delta.h encoded, an unchanged frame is never sent.
+ *
+ * Sending never blocks. A subscriber that hasn't taken the previous message
+ * yet skips frames and gets a delta against whatever it has once it catches
+ * up.
+ */
+
+#define STREAM_MAGIC 0x50434846 /* "PCHF" */
+#define STREAM_MAX_CLIENTS 64
+
+#define STREAM_ROW_BYTES (FRAMEBUF_WIDTH / 8)
+#define STREAM_FRAME_BYTES (FRAMEBUF_PLANES * FRAMEBUF_MAX_HEIGHT * STREAM_ROW_BYTES)
+#define STREAM_MAX_PAYLOAD DELTA_MAX_ENCODED(STREAM_FRAME_BYTES)
+
+enum stream_status {
+    STREAM_SUCCESS,
+    STREAM_FAIL,
+};
+
+enum stream_frame_type {
+    STREAM_FRAME_KEY,
+    STREAM_FRAME_DELTA,
+};
+
+/* Native endianness, both ends are on the same host */
+typedef struct stream_header {
+    uint32_t magic;
+    uint32_t frame;             /* Server frame counter */
+    uint16_t width;
+    uint16_t height;            /* Rows in use */
+    uint8_t planes;
+    uint8_t type;               /* enum stream_frame_type */
+    uint16_t payload_bytes;
+} stream_header;
+
+#define STREAM_MAX_MESSAGE (sizeof(stream_header) + STREAM_MAX_PAYLOAD)
+
+typedef struct stream stream;
+
+/* Listen on path, replacing a stale socket */
+int stream_new(const char *path, stream **srv);
+
+/* Disconnect everybody and remove the socket */
+void stream_free(stream *srv);
+
+/* Take new subscribers and send them the frame, never blocks */
+void stream_publish(stream *srv, const fb_console *fb);
+
+size_t stream_client_count(const stream *srv);
+
+/* Frames not sent to slow subscribers, all of them together */
+uint64_t stream_skipped_frames(const stream *srv);
+
+/* Frame bytes in the wire layout */
+void stream_pack_frame(const fb_console *fb, uint8_t frame[STREAM_FRAME_BYTES]);
+
+#endif /* STREAM_H */
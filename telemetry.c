@@ -0,0 +1,101 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "telemetry.h"
+#include "chip8.h"
+
+static const char *phase_names[TELEMETRY_PHASE_COUNT] = {
+    [TELEMETRY_EXECUTE] = "execute",
+    [TELEMETRY_INPUT] = "input",
+    [TELEMETRY_RENDER] = "render",
+    [TELEMETRY_SLEEP] = "sleep",
+};
+
+int telemetry_new(uint64_t usec_now, telemetry **tel)
+{
+    *tel = calloc(1, sizeof(**tel));
+    if (!*tel) {
+        fprintf(stderr, "Calloc failure\n");
+        return TELEMETRY_FAIL;
+    }
+
+    (*tel)->phase = TELEMETRY_EXECUTE;
+    (*tel)->usec_phase_start = usec_now;
+    (*tel)->usec_window_start = usec_now;
+    return TELEMETRY_SUCCESS;
+}
+
+void telemetry_free(telemetry *tel)
+{
+    free(tel);
+}
+
+void telemetry_enter(telemetry *tel, enum telemetry_phase phase, uint64_t usec_now)
+{
+    if (!tel)
+        return;
+
+    uint64_t usec = usec_now - tel->usec_phase_start;
+    tel->usec_phases[tel->phase] += usec;
+    tel->usec_window_phases[tel->phase] += usec;
+    tel->phase = phase;
+    tel->usec_phase_start = usec_now;
+
+    if (usec_now - tel->usec_window_start >= TELEMETRY_USEC_WINDOW) {
+        memcpy(tel->usec_last_window_phases, tel->usec_window_phases, sizeof(tel->usec_window_phases));
+        memset(tel->usec_window_phases, 0, sizeof(tel->usec_window_phases));
+        tel->usec_window_start = usec_now;
+    }
+}
+
+void telemetry_wakeup(telemetry *tel, uint64_t usec_deadline, uint64_t usec_now)
+{
+    if (!tel)
+        return;
+
+    tel->ticks++;
+    histogram_record(&tel->jitter, usec_now > usec_deadline ? usec_now - usec_deadline : 0);
+}
+
+void telemetry_tick_done(telemetry *tel, uint64_t usec_deadline, uint64_t usec_now)
+{
+    if (!tel || usec_now <= usec_deadline)
+        return;
+
+    tel->overruns++;
+    tel->usec_overrun += usec_now - usec_deadline;
+}
+
+void telemetry_dropped(telemetry *tel, uint64_t usec)
+{
+    if (tel)
+        tel->usec_dropped += usec;
+}
+
+static void report_split(const char *title, const uint64_t usec_phases[TELEMETRY_PHASE_COUNT], FILE *out)
+{
+    uint64_t usec_total = 0;
+    for (int phase = 0; phase < TELEMETRY_PHASE_COUNT; phase++)
+        usec_total += usec_phases[phase];
+
+    fprintf(out, "%-12s", title);
+    for (int phase = 0; phase < TELEMETRY_PHASE_COUNT; phase++)
+        fprintf(out, " %s %5.1f%%", phase_names[phase],
+                usec_total ? 100.0 * usec_phases[phase] / usec_total : 0.0);
+    fputc('\n', out);
+}
+
+void telemetry_report(const telemetry *tel, FILE *out)
+{
+    fprintf(out, "Host ticks: %llu at %dHz\n", (unsigned long long)tel->ticks, FREQUENCY_TIMER);
+    fprintf(out, "Overruns: %llu (%.2f%%), %.2f ms past deadlines, %.2f ms dropped\n",
+            (unsigned long long)tel->overruns,
+            tel->ticks ? 100.0 * tel->overruns / tel->ticks : 0.0,
+            tel->usec_overrun / 1000.0, tel->usec_dropped / 1000.0);
+    fprintf(out, "Wakeup jitter, ms: p50 %.3f, p99 %.3f, max %.3f\n",
+            histogram_percentile(&tel->jitter, 0.50) / 1000.0,
+            histogram_percentile(&tel->jitter, 0.99) / 1000.0, tel->jitter.max / 1000.0);
+    report_split("Last second:", tel->usec_last_window_phases, out);
+    report_split("Session:", tel->usec_phases, out);
+    fflush(out);
+}
@@ -0,0 +1,77 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "histogram.h"
+
+/*
+ * Host scheduling telemetry
+ *
+ * The host loop sleeps until an absolute deadline every 60Hz tick and runs
+ * a frame of FREQUENCY_CPU / FREQUENCY_TIMER instructions in one go. This
+ * tells how well the host keeps up with that: how late wakeups are, how
+ * often a tick's work runs past the next deadline and by how much, and what
+ * the time goes to.
+ *
+ * All functions take a NULL telemetry and do nothing, times are usec of
+ * CLOCK_MONOTONIC.
+ */
+
+enum telemetry_status {
+    TELEMETRY_SUCCESS,
+    TELEMETRY_FAIL,
+};
+
+enum telemetry_phase {
+    TELEMETRY_EXECUTE,
+    TELEMETRY_INPUT,
+    TELEMETRY_RENDER,
+    TELEMETRY_SLEEP,
+    TELEMETRY_PHASE_COUNT
+};
+
+/* The time split is also kept for the last complete window */
+#define TELEMETRY_USEC_WINDOW 1000000
+
+typedef struct telemetry {
+    uint64_t ticks;
+
+    /* Wakeups past the deadline */
+    histogram jitter;
+
+    /* Ticks whose work ran past the next deadline, by how much in total */
+    uint64_t overruns;
+    uint64_t usec_overrun;
+    /* Deadlines given up on instead of being caught up with */
+    uint64_t usec_dropped;
+
+    uint8_t phase;
+    uint64_t usec_phase_start;
+    uint64_t usec_phases[TELEMETRY_PHASE_COUNT];
+
+    uint64_t usec_window_start;
+    uint64_t usec_window_phases[TELEMETRY_PHASE_COUNT];
+    uint64_t usec_last_window_phases[TELEMETRY_PHASE_COUNT];
+} telemetry;
+
+int telemetry_new(uint64_t usec_now, telemetry **tel);
+
+void telemetry_free(telemetry *tel);
+
+/* From now on the time goes to phase */
+void telemetry_enter(telemetry *tel, enum telemetry_phase phase, uint64_t usec_now);
+
+/* Woke up for a tick */
+void telemetry_wakeup(telemetry *tel, uint64_t usec_deadline, uint64_t usec_now);
+
+/* The tick's work is done, the next deadline is usec_deadline */
+void telemetry_tick_done(telemetry *tel, uint64_t usec_deadline, uint64_t usec_now);
+
+/* Deadlines moved forward by usec instead of being caught up with */
+void telemetry_dropped(telemetry *tel, uint64_t usec);
+
+void telemetry_report(const telemetry *tel, FILE *out);
+
+#endif /* TELEMETRY_H */
@@ -3,9 +3,68 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 
 #include "chip8.h"
 #include "keyboard.h"
+#include "profile.h"
+#include "vip-timing.h"
+#include "aot.h"
+#include "romdb.h"
+#include "pchip.h"
+#include "batch-env.h"
+#include "stream.h"
+#include "shm-export.h"
+#include "debugger.h"
+#include "history.h"
+#include "fast-forward.h"
+#include "run-ahead.h"
+#include "latency.h"
+#include "telemetry.h"
+#include "lockstep.h"
+
+/* What pchip-aot emits for "loop: ADD V0, 1; JP loop" */
+static void aot_test_block(chip8 *vm, aot *rt)
+{
+    (void)rt;
+
+    vm->regs[0x0] += 0x01;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    if (vm->cycles_left <= 0) {
+        vm->PC = 0x202;
+        return;
+    }
+
+    vm->PC = 0x200;
+    vm->cycles_left -= vm->usec_per_cpu_step;
+    return;
+}
+
+static const uint8_t aot_test_rom[] = {0x70, 0x01, 0x12, 0x00};
+
+static const aot_block aot_test_blocks[] = {
+    {0x200, 0x204, aot_test_block},
+};
+
+static const aot_program aot_test_program = {
+    .rom = aot_test_rom,
+    .rom_size = sizeof(aot_test_rom),
+    .blocks = aot_test_blocks,
+    .block_count = 1,
+};
+
+/* A faster core gone wrong: 8XY6 shifts twice */
+static int test_broken_exec(chip8 *vm, uint16_t instruction)
+{
+    int rc = chip8_exec_generic(vm, instruction);
+    if ((instruction & 0xf00f) == 0x8006)
+        vm->regs[(instruction >> 8) & 0xf] >>= 1;
+    return rc;
+}
 
 int main(int argc, char *argv[])
 {
@@ -689,6 +748,1169 @@ int main(int argc, char *argv[])
 
     }
 
+    {
+        /* XO-CHIP: LD I, nnnn */
+
+        chip8 vm;
+        chip8_reset(&vm, key, display);
+        chip8_set_mode(&vm, CHIP8_MODE_XOCHIP);
+
+        vm.ram[vm.PC + 2] = 0xbe;
+        vm.ram[vm.PC + 3] = 0xef;
+        chip8_exec(&vm, 0xf000);
+        assert(vm.I == 0xbeef);
+        assert(vm.PC == PROGRAM_START_BYTES + 4);
+
+        /* skips jump over the whole 4-byte instruction */
+        vm.ram[vm.PC + 2] = 0xf0;
+        vm.ram[vm.PC + 3] = 0x00;
+        vm.regs[V1] = 0x11;
+        chip8_exec(&vm, INSTR_XKK(0x3, V1, 0x11));
+        assert(vm.PC == PROGRAM_START_BYTES + 10);
+    }
+
+    {
+        /* XO-CHIP: LD [I], Vx-Vy and LD Vx-Vy, [I] */
+
+        chip8 vm;
+        chip8_reset(&vm, key, display);
+        chip8_set_mode(&vm, CHIP8_MODE_XOCHIP);
+
+        vm.I = 0xf000;
+        vm.regs[V1] = 1;
+        vm.regs[V2] = 2;
+        vm.regs[V3] = 3;
+
+        chip8_exec(&vm, INSTR_XY_N(0x5, V1, V3, 0x2));
+        assert(vm.I == 0xf000);
+        assert(vm.ram[0xf000] == 1);
+        assert(vm.ram[0xf001] == 2);
+        assert(vm.ram[0xf002] == 3);
+
+        chip8_exec(&vm, INSTR_XY_N(0x5, V6, V4, 0x3));
+        assert(vm.regs[V6] == 1);
+        assert(vm.regs[V5] == 2);
+        assert(vm.regs[V4] == 3);
+    }
+
+    {
+        /* XO-CHIP: PLANE n, DRW on both planes */
+
+        chip8 vm;
+        chip8_reset(&vm, key, display);
+        chip8_set_mode(&vm, CHIP8_MODE_XOCHIP);
+
+        chip8_exec(&vm, INSTR_XKK(0xf, 0x3, 0x01));
+        chip8_exec(&vm, INSTR_NNN(0x0, 0x00e0));
+
+        vm.I = 0x300;
+        vm.ram[0x300] = 0xff;
+        vm.ram[0x301] = 0x0f;
+        vm.regs[V0] = 60;
+        vm.regs[V1] = 31;
+        chip8_exec(&vm, INSTR_XY_N(0xd, V0, V1, 1));
+        assert(!vm.regs[Vf]);
+        /* wraps around both ways */
+        assert(display->fb[0][31] == 0xf00000000000000full);
+        assert(display->fb[1][31] == 0xf000000000000000ull);
+
+        chip8_exec(&vm, INSTR_XKK(0xf, 0x2, 0x01));
+        chip8_exec(&vm, INSTR_XY_N(0xd, V0, V1, 1));
+        assert(vm.regs[Vf]);
+        assert(display->fb[0][31] == 0xf00000000000000full);
+        assert(display->fb[1][31] == 0x000000000000000full);
+
+        chip8_redraw(&vm);
+        printf("two planes drawn...");
+        sleep(1);
+    }
+
+    {
+        /* XO-CHIP: AUDIO, PITCH Vx */
+
+        chip8 vm;
+        chip8_reset(&vm, key, display);
+        chip8_set_mode(&vm, CHIP8_MODE_XOCHIP);
+
+        assert(vm.pitch == AUDIO_PITCH_DEFAULT);
+
+        vm.I = 0x400;
+        for (size_t i = 0; i < AUDIO_PATTERN_BYTES; i++)
+            vm.ram[vm.I + i] = i;
+        chip8_exec(&vm, 0xf002);
+        assert(vm.audio_pattern[0] == 0);
+        assert(vm.audio_pattern[AUDIO_PATTERN_BYTES - 1] == AUDIO_PATTERN_BYTES - 1);
+
+        vm.regs[V1] = 0x70;
+        chip8_exec(&vm, INSTR_XKK(0xf, V1, 0x3a));
+        assert(vm.pitch == 0x70);
+    }
+
+    {
+        /* Sound timer tone into a WAV file */
+
+        audio_sink *sink = NULL;
+        rc = audio_sink_wav_new("pchip-test.wav", &sink);
+        assert(rc == AUDIO_SUCCESS);
+        audio *sound = NULL;
+        rc = audio_new(sink, &sound);
+        assert(rc == AUDIO_SUCCESS);
+
+        chip8 vm;
+        chip8_reset(&vm, key, display);
+        chip8_set_audio(&vm, sound);
+
+        vm.regs[V1] = 6;
+        chip8_exec(&vm, INSTR_XKK(0xf, V1, 0x18));
+        assert(vm.is_tone_on);
+
+        /* 10 timer ticks running SYS, the first one is right away so the
+         * tone lasts for 5 tick periods */
+        for (size_t i = 0; i < 10; i++) {
+            chip8_timers_tick(&vm);
+            while (vm.usec_to_timer_tick) {
+                chip8_cpu_tick(&vm);
+                chip8_tick(&vm);
+            }
+        }
+        assert(!vm.is_tone_on);
+        assert(audio_dropped_edges(sound) == 0);
+        audio_free(sound);
+
+        FILE *wav = fopen("pchip-test.wav", "rb");
+        assert(wav);
+        int16_t samples[AUDIO_SAMPLE_RATE / 5];
+        fseek(wav, 44, SEEK_SET);
+        size_t count = fread(samples, sizeof(samples[0]), AUDIO_SAMPLE_RATE / 5, wav);
+        fclose(wav);
+        remove("pchip-test.wav");
+
+        /* 10/60 of a second worth of samples, 5/60 of them sounding */
+        assert(count == vm.usec_elapsed * AUDIO_SAMPLE_RATE / USECONDS_PER_SECOND);
+        assert(samples[0] != 0);
+        assert(samples[AUDIO_SAMPLE_RATE / 12 - 10] != 0);
+        assert(samples[AUDIO_SAMPLE_RATE / 12 + 10] == 0);
+    }
+
+    {
+        /* Profiler counters */
+
+        profile *prof = NULL;
+        rc = profile_new(&prof);
+        assert(rc == PROFILE_SUCCESS);
+
+        chip8 vm;
+        chip8_reset(&vm, key, display);
+        chip8_set_profile(&vm, prof);
+
+        vm.I = 0x300;
+        chip8_exec(&vm, INSTR_XKK(0xf, V3, 0x55));
+        chip8_exec(&vm, INSTR_XKK(0xf, V1, 0x65));
+        chip8_exec(&vm, INSTR_XY_N(0xd, V0, V1, 5));
+
+        assert(prof->instructions == 3);
+        assert(prof->pc_hits[PROGRAM_START_BYTES] == 1);
+        assert(prof->pc_hits[PROGRAM_START_BYTES + 4] == 1);
+        assert(prof->class_hits[DISASM_LD_MEM] == 1);
+        assert(prof->class_hits[DISASM_DRW] == 1);
+        assert(prof->drw_calls == 1 && prof->drw_bytes == 5);
+        assert(prof->ram_writes[0x303] == 1 && prof->ram_writes[0x304] == 0);
+        assert(prof->ram_reads[0x300] == 2 && prof->ram_reads[0x304] == 1);
+
+        char text[DISASM_MAX_SIZE];
+        disasm_format(INSTR_XY_N(0xd, V0, V1, 5), CHIP8_MODE_CHIP8, text, sizeof(text));
+        assert(strcmp(text, "DRW V0, V1, 5") == 0);
+
+        profile_free(prof);
+    }
+
+    {
+        /* Frame scheduler, fixed timing */
+
+        chip8 vm;
+        chip8_reset(&vm, key, display);
+
+        /* loop: ADD V0, 1; JP loop */
+        vm.ram[0x200] = 0x70; vm.ram[0x201] = 0x01;
+        vm.ram[0x202] = 0x12; vm.ram[0x203] = 0x00;
+
+        /* 16666us frame, 2000us per instruction: 9 instructions, the last
+         * one overruns into the next frame */
+        chip8_run_frame(&vm);
+        assert(vm.regs[V0] == 5);
+        assert(vm.PC == 0x202);
+        assert(vm.cycles_left == USECONDS_PER_STEP_TIMER - 9 * USECONDS_PER_STEP_CPU);
+        assert(vm.usec_elapsed == USECONDS_PER_STEP_TIMER);
+    }
+
+    {
+        /* Frame scheduler, VIP timing with display wait */
+
+        chip8 vm;
+        chip8_reset(&vm, key, display);
+        chip8_set_timing(&vm, CHIP8_TIMING_VIP);
+
+        /* loop: DRW V0, V0, 1; JP loop */
+        vm.ram[0x200] = 0xd0; vm.ram[0x201] = 0x01;
+        vm.ram[0x202] = 0x12; vm.ram[0x203] = 0x00;
+
+        chip8_run_frame(&vm);
+        assert(vm.PC == 0x202);
+        assert(vm.cycles_left == 0);
+
+        chip8_run_frame(&vm);
+        assert(vm.PC == 0x202);
+
+        /* an unaligned sprite costs more than an aligned one */
+        vm.regs[V0] = 0;
+        uint32_t aligned = vip_timing_cycles(&vm, INSTR_XY_N(0xd, V0, V0, 5));
+        vm.regs[V0] = 3;
+        uint32_t unaligned = vip_timing_cycles(&vm, INSTR_XY_N(0xd, V0, V0, 5));
+        assert(aligned < unaligned);
+    }
+
+    {
+        /* Quirk-specialized interpreters */
+
+        chip8 vm;
+        chip8_reset(&vm, key, display);
+        assert(vm.quirks == 0);
+
+        chip8_set_quirks(&vm, CHIP8_QUIRK_SHIFT_VY | CHIP8_QUIRK_VF_RESET);
+        vm.regs[V1] = 0x01;
+        vm.regs[V2] = 0x03;
+        chip8_exec(&vm, INSTR_XY_N(0x8, V1, V2, 0x6));
+        assert(vm.regs[V1] == 0x01);
+        assert(vm.regs[Vf] == 1);
+        chip8_exec(&vm, INSTR_XY_N(0x8, V1, V2, 0x1));
+        assert(vm.regs[V1] == 0x03);
+        assert(vm.regs[Vf] == 0);
+
+        chip8_set_quirks(&vm, CHIP8_QUIRK_MEMORY_INCREMENT_I | CHIP8_QUIRK_JUMP_VX);
+        vm.I = 0x300;
+        chip8_exec(&vm, INSTR_XKK(0xf, V2, 0x55));
+        assert(vm.I == 0x303);
+        vm.regs[V3] = 0x10;
+        chip8_exec(&vm, INSTR_NNN(0xb, 0x320));
+        assert(vm.PC == 0x330);
+
+        /* bottom right corner sprite: clipped with the quirk, wraps without */
+        chip8_set_quirks(&vm, CHIP8_QUIRK_CLIP);
+        chip8_exec(&vm, INSTR_NNN(0x0, 0x00e0));
+        vm.I = 0x400;
+        vm.ram[0x400] = 0xff;
+        vm.ram[0x401] = 0xff;
+        vm.regs[V0] = 60;
+        vm.regs[V1] = 31;
+        chip8_exec(&vm, INSTR_XY_N(0xd, V0, V1, 2));
+        assert(display->fb[0][31] == 0xf);
+        assert(display->fb[0][0] == 0);
+
+        chip8_set_quirks(&vm, 0);
+        chip8_exec(&vm, INSTR_XY_N(0xd, V0, V1, 2));
+        assert(display->fb[0][31] == 0xf000000000000000);
+        assert(display->fb[0][0] == 0xf00000000000000f);
+        assert(vm.regs[Vf] == 1);
+    }
+
+    {
+        /* VIP two-page hires */
+
+        chip8 vm;
+        chip8_reset(&vm, key, display);
+        assert(display->height == FRAMEBUF_LORES_HEIGHT);
+
+        /* only the jump at the start switches */
+        vm.PC = 0x202;
+        chip8_exec(&vm, HIRES_ENTRY_INSTRUCTION);
+        assert(vm.PC == 0x260 && display->height == FRAMEBUF_LORES_HEIGHT);
+
+        vm.PC = PROGRAM_START_BYTES;
+        chip8_exec(&vm, HIRES_ENTRY_INSTRUCTION);
+        assert(vm.PC == HIRES_START_BYTES && display->height == FRAMEBUF_HIRES_HEIGHT);
+
+        /* rows past 32 are there, wrapping is at 64 */
+        vm.I = 0x400;
+        vm.ram[0x400] = 0xff;
+        vm.ram[0x401] = 0xff;
+        vm.regs[V0] = 0;
+        vm.regs[V1] = 40;
+        chip8_exec(&vm, INSTR_XY_N(0xd, V0, V1, 1));
+        assert(display->fb[0][40] == 0xff00000000000000);
+        assert(display->fb[0][8] == 0);
+        vm.regs[V1] = 63;
+        chip8_exec(&vm, INSTR_XY_N(0xd, V0, V1, 2));
+        assert(display->fb[0][63] == 0xff00000000000000);
+        assert(display->fb[0][0] == 0xff00000000000000);
+
+        chip8_exec(&vm, HIRES_CLS_INSTRUCTION);
+        assert(display->fb[0][40] == 0 && display->fb[0][63] == 0);
+        assert(fb_frame_hash(display) != 0);
+
+        /* back to 64x32 on reset */
+        chip8_reset(&vm, key, display);
+        assert(display->height == FRAMEBUF_LORES_HEIGHT && fb_frame_hash(display) == 0);
+    }
+
+    {
+        /* Guarded memory: fast mode masks, checked mode faults */
+
+        chip8 vm;
+        chip8_reset(&vm, key, display);
+
+        /* 17 nested calls wrap around */
+        for (int i = 0; i < MAX_STACK_DEPTH + 1; i++)
+            assert(chip8_exec(&vm, INSTR_NNN(0x2, 0x300)) == CHIP8_SUCCESS);
+        assert(vm.SP == 1);
+        vm.SP = 0;
+        assert(chip8_exec(&vm, INSTR_NNN(0x0, 0x0ee)) == CHIP8_SUCCESS);
+        assert(vm.SP == STACK_INDEX_MASK);
+
+        chip8_reset(&vm, key, display);
+        chip8_set_checked(&vm, true);
+        assert(chip8_exec(&vm, INSTR_NNN(0x0, 0x0ee)) == CHIP8_FAULT);
+        assert(vm.fault.kind == CHIP8_FAULT_STACK_UNDERFLOW);
+        assert(vm.fault.pc == 0x200);
+
+        /* CALL 0x200 until the stack is full, the next one faults */
+        for (int i = 0; i < MAX_STACK_DEPTH; i++)
+            assert(chip8_exec(&vm, INSTR_NNN(0x2, 0x200)) == CHIP8_SUCCESS);
+        assert(vm.SP == MAX_STACK_DEPTH && vm.stack[0] == 0x202);
+        assert(chip8_exec(&vm, INSTR_NNN(0x2, 0x200)) == CHIP8_FAULT);
+        assert(vm.fault.kind == CHIP8_FAULT_STACK_OVERFLOW);
+        assert(vm.PC == 0x200 && vm.stack[0] == 0x202);
+        assert(chip8_exec(&vm, INSTR_NNN(0x0, 0x0ee)) == CHIP8_SUCCESS);
+        assert(vm.SP == MAX_STACK_DEPTH - 1);
+        vm.PC = 0x200;
+
+        /* SKP V0 with V0 = 0xFF is key F unchecked, a fault checked */
+        vm.regs[V0] = 0xFF;
+        assert(chip8_exec(&vm, INSTR_XKK(0xe, V0, 0x9e)) == CHIP8_FAULT);
+        assert(vm.fault.kind == CHIP8_FAULT_KEY && vm.fault.address == 0xFF);
+        chip8_set_checked(&vm, false);
+        assert(chip8_exec(&vm, INSTR_XKK(0xe, V0, 0x9e)) == CHIP8_SUCCESS);
+        assert(vm.PC == 0x202);
+        chip8_set_checked(&vm, true);
+        vm.PC = 0x200;
+
+        /* LD [I], V3 over the end of the 4K */
+        vm.I = MEMORY_SIZE_BYTES - 2;
+        assert(chip8_exec(&vm, INSTR_XKK(0xf, V3, 0x55)) == CHIP8_FAULT);
+        assert(vm.fault.kind == CHIP8_FAULT_RAM);
+        assert(vm.fault.instruction == INSTR_XKK(0xf, V3, 0x55));
+        assert(vm.fault.address == MEMORY_SIZE_BYTES - 2);
+
+        /* fine in XO-CHIP mode's 64K */
+        chip8_set_mode(&vm, CHIP8_MODE_XOCHIP);
+        assert(chip8_exec(&vm, INSTR_XKK(0xf, V3, 0x55)) == CHIP8_SUCCESS);
+
+        /* XO-CHIP accesses over the end of the 64K */
+        vm.I = XOCHIP_MEMORY_SIZE_BYTES - 2;
+        assert(chip8_exec(&vm, INSTR_XY_N(0x5, V0, V3, 0x2)) == CHIP8_FAULT);
+        assert(vm.fault.kind == CHIP8_FAULT_RAM && vm.fault.address == XOCHIP_MEMORY_SIZE_BYTES - 2);
+        assert(chip8_exec(&vm, INSTR_XY_N(0x5, V0, V3, 0x3)) == CHIP8_FAULT);
+        assert(chip8_exec(&vm, 0xF002) == CHIP8_FAULT);
+        vm.PC = XOCHIP_MEMORY_SIZE_BYTES - 2;
+        assert(chip8_exec(&vm, 0xF000) == CHIP8_FAULT);
+        assert(vm.fault.address == XOCHIP_MEMORY_SIZE_BYTES);
+        vm.I = MEMORY_SIZE_BYTES - 2;
+        vm.PC = 0x200;
+
+        /* a fault ends the frame */
+        chip8_set_mode(&vm, CHIP8_MODE_CHIP8);
+        vm.PC = 0x200;
+        vm.SP = 0;
+        vm.ram[0x200] = 0x00; vm.ram[0x201] = 0xee;
+        assert(chip8_run_frame(&vm) == CHIP8_FAULT);
+        assert(vm.PC == 0x200);
+    }
+
+    {
+        /* Recompiled code runtime */
+
+        chip8 vm;
+        chip8_reset(&vm, key, display);
+        memcpy(&vm.ram[0x200], aot_test_rom, sizeof(aot_test_rom));
+        assert(aot_matches(&aot_test_program, &vm.ram[0x200], sizeof(aot_test_rom)));
+
+        aot *rt = NULL;
+        assert(aot_new(&aot_test_program, &rt) == AOT_SUCCESS);
+
+        /* same state as the interpreter frame above */
+        aot_run_frame(&vm, rt);
+        assert(vm.regs[V0] == 5);
+        assert(vm.PC == 0x202);
+        assert(vm.cycles_left == USECONDS_PER_STEP_TIMER - 9 * USECONDS_PER_STEP_CPU);
+        assert(vm.usec_elapsed == USECONDS_PER_STEP_TIMER);
+
+        /* LD [I], V0 over the block drops it */
+        vm.ram[0x204] = 0xf0; vm.ram[0x205] = 0x55;
+        vm.PC = 0x204;
+        vm.I = 0x202;
+        vm.cycles_left = USECONDS_PER_STEP_TIMER;
+        assert(!aot_step(&vm, rt, 0x206));
+        assert(aot_valid_blocks(rt) == 0);
+
+        aot_free(rt);
+    }
+
+    {
+        /* ROM database and packs */
+
+        const char *db_path = "pchip-test.db";
+        const char *pack_path = "pchip-test.pack";
+        const uint8_t rom_a[] = {0x12, 0x00};
+        const uint8_t rom_b[] = {0x60, 0x01, 0x12, 0x02};
+        uint64_t hash_b = romdb_hash(rom_b, sizeof(rom_b));
+        assert(romdb_hash(rom_a, sizeof(rom_a)) != hash_b);
+
+        FILE *out = fopen(db_path, "w");
+        assert(out);
+        fprintf(out, "# comment\n\n%.16llx mode=xochip speed=1000 quirks=0x5 # rom b\n",
+                (unsigned long long)hash_b);
+        fclose(out);
+
+        romdb *db = NULL;
+        assert(romdb_load(db_path, &db) == ROMDB_SUCCESS);
+        romdb_settings settings;
+        assert(!romdb_lookup(db, romdb_hash(rom_a, sizeof(rom_a)), &settings));
+        assert(romdb_lookup(db, hash_b, &settings));
+        assert(settings.mode == CHIP8_MODE_XOCHIP);
+        assert(settings.timing == CHIP8_TIMING_FIXED);
+        assert(settings.speed == 1000);
+        assert(settings.quirks == 0x5);
+        romdb_free(db);
+
+        romdb_pack_input inputs[] = {
+            { "b", rom_b, sizeof(rom_b), settings },
+            { "a", rom_a, sizeof(rom_a), settings },
+            { "b copy", rom_b, sizeof(rom_b), settings },
+        };
+        assert(romdb_pack_write(pack_path, inputs, 3) == ROMDB_SUCCESS);
+
+        romdb_pack *pack = NULL;
+        assert(romdb_pack_open(pack_path, &pack) == ROMDB_SUCCESS);
+        assert(romdb_pack_count(pack) == 2);
+        const romdb_pack_entry *entry = romdb_pack_find(pack, hash_b);
+        assert(entry);
+        assert(entry->size == sizeof(rom_b));
+        assert(entry->offset % ROMDB_PACK_ALIGN == 0);
+        assert(memcmp(romdb_pack_rom(pack, entry), rom_b, sizeof(rom_b)) == 0);
+        assert(strcmp(romdb_pack_name(pack, entry), "b") == 0);
+        assert(entry->settings.speed == 1000);
+        assert(!romdb_pack_find(pack, hash_b + 1));
+
+        chip8 vm;
+        chip8_reset(&vm, key, display);
+        romdb_settings_apply(&entry->settings, &vm);
+        assert(vm.mode == CHIP8_MODE_XOCHIP);
+        assert(vm.usec_per_cpu_step == USECONDS_PER_SECOND / 1000);
+        romdb_pack_close(pack);
+
+        /* Settings a text database would refuse fail the whole pack */
+        inputs[1].settings.quirks = ~CHIP8_QUIRK_MASK;
+        assert(romdb_pack_write(pack_path, inputs, 2) == ROMDB_SUCCESS);
+        assert(romdb_pack_open(pack_path, &pack) == ROMDB_FAIL);
+        assert(!pack);
+
+        inputs[1].settings = settings;
+        inputs[1].settings.speed = FREQUENCY_TIMER - 1;
+        assert(romdb_pack_write(pack_path, inputs, 2) == ROMDB_SUCCESS);
+        assert(romdb_pack_open(pack_path, &pack) == ROMDB_FAIL);
+
+        unlink(db_path);
+        unlink(pack_path);
+    }
+
+    {
+        /* Library instances */
+
+        pchip_config config;
+        pchip_config_default(&config);
+
+        pchip *a = NULL, *b = NULL;
+        assert(pchip_new(&config, &a) == PCHIP_SUCCESS);
+        assert(pchip_new(&config, &b) == PCHIP_SUCCESS);
+
+        /* RND V0, 0xFF; SKP V1; JP 0x200; JP 0x206 */
+        const uint8_t rom[] = {0xc0, 0xff, 0xe1, 0x9e, 0x12, 0x00, 0x12, 0x06};
+        assert(pchip_load(a, rom, sizeof(rom)) == PCHIP_SUCCESS);
+        assert(pchip_load(b, rom, sizeof(rom)) == PCHIP_SUCCESS);
+
+        /* Same seed, same numbers, keys are per instance */
+        assert(pchip_run(a, 3) == CHIP8_SUCCESS);
+        assert(pchip_run(b, 3) == CHIP8_SUCCESS);
+        assert(pchip_machine(a)->regs[V0] == pchip_machine(b)->regs[V0]);
+
+        pchip_set_keys(a, 1u << 0);
+        assert(pchip_run_frame(a) == CHIP8_HALT);
+        assert(pchip_machine(a)->PC == 0x206);
+        assert(pchip_machine(a)->cycles_left <= 0);
+        assert(pchip_run_frame(b) == CHIP8_SUCCESS);
+
+        /* Single steps, an illegal instruction in fast mode too */
+        const uint8_t bad_rom[] = {0x60, 0x07, 0xf0, 0xff};
+        assert(pchip_load(b, bad_rom, sizeof(bad_rom)) == PCHIP_SUCCESS);
+        assert(pchip_step(b) == CHIP8_SUCCESS);
+        assert(pchip_step(b) == CHIP8_FAULT);
+        assert(pchip_machine(b)->fault.kind == CHIP8_FAULT_ILLEGAL_INSTRUCTION);
+        assert(pchip_machine(b)->PC == 0x202);
+        assert(pchip_run(b, 10) == CHIP8_FAULT);
+
+        uint8_t big_rom[MAX_ROM_SIZE_BYTES + 1] = {0};
+        assert(pchip_load(b, big_rom, sizeof(big_rom)) == PCHIP_FAIL);
+
+        assert(pchip_display(a)->planes == 0x1);
+
+        /* Loading blanks every plane */
+        const uint8_t sprite[] = {0xFF};
+        fb_select_planes(pchip_machine(a)->display, 0x2);
+        fb_draw_sprite(pchip_machine(a)->display, (uint8_t *)sprite, 1, 0, 0, &(bool){false});
+        assert(pchip_display(a)->fb[1][0] != 0);
+        assert(pchip_load(a, rom, sizeof(rom)) == PCHIP_SUCCESS);
+        assert(pchip_display(a)->fb[1][0] == 0 && fb_frame_hash(pchip_display(a)) == 0);
+
+        pchip_free(a);
+        pchip_free(b);
+    }
+
+    {
+        /* Instance pools */
+        pchip_config config;
+        pchip_config_default(&config);
+
+        /* LD I, 0x300; LD V0, 7; LD B, V0; JP 0x206 */
+        const uint8_t rom[] = {0xA3, 0x00, 0x60, 0x07, 0xF0, 0x33, 0x12, 0x06};
+        pchip_pool *pool = NULL;
+        assert(pchip_pool_new(&config, rom, sizeof(rom), 3, &pool) == PCHIP_SUCCESS);
+        assert(pchip_pool_count(pool) == 3);
+        size_t idle_bytes = pchip_pool_bytes(pool);
+
+        /* Shared until written */
+        chip8 *first = pchip_machine(pchip_pool_get(pool, 0));
+        chip8 *second = pchip_machine(pchip_pool_get(pool, 1));
+        assert(first->ram == second->ram && chip8_is_ram_shared(first));
+        assert(pchip_step(pchip_pool_get(pool, 0)) == CHIP8_SUCCESS);
+        assert(pchip_step(pchip_pool_get(pool, 0)) == CHIP8_SUCCESS);
+        assert(chip8_is_ram_shared(first));
+
+        assert(pchip_step(pchip_pool_get(pool, 0)) == CHIP8_SUCCESS);
+        assert(!chip8_is_ram_shared(first) && chip8_is_ram_shared(second));
+        assert(first->ram[0x302] == 7 && second->ram[0x302] == 0);
+        assert(first->ram[0x200] == 0xA3 && first->ram[0x00] == 0xF0);
+        assert(pchip_pool_bytes(pool) == idle_bytes + CHIP8_IMAGE_BYTES(CHIP8_MODE_CHIP8));
+
+        /* Loading an unwritten state goes back to the image */
+        uint8_t state[CHIP8_COMPACT_BYTES + sizeof(fb_console) + MEMORY_SIZE_BYTES];
+        assert(chip8_state_size(second) == sizeof(state));
+        chip8_save_state(second, state);
+        assert(chip8_load_state(first, state) == CHIP8_SUCCESS);
+        assert(chip8_is_ram_shared(first) && first->PC == 0x200);
+        assert(pchip_pool_bytes(pool) == idle_bytes);
+
+        /* Unchecked accesses wrap around within the 4K */
+        assert(pchip_run(pchip_pool_get(pool, 2), 1) == CHIP8_HALT);
+        first->I = 0xFFF;
+        first->regs[V0] = 7;
+        chip8_exec(first, 0xF033);
+        assert(first->ram[0xFFF] == 0 && first->ram[0x000] == 0 && first->ram[0x001] == 7);
+
+        /* A shorter ROM leaves nothing of the pool's one */
+        const uint8_t short_rom[] = {0x12, 0x00};
+        assert(pchip_load(pchip_pool_get(pool, 1), short_rom, sizeof(short_rom)) == PCHIP_SUCCESS);
+        assert(!chip8_is_ram_shared(second) && second->ram[0x200] == 0x12);
+        assert(second->ram[0x202] == 0 && second->ram[0x207] == 0 && second->ram[0x00] == 0xF0);
+        assert(pchip_machine(pchip_pool_get(pool, 2))->ram[0x202] == 0x60);
+
+        pchip_free(pchip_pool_get(pool, 0));
+        pchip_pool_free(pool);
+    }
+
+    {
+        /* Batched environments */
+        batch_env_config config;
+        batch_env_config_default(&config);
+        config.threads = 4;
+        config.machine.settings.speed = 1000;
+        config.max_episode_frames = 4;
+        config.rewards[0] = (batch_env_reward){ .address = 0x300, .bytes = 1, .scale = 0.5f };
+        config.reward_count = 1;
+
+        /* Key 0 faults, a counter at 0x300 goes up a frame at a time */
+        const uint8_t rom[] = {
+            0xE2, 0xA1, 0xF0, 0xFF,                         /* SKNP V2; illegal */
+            0xA3, 0x00, 0xF0, 0x65, 0x70, 0x01, 0xF0, 0x55, /* LD I, 0x300; V0 += 1 there */
+            0x61, 0x01, 0xF1, 0x15,                         /* LD DT, 1 */
+            0xF1, 0x07, 0x31, 0x00, 0x12, 0x10, 0x12, 0x00, /* Wait for DT, JP 0x200 */
+        };
+        enum { COUNT = 100 };
+        static uint16_t keys[COUNT];
+        static uint8_t frames[COUNT * BATCH_ENV_FRAME_BYTES];
+        float rewards[COUNT];
+        uint8_t dones[COUNT];
+
+        batch_env *env = NULL;
+        assert(batch_env_new(&config, rom, sizeof(rom), COUNT, &env) == BATCH_ENV_SUCCESS);
+        assert(batch_env_count(env) == COUNT);
+        const uint8_t *ram_7 = pchip_machine(batch_env_get(env, 7))->ram;
+        assert(!chip8_is_ram_shared(pchip_machine(batch_env_get(env, 7))));
+
+        memset(frames, 0xFF, sizeof(frames));
+        assert(batch_env_step(env, keys, frames, rewards, dones) == BATCH_ENV_SUCCESS);
+        assert(rewards[0] == 0.5f && rewards[COUNT - 1] == 0.5f && !dones[0] && !dones[COUNT - 1]);
+        assert(frames[0] == 0 && frames[sizeof(frames) - 1] == 0);
+
+        /* A fault ends the episode, the next one starts right away */
+        keys[7] = 1u << 0;
+        assert(batch_env_step(env, keys, NULL, rewards, dones) == BATCH_ENV_SUCCESS);
+        assert(dones[7] && rewards[7] == 0.0f && !dones[6]);
+        /* In the same private copy, nothing allocated */
+        chip8 *vm = pchip_machine(batch_env_get(env, 7));
+        assert(vm->PC == 0x200 && vm->ram[0x300] == 0 && vm->ram == ram_7);
+        keys[7] = 0;
+
+        /* Episodes are cut at 4 frames */
+        assert(batch_env_step(env, keys, NULL, rewards, dones) == BATCH_ENV_SUCCESS);
+        assert(!dones[0] && pchip_machine(batch_env_get(env, 0))->ram[0x300] == 3);
+        assert(batch_env_step(env, keys, NULL, rewards, dones) == BATCH_ENV_SUCCESS);
+        assert(dones[0] && dones[COUNT - 1] && !dones[7]);
+        assert(pchip_machine(batch_env_get(env, 0))->ram[0x300] == 0);
+
+        /* Episodes start where environment 7 is now */
+        assert(batch_env_set_initial(env, 7) == BATCH_ENV_SUCCESS);
+        assert(batch_env_reset(env, frames) == BATCH_ENV_SUCCESS);
+        assert(pchip_machine(batch_env_get(env, 0))->ram[0x300] == 2);
+        assert(batch_env_step(env, keys, NULL, rewards, dones) == BATCH_ENV_SUCCESS);
+        assert(rewards[0] == 0.5f && pchip_machine(batch_env_get(env, 0))->ram[0x300] == 3);
+
+        batch_env_free(env);
+
+        /* Reward terms have to be within memory */
+        config.rewards[0].address = MEMORY_SIZE_BYTES - 1;
+        config.rewards[0].bytes = 2;
+        assert(batch_env_new(&config, rom, sizeof(rom), COUNT, &env) == BATCH_ENV_FAIL);
+    }
+
+    {
+        /* Framebuffer hashes and dirty rows */
+
+        fb_console *fb = NULL;
+        assert(fb_new_headless(&fb) == FB_CONSOLE_SUCCESS);
+        assert(fb_frame_hash(fb) == 0);
+
+        uint8_t sprite[] = {0xf0, 0x90};
+        fb_draw_sprite(fb, sprite, sizeof(sprite), 4, 31, &(bool){0});
+        uint64_t drawn = fb_frame_hash(fb);
+        assert(drawn != 0);
+        /* wrapped around to the top */
+        assert(fb_take_dirty_rows(fb) == ((fb_row_mask)1 << 31 | 0x1));
+        assert(fb_take_dirty_rows(fb) == 0);
+
+        /* the same sprite a row lower is a different frame */
+        fb_draw_sprite(fb, sprite, sizeof(sprite), 4, 31, &(bool){0});
+        assert(fb_frame_hash(fb) == 0);
+        fb_draw_sprite(fb, sprite, sizeof(sprite), 4, 0, &(bool){0});
+        assert(fb_frame_hash(fb) != drawn && fb_frame_hash(fb) != 0);
+        fb_take_dirty_rows(fb);
+
+        /* an empty sprite row touches nothing */
+        uint8_t blank[] = {0x00};
+        fb_draw_sprite(fb, blank, sizeof(blank), 0, 7, &(bool){0});
+        assert(fb_take_dirty_rows(fb) == 0);
+
+        /* the second plane counts */
+        fb_select_planes(fb, 0x2);
+        fb_draw_sprite(fb, sprite, sizeof(sprite), 4, 0, &(bool){0});
+        assert(fb_take_dirty_rows(fb) == 0x3);
+        fb_select_planes(fb, 0x3);
+        fb_clear(fb);
+        assert(fb_frame_hash(fb) == 0);
+        assert(fb_take_dirty_rows(fb) == 0x3);
+
+        /* loading a saved copy dirties the rows that differ */
+        fb_console saved = *fb;
+        fb_select_planes(fb, 0x1);
+        fb_draw_sprite(fb, sprite, sizeof(sprite), 4, 10, &(bool){0});
+        fb_take_dirty_rows(fb);
+        fb_load(fb, &saved);
+        assert(fb_frame_hash(fb) == 0);
+        assert(fb_take_dirty_rows(fb) == (0x3 << 10));
+
+        fb_free(fb);
+    }
+
+    {
+        /* Terminal backpressure */
+
+        int pipe_fds[2];
+        assert(pipe(pipe_fds) == 0);
+        fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK);
+        fflush(stdout);
+        int orig_stdout = dup(fileno(stdout));
+        dup2(pipe_fds[1], fileno(stdout));
+
+        fb_console *fb = NULL;
+        assert(fb_new(&fb) == FB_CONSOLE_SUCCESS);
+        bool keys[CHIP8_KEY_COUNT] = {0};
+        uint8_t sprite[] = {0x80};
+        fb_output_counters counters;
+
+        /* nobody reading fills the pipe up */
+        for (int i = 0; i < 1000; i++) {
+            fb_draw_sprite(fb, sprite, sizeof(sprite), i, 0, &(bool){0});
+            fb_redraw(fb, keys);
+            fb_get_output_counters(fb, &counters);
+            if (counters.writes_blocked)
+                break;
+        }
+        assert(counters.writes_blocked == 1 && counters.frames_dropped == 0);
+        /* stdout itself, shared with stderr, still blocks */
+        assert(!(fcntl(fileno(stdout), F_GETFL) & O_NONBLOCK));
+
+        /* frames waiting for the terminal replace one another */
+        fb_draw_sprite(fb, sprite, sizeof(sprite), 0, 1, &(bool){0});
+        assert(!fb_redraw(fb, keys));
+        fb_set_status(fb, "latest");
+        fb_draw_sprite(fb, sprite, sizeof(sprite), 0, 2, &(bool){0});
+        assert(!fb_redraw(fb, keys));
+        fb_get_output_counters(fb, &counters);
+        assert(counters.frames_dropped == 1);
+
+        /* the rest of the blocked frame and the latest one go out */
+        char buf[4096];
+        while (read(pipe_fds[0], buf, sizeof(buf)) > 0)
+            ;
+        uint64_t frames_written = counters.frames_written;
+        assert(fb_redraw(fb, keys));
+        fb_get_output_counters(fb, &counters);
+        assert(counters.frames_written == frames_written + 2);
+        char out[2 * sizeof(buf)];
+        size_t out_bytes = 0;
+        for (ssize_t n; (n = read(pipe_fds[0], out + out_bytes, sizeof(out) - out_bytes)) > 0;)
+            out_bytes += n;
+        assert(out_bytes > 7 && memcmp(out + out_bytes - 7, "latest\n", 7) == 0);
+
+        fb_free(fb);
+        dup2(orig_stdout, fileno(stdout));
+        close(orig_stdout);
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+    }
+
+    {
+        /* Frame streaming */
+
+        uint8_t prev[STREAM_FRAME_BYTES] = {0}, cur[STREAM_FRAME_BYTES] = {0};
+        uint8_t payload[STREAM_MAX_PAYLOAD];
+        assert(delta_encode(prev, cur, sizeof(cur), payload) == 0);
+
+        /* worst case fits */
+        for (size_t i = 0; i < sizeof(cur); i += 2)
+            cur[i] = 0xff;
+        size_t payload_bytes = delta_encode(prev, cur, sizeof(cur), payload);
+        assert(payload_bytes <= STREAM_MAX_PAYLOAD);
+        assert(delta_apply(prev, sizeof(prev), payload, payload_bytes) == DELTA_SUCCESS);
+        assert(memcmp(prev, cur, sizeof(cur)) == 0);
+        assert(delta_apply(prev, sizeof(prev), payload, payload_bytes - 1) == DELTA_FAIL);
+
+        const char *socket_path = "pchip-test.sock";
+        stream *srv = NULL;
+        assert(stream_new(socket_path, &srv) == STREAM_SUCCESS);
+
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        struct sockaddr_un addr = { .sun_family = AF_UNIX };
+        strcpy(addr.sun_path, socket_path);
+        assert(connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+
+        fb_console *fb = NULL;
+        assert(fb_new_headless(&fb) == FB_CONSOLE_SUCCESS);
+        uint8_t sprite[] = {0xf0, 0x90};
+        fb_draw_sprite(fb, sprite, sizeof(sprite), 4, 2, &(bool){0});
+
+        /* keyframe for a new subscriber */
+        stream_publish(srv, fb);
+        assert(stream_client_count(srv) == 1);
+        uint8_t frame[STREAM_FRAME_BYTES] = {0};
+        stream_header header;
+        assert(read(fd, &header, sizeof(header)) == sizeof(header));
+        assert(header.magic == STREAM_MAGIC && header.type == STREAM_FRAME_KEY);
+        assert(read(fd, payload, header.payload_bytes) == header.payload_bytes);
+        assert(delta_apply(frame, sizeof(frame), payload, header.payload_bytes) == DELTA_SUCCESS);
+        stream_pack_frame(fb, cur);
+        assert(memcmp(frame, cur, sizeof(cur)) == 0);
+
+        /* nothing for an unchanged frame, a delta otherwise */
+        stream_publish(srv, fb);
+        fb_draw_sprite(fb, sprite, sizeof(sprite), 60, 30, &(bool){0});
+        stream_publish(srv, fb);
+        assert(read(fd, &header, sizeof(header)) == sizeof(header));
+        assert(header.type == STREAM_FRAME_DELTA && header.frame == 2);
+        assert(read(fd, payload, header.payload_bytes) == header.payload_bytes);
+        assert(delta_apply(frame, sizeof(frame), payload, header.payload_bytes) == DELTA_SUCCESS);
+        stream_pack_frame(fb, cur);
+        assert(memcmp(frame, cur, sizeof(cur)) == 0);
+
+        /* a subscriber that doesn't read never blocks publishing */
+        for (int i = 0; i < 10000; i++) {
+            fb_clear(fb);
+            fb_draw_sprite(fb, sprite, sizeof(sprite), i % 64, i % 32, &(bool){0});
+            stream_publish(srv, fb);
+        }
+        assert(stream_skipped_frames(srv) > 0);
+
+        close(fd);
+        fb_free(fb);
+        stream_free(srv);
+        assert(access(socket_path, F_OK) == -1);
+    }
+
+    {
+        /* Shared memory export */
+
+        const char *shm_name = "/pchip-test";
+        shm_export *ex = NULL;
+        assert(shm_export_new(shm_name, &ex) == SHM_EXPORT_SUCCESS);
+
+        const shm_export_region *region = shm_export_map(shm_name);
+        assert(region);
+        assert(region->width == FRAMEBUF_WIDTH && region->height == FRAMEBUF_MAX_HEIGHT);
+
+        fb_console *fb = NULL;
+        assert(fb_new_headless(&fb) == FB_CONSOLE_SUCCESS);
+        uint8_t sprite[] = {0x81};
+        fb_draw_sprite(fb, sprite, sizeof(sprite), 0, 5, &(bool){0});
+
+        bool keys[CHIP8_KEY_COUNT] = {0};
+        keys[CHIP8_KEY_A] = true;
+        shm_export_publish(ex, fb, keys);
+
+        shm_export_frame frame;
+        assert(shm_export_read(region, &frame));
+        assert(frame.frame == 1);
+        assert(frame.keys == 1u << CHIP8_KEY_A);
+        assert(frame.rows == FRAMEBUF_LORES_HEIGHT);
+        assert(frame.fb[0][5] == (fb_row)0x81 << 56);
+
+        /* caught in the middle of a write */
+        shm_export_region busy;
+        memcpy(&busy, region, sizeof(busy));
+        atomic_store(&busy.seq, 3);
+        assert(!shm_export_read(&busy, &frame));
+
+        fb_free(fb);
+        shm_export_unmap(region);
+        shm_export_free(ex);
+        assert(!shm_export_map(shm_name));
+    }
+
+    {
+        /* Debugger */
+
+        debugger *dbg = NULL;
+        assert(debugger_new(0, &dbg) == DEBUGGER_SUCCESS);
+        assert(debugger_port(dbg) != 0);
+
+        chip8 vm;
+        chip8_reset(&vm, key, display);
+        /* 0x200: ADD V0, 1; LD [I], V0; JP 0x200 */
+        const uint8_t rom[] = {0x70, 0x01, 0xf0, 0x55, 0x12, 0x00};
+        memcpy(&vm.ram[0x200], rom, sizeof(rom));
+        vm.I = 0x300;
+
+        /* breakpoints stop the frame halfway, continuing goes past them */
+        debugger_set_breakpoint(dbg, 0x202, true);
+        assert(debugger_run_frame(dbg, &vm) == CHIP8_SUCCESS);
+        assert(debugger_is_stopped(dbg));
+        assert(vm.PC == 0x202 && vm.regs[V0] == 1);
+        assert(debugger_run_frame(dbg, &vm) == CHIP8_SUCCESS);
+        assert(vm.PC == 0x202 && vm.regs[V0] == 1);
+
+        debugger_step(dbg);
+        debugger_run_frame(dbg, &vm);
+        assert(debugger_is_stopped(dbg));
+        assert(vm.PC == 0x204 && vm.ram[0x300] == 1);
+
+        debugger_continue(dbg);
+        debugger_run_frame(dbg, &vm);
+        assert(vm.PC == 0x202 && vm.regs[V0] == 2);
+        debugger_set_breakpoint(dbg, 0x202, false);
+
+        /* a write watchpoint stops right after the write */
+        assert(debugger_set_watchpoint(dbg, 0x300, 1, DEBUGGER_WATCH_WRITE) == DEBUGGER_SUCCESS);
+        debugger_continue(dbg);
+        debugger_run_frame(dbg, &vm);
+        assert(debugger_is_stopped(dbg));
+        assert(vm.PC == 0x204 && vm.ram[0x300] == 2);
+        debugger_clear_watchpoint(dbg, 0x300, 1, DEBUGGER_WATCH_WRITE);
+
+        /* GDB protocol */
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr = {
+            .sin_family = AF_INET,
+            .sin_port = htons(debugger_port(dbg)),
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+        };
+        assert(connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+
+        const char *packets = "$g#67$m300,1#5d";
+        assert(write(fd, packets, strlen(packets)) == (ssize_t)strlen(packets));
+        usleep(10000);
+        debugger_run_frame(dbg, &vm);
+
+        char reply[256] = {0};
+        ssize_t got = read(fd, reply, sizeof(reply) - 1);
+        assert(got > 0);
+        /* V0 = 2, VF..V1 = 0, I = 0x300, PC = 0x204 */
+        assert(strstr(reply, "+$0200000000000000000000000000000000030402000000#"));
+        assert(strstr(reply, "+$02#"));
+
+        close(fd);
+        debugger_free(dbg);
+    }
+
+    {
+        /* Rewind history */
+
+        history *hist = NULL;
+        assert(history_new(HISTORY_DEFAULT_BUDGET_BYTES, 16, 4, &hist) == HISTORY_SUCCESS);
+
+        chip8 vm;
+        chip8_reset(&vm, key, display);
+        chip8_set_seed(&vm, 1);
+        /* 0x200: RND V2, 0xFF; LD F, V2; DRW V0, V1, 5; LD [I], V2; JP 0x200 */
+        const uint8_t rom[] = {0xc2, 0xff, 0xf2, 0x29, 0xd0, 0x15, 0xf2, 0x55, 0x12, 0x00};
+        memcpy(&vm.ram[0x200], rom, sizeof(rom));
+
+        static uint8_t states[20][8192];
+        size_t state_size = chip8_state_size(&vm);
+        assert(state_size <= sizeof(states[0]));
+        for (int frame = 0; frame < 20; frame++) {
+            chip8_run_frame(&vm);
+            history_capture(hist, &vm);
+            chip8_save_state(&vm, states[frame]);
+        }
+        /* the oldest keyframe groups went */
+        assert(history_frame_count(hist) <= 16 && history_frame_count(hist) > 12);
+
+        uint8_t state[8192];
+        uint64_t usec_elapsed = vm.usec_elapsed;
+        for (int frame = 18; history_step_back(hist, &vm); frame--) {
+            chip8_save_state(&vm, state);
+            /* everything but the emulated clock */
+            vm.usec_elapsed = ((chip8 *)states[frame])->usec_elapsed;
+            vm.usec_frame_start = ((chip8 *)states[frame])->usec_frame_start;
+            chip8_save_state(&vm, state);
+            assert(memcmp(state, states[frame], state_size) == 0);
+            vm.usec_elapsed = vm.usec_frame_start = usec_elapsed;
+        }
+        assert(history_frame_count(hist) == 1);
+
+        history_free(hist);
+    }
+
+    {
+        /* Fast-forward */
+
+        fast_forward ff;
+        fast_forward_init(&ff, 4, 0);
+
+        /* Off: a frame per tick, always presented */
+        fast_forward_begin_tick(&ff, 0);
+        assert(fast_forward_is_frame_due(&ff, 0, 0));
+        assert(!fast_forward_is_frame_due(&ff, 1, 0));
+        assert(fast_forward_end_tick(&ff, 1, 0));
+
+        /* On: up to speed frames within the budget */
+        ff.is_on = true;
+        assert(fast_forward_is_frame_due(&ff, 3, 100));
+        assert(!fast_forward_is_frame_due(&ff, 4, 100));
+        assert(!fast_forward_is_frame_due(&ff, 1, FAST_FORWARD_USEC_BUDGET));
+        ff.speed = FAST_FORWARD_UNLIMITED;
+        assert(fast_forward_is_frame_due(&ff, 1000, 100));
+
+        /* Slow output: frames are skipped until it is done */
+        fast_forward_presented(&ff, 0, 80000);
+        assert(ff.usec_present_cost == 10000);
+        assert(!fast_forward_end_tick(&ff, 8, 85000));
+        assert(ff.skipped_frames == 8);
+        assert(fast_forward_end_tick(&ff, 8, 90000));
+        assert(ff.skipped_frames == 15);
+
+        /* 4 frames per 60Hz tick for a second */
+        fast_forward_init(&ff, 4, 0);
+        ff.is_on = true;
+        for (uint64_t tick = 1; tick <= FREQUENCY_TIMER; tick++)
+            fast_forward_end_tick(&ff, 4, tick * USECONDS_PER_SECOND / FREQUENCY_TIMER);
+        assert(ff.effective_speed > 3.99 && ff.effective_speed < 4.01);
+    }
+
+    {
+        /* Run-ahead */
+
+        keyboard *keys = NULL;
+        assert(keyboard_new_virtual(&keys) == KEYBOARD_SUCCESS);
+        keyboard_set_key(keys, CHIP8_KEY_5, true);
+        fb_console *fb = NULL, *ref_fb = NULL;
+        assert(fb_new_headless(&fb) == FB_CONSOLE_SUCCESS);
+        assert(fb_new_headless(&ref_fb) == FB_CONSOLE_SUCCESS);
+
+        /* Count frames with 5 held and show the count:
+         * 0x200: LD V1, 5; SKNP V1; ADD V0, 1; LD F, V0; CLS; DRW V2, V2, 5;
+         * 0x20C: LD V3, 1; LD DT, V3; LD V3, DT; SE V3, 0; JP 0x210; JP 0x202 */
+        const uint8_t rom[] = {
+            0x61, 0x05, 0xe1, 0xa1, 0x70, 0x01, 0xf0, 0x29, 0x00, 0xe0, 0xd2, 0x25,
+            0x63, 0x01, 0xf3, 0x15, 0xf3, 0x07, 0x33, 0x00, 0x12, 0x10, 0x12, 0x02,
+        };
+        chip8 vm, ref;
+        chip8_reset(&vm, keys, fb);
+        chip8_reset(&ref, keys, ref_fb);
+        memcpy(&vm.ram[0x200], rom, sizeof(rom));
+        for (int frame = 0; frame < 3; frame++)
+            chip8_run_frame(&vm);
+
+        static uint8_t state[8192], before[8192], after[8192];
+        chip8_save_state(&vm, state);
+        chip8_load_state(&ref, state);
+        fb->is_dirty = false;
+        chip8_save_state(&vm, before);
+
+        run_ahead *ra = NULL;
+        assert(run_ahead_new(2, &ra) == RUN_AHEAD_SUCCESS);
+        assert(run_ahead_begin(ra, &vm) == CHIP8_SUCCESS);
+        chip8_run_frame(&ref);
+        chip8_run_frame(&ref);
+        assert(vm.regs[0] == ref.regs[0]);
+        assert(memcmp(fb->fb, ref_fb->fb, sizeof(fb->fb)) == 0);
+        assert(fb->is_dirty);
+
+        /* Presented, the machine is back where it was */
+        fb->is_dirty = false;
+        run_ahead_end(ra, &vm);
+        chip8_save_state(&vm, after);
+        assert(memcmp(before, after, chip8_state_size(&vm)) == 0);
+        assert(vm.regs[0] < ref.regs[0]);
+
+        /* Same future, nothing new to show */
+        assert(run_ahead_begin(ra, &vm) == CHIP8_SUCCESS);
+        assert(!fb->is_dirty);
+        run_ahead_end(ra, &vm);
+
+        run_ahead_free(ra);
+        fb_free(ref_fb);
+        fb_free(fb);
+        keyboard_free(keys);
+    }
+
+    {
+        /* Input latency */
+
+        latency *lat = NULL;
+        assert(latency_new(&lat) == LATENCY_SUCCESS);
+
+        /* Followed from the input through drawing to showing */
+        latency_observed(lat, 1000, 3000);
+        assert(latency_is_awaiting_draw(lat));
+        /* Another input while following one is only observed */
+        latency_observed(lat, 2000, 3500);
+        latency_drawn(lat, 11000);
+        assert(!latency_is_awaiting_draw(lat) && latency_is_awaiting_show(lat));
+        latency_drawn(lat, 12000);
+        latency_shown(lat, 21000);
+        assert(!latency_is_awaiting_show(lat));
+        assert(lat->stages[LATENCY_OBSERVED].samples == 2);
+        assert(lat->stages[LATENCY_DRAWN].samples == 1 && lat->stages[LATENCY_DRAWN].max == 10000);
+        assert(lat->stages[LATENCY_SHOWN].samples == 1 && lat->stages[LATENCY_SHOWN].max == 20000);
+
+        /* Nobody looked at the key for too long */
+        latency_observed(lat, 0, LATENCY_USEC_STALE + 1);
+        assert(lat->stages[LATENCY_OBSERVED].samples == 2 && !latency_is_awaiting_draw(lat));
+
+        /* Percentiles within a bucket, 12.5% */
+        latency_free(lat);
+        assert(latency_new(&lat) == LATENCY_SUCCESS);
+        for (uint64_t usec = 1; usec <= 1000; usec++)
+            latency_observed(lat, 0, usec);
+        uint64_t p50 = histogram_percentile(&lat->stages[LATENCY_OBSERVED], 0.50);
+        uint64_t p99 = histogram_percentile(&lat->stages[LATENCY_OBSERVED], 0.99);
+        assert(p50 >= 500 && p50 <= 500 * 9 / 8);
+        assert(p99 >= 990 && p99 <= 1000);
+        assert(histogram_percentile(&lat->stages[LATENCY_DRAWN], 0.50) == 0);
+
+        latency_free(lat);
+    }
+
+    {
+        /* Scheduling telemetry */
+
+        telemetry *tel = NULL;
+        assert(telemetry_new(0, &tel) == TELEMETRY_SUCCESS);
+
+        /* An on time tick, then one that overran by 5ms */
+        telemetry_enter(tel, TELEMETRY_INPUT, 0);
+        telemetry_enter(tel, TELEMETRY_EXECUTE, 1000);
+        telemetry_enter(tel, TELEMETRY_RENDER, 4000);
+        telemetry_tick_done(tel, 16000, 6000);
+        telemetry_enter(tel, TELEMETRY_SLEEP, 6000);
+        telemetry_wakeup(tel, 16000, 16100);
+        telemetry_enter(tel, TELEMETRY_EXECUTE, 16100);
+        telemetry_tick_done(tel, 32000, 37000);
+        telemetry_enter(tel, TELEMETRY_SLEEP, 37000);
+        telemetry_wakeup(tel, 32000, 37000);
+        telemetry_dropped(tel, 5000);
+
+        assert(tel->ticks == 2 && tel->overruns == 1 && tel->usec_overrun == 5000);
+        assert(tel->usec_dropped == 5000);
+        assert(tel->jitter.samples == 2 && tel->jitter.max == 5000);
+        assert(tel->usec_phases[TELEMETRY_INPUT] == 1000);
+        assert(tel->usec_phases[TELEMETRY_EXECUTE] == 3000 + 20900);
+        assert(tel->usec_phases[TELEMETRY_RENDER] == 2000);
+        assert(tel->usec_phases[TELEMETRY_SLEEP] == 10100);
+
+        /* The split of the last whole second */
+        telemetry_enter(tel, TELEMETRY_EXECUTE, TELEMETRY_USEC_WINDOW);
+        assert(tel->usec_last_window_phases[TELEMETRY_SLEEP] == 10100 + TELEMETRY_USEC_WINDOW - 37000);
+        assert(tel->usec_window_phases[TELEMETRY_SLEEP] == 0);
+
+        /* Nothing measured, nothing done */
+        telemetry_enter(NULL, TELEMETRY_SLEEP, 0);
+        telemetry_free(tel);
+    }
+
+    {
+        /* Lockstep differential execution */
+
+        pchip_config config;
+        pchip_config_default(&config);
+        config.settings.quirks = CHIP8_QUIRK_SHIFT_VY | CHIP8_QUIRK_VF_RESET;
+        lockstep_divergence div;
+
+        /* The specialized interpreter agrees with the generic one */
+        lockstep *ls = NULL;
+        assert(lockstep_new(&config, NULL, LOCKSTEP_INSTRUCTION, &ls) == LOCKSTEP_SUCCESS);
+        for (uint32_t seed = 1; seed <= 50; seed++) {
+            assert(lockstep_load_random(ls, seed, 128) == LOCKSTEP_SUCCESS);
+            assert(lockstep_run(ls, 10, &div) != LOCKSTEP_DIVERGED);
+        }
+        const uint8_t data[] = {0x60, 0x05, 0x80, 0x06, 0xa2, 0x00, 0xd0, 0x05, 0x12, 0x00};
+        assert(lockstep_fuzz(ls, data, sizeof(data), 5, &div) == LOCKSTEP_SUCCESS);
+        lockstep_free(ls);
+
+        /* An engine getting 8XY6 wrong is caught right there */
+        lockstep_engine broken = { .name = "broken", .exec = test_broken_exec };
+        assert(lockstep_new(&config, &broken, LOCKSTEP_INSTRUCTION, &ls) == LOCKSTEP_SUCCESS);
+        assert(lockstep_fuzz(ls, data, sizeof(data), 5, &div) == LOCKSTEP_DIVERGED);
+        assert(div.frame == 0 && div.instructions == 2);
+        assert(div.pc == 0x202 && div.instruction == 0x8006);
+        assert(strcmp(div.what, "V0") == 0 && div.reference == 0x02 && div.candidate == 0x01);
+        lockstep_free(ls);
+
+        /* Frame by frame it's only known at the end of the frame */
+        assert(lockstep_new(&config, &broken, LOCKSTEP_FRAME, &ls) == LOCKSTEP_SUCCESS);
+        assert(lockstep_fuzz(ls, data, sizeof(data), 5, &div) == LOCKSTEP_DIVERGED);
+        assert(div.frame == 0 && div.pc == 0x200);
+        lockstep_free(ls);
+    }
+
     fb_free(display);
     keyboard_free(key);
 
@@ -0,0 +1,87 @@
+#include "vip-timing.h"
+#include "disasm.h"
+
+/* Fetch and decode of every instruction */
+#define CYCLES_FETCH 40
+
+/* DRW: setup, a row of an aligned sprite, extra for every bit an unaligned
+ * row is shifted by and for writing the spilled over second byte */
+#define CYCLES_DRW_SETUP 26
+#define CYCLES_DRW_ROW 18
+#define CYCLES_DRW_SHIFT_BIT 4
+#define CYCLES_DRW_SPILL 14
+
+/* Execution cycles of the fixed cost instructions */
+static const uint16_t class_cycles[DISASM_CLASS_COUNT] = {
+    [DISASM_SYS] = 12,
+    [DISASM_CLS] = 3078,
+    [DISASM_RET] = 10,
+    [DISASM_JP] = 12,
+    [DISASM_CALL] = 26,
+    [DISASM_SE_BYTE] = 10,
+    [DISASM_SNE_BYTE] = 10,
+    [DISASM_SE_REG] = 14,
+    [DISASM_LD_BYTE] = 6,
+    [DISASM_ADD_BYTE] = 10,
+    [DISASM_LD_REG] = 12,
+    [DISASM_OR] = 20,
+    [DISASM_AND] = 20,
+    [DISASM_XOR] = 20,
+    [DISASM_ADD_REG] = 20,
+    [DISASM_SUB] = 20,
+    [DISASM_SHR] = 20,
+    [DISASM_SUBN] = 20,
+    [DISASM_SHL] = 20,
+    [DISASM_SNE_REG] = 14,
+    [DISASM_LD_I] = 12,
+    [DISASM_JP_V0] = 22,
+    [DISASM_RND] = 36,
+    [DISASM_SKP] = 14,
+    [DISASM_SKNP] = 14,
+    [DISASM_LD_VX_DT] = 10,
+    [DISASM_LD_K] = 18,
+    [DISASM_LD_DT] = 10,
+    [DISASM_LD_ST] = 10,
+    [DISASM_ADD_I] = 16,
+    [DISASM_LD_F] = 16,
+    /* Not a VIP instruction, costs as much as a plain store */
+    [DISASM_LD_I_LONG] = 12,
+    [DISASM_PLANE] = 10,
+    [DISASM_AUDIO] = 14,
+    [DISASM_PITCH] = 10,
+    [DISASM_UNKNOWN] = 12,
+};
+
+uint32_t vip_timing_cycles(const chip8 *vm, uint16_t instruction)
+{
+    uint16_t x = (0x0F00 & instruction) >> 8;
+    uint16_t y = (0x00F0 & instruction) >> 4;
+    uint16_t n = (0x000F & instruction);
+
+    enum disasm_class cls = disasm_class(instruction, vm->mode);
+
+    switch (cls) {
+    case DISASM_DRW:{
+        uint32_t rows = n ? n : 16;
+        uint32_t shift = vm->regs[x] % 8;
+        uint32_t row_cycles = CYCLES_DRW_ROW;
+        if (shift)
+            row_cycles += shift * CYCLES_DRW_SHIFT_BIT + CYCLES_DRW_SPILL;
+        return CYCLES_FETCH + CYCLES_DRW_SETUP + rows * row_cycles;
+    }
+    case DISASM_LD_B:{
+        /* Digits are produced by repeated subtraction */
+        uint8_t val = vm->regs[x];
+        uint32_t digit_sum = val / 100 + (val / 10) % 10 + val % 10;
+        return CYCLES_FETCH + 24 + 16 * digit_sum;
+    }
+    case DISASM_LD_MEM:
+    case DISASM_LD_REGS:
+        return CYCLES_FETCH + 14 + 14 * (x + 1);
+    case DISASM_SAVE_RANGE:
+    case DISASM_LOAD_RANGE:
+        return CYCLES_FETCH + 14 + 14 * ((x <= y ? y - x : x - y) + 1);
+    default:
+        return CYCLES_FETCH + class_cycles[cls];
+    }
+}
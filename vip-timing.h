@@ -0,0 +1,31 @@
+#ifndef VIP_TIMING_H
+#define VIP_TIMING_H
+
+#include <stdint.h>
+
+#include "chip8.h"
+
+/*
+ * COSMAC VIP timing model
+ *
+ * The CDP1802 runs at 1.7609MHz with 8 clocks per machine cycle, i.e. 3668
+ * machine cycles per 60Hz frame. The CDP1861 display DMA steals a cycle per
+ * displayed byte (32 rows * 4 scanlines * 8 bytes) and the interrupt routine
+ * takes about 46 more, the interpreter gets the rest.
+ *
+ * Instruction costs are machine cycles of the original interpreter routines,
+ * fetch and decode included, approximated to the common path (skips and page
+ * crossings are not accounted for).
+ */
+
+#define VIP_CYCLES_PER_FRAME 3668
+#define VIP_CYCLES_DISPLAY_DMA 1024
+#define VIP_CYCLES_INTERRUPT 46
+#define VIP_CYCLES_FRAME_BUDGET \
+    (VIP_CYCLES_PER_FRAME - VIP_CYCLES_DISPLAY_DMA - VIP_CYCLES_INTERRUPT)
+
+/* Machine cycles instruction is going to take in the current machine state,
+ * call before executing it */
+uint32_t vip_timing_cycles(const chip8 *vm, uint16_t instruction);
+
+#endif /* VIP_TIMING_H */